@@ -17,7 +17,7 @@ set "SEED_START=%~5"
 if "%SEED_START%"=="" set "SEED_START=0"
 
 set "THREADS=%~6"
-if "%THREADS%"=="" set "THREADS=24"
+if "%THREADS%"=="" set "THREADS=0"
 
 set "BUILD_DIR=%~7"
 if "%BUILD_DIR%"=="" set "BUILD_DIR=cmake-build-debug"
@@ -4,7 +4,7 @@ param(
     [int]$Cols = 5,
     [int]$Rows = 5,
     [uint32]$SeedStart = 0,
-    [int]$Threads = 24,
+    [int]$Threads = 0,  # 0: all hardware threads
     [string]$BuildDir = "cmake-build-debug",
     [string]$OutputCsvName = "seed_step_metrics_512.csv"
 )
@@ -5,7 +5,7 @@ set "SCRIPT_DIR=%~dp0"
 pushd "%SCRIPT_DIR%\.." >nul
 
 set "EPOCHS=%~1"
-if "%EPOCHS%"=="" set "EPOCHS=1000"
+if "%EPOCHS%"=="" set "EPOCHS=50"
 
 set "MODEL=%~2"
 if "%MODEL%"=="" set "MODEL=node_nn_model.nn"
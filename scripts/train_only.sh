@@ -5,7 +5,7 @@ SCRIPT_DIR="$(cd "$(dirname "${BASH_SOURCE[0]}")" && pwd)"
 REPO_ROOT="$(cd "$SCRIPT_DIR/.." && pwd)"
 cd "$REPO_ROOT"
 
-EPOCHS="${1:-250}"
+EPOCHS="${1:-50}"
 MODEL="${2:-node_nn_model.nn}"
 TEST_RATIO="${3:-0.2}"
 CSV="${4:-heuristics/training_data.csv}"
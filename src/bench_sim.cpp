@@ -0,0 +1,920 @@
+// bench_sim: micro-benchmarks for the simulation kernels.
+//
+// Usage:
+//   bench_sim cleanup [side] [reps] [dead_percent] [config]
+//     cleanup_dead on a cleaned side x side lattice with dead_percent of the
+//     nodes killed since: dense compaction vs free-list release. Checks both
+//     leave the same live graph.
+//   bench_sim handles [side] [config]
+//     NodeHandle check: takes a handle to every node of a side x side
+//     lattice, kills a third of the nodes, runs cleanup_dead (and in
+//     free-list mode a defragmentation), appends nodes into the dropped
+//     slots, and checks every handle resolves to its own node or to -1, and
+//     to -1 whenever its node died or moved.
+//   bench_sim dieoff [side] [reps] [dead_percent] [config]
+//     Mass energy apoptosis after warmup on a side x side lattice: incoming
+//     edge invalidation by scanning every edge per dead node vs through the
+//     dead node's own links, then the full energy pass.
+//   bench_sim alloc [steps] [maze_size] [seed] [config]
+//     Heap allocations per sim::step on a maze run, without and with a
+//     reused StepWorkspace. Fails if a step that grew neither the graph's
+//     storage nor the workspace's buffers allocated (checked in free-list
+//     mode, where every node added during a step keeps a slot).
+//   bench_sim sync [steps] [maze_size] [seed] [threads] [config]
+//     Full simulation steps with the sequential node loop vs STEP_SYNC_UPDATE
+//     on 1 and `threads` threads. Checks the synchronous runs agree exactly.
+//   bench_sim diffusion [max_edges] [threads] [config]
+//     Energy rules on lattices of 10^3 .. max_edges links: Graph reference
+//     pass vs the parallel gather kernel on 1 and `threads` threads, and on
+//     `threads` threads including the per-step SoA conversion. Checks the
+//     parallel kernel gives identical state for both thread counts and
+//     reports its largest energy deviation from the reference.
+//   bench_sim forward [samples] [reps] [hidden]
+//     NN forward pass over `samples` random inputs: node_nn::forward per
+//     sample vs the portable and AVX2 forward_batch kernels, with tanh and
+//     fast_tanh. Checks all kernels give bit-identical outputs. Uses the
+//     trained model, or a random network with `hidden` hidden units.
+//   bench_sim activation [trials] [steps] [cols] [rows] [config]
+//     Drift of NN_FAST_TANH: fast_tanh's largest error against tanh (checked
+//     against the documented bound), the network outputs' largest deviation,
+//     and how the end-of-run connectivity and live node counts of
+//     eval_seed_trials' seeds change compared with exact tanh.
+
+#include "node_nn/nn.h"
+#include "node_nn/utils/io.h"
+#include "graph.h"
+#include "graph_soa.h"
+#include "maze.h"
+#include "step_workspace.h"
+#include "thread_pool.h"
+#include "config.h"
+
+#include <chrono>
+#include <cmath>
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <new>
+#include <random>
+#include <string>
+#include <thread>
+#include <utility>
+#include <variant>
+#include <vector>
+
+// Heap allocation counter for the `alloc` mode: replaces the global
+// operator new / delete of this executable (scalar, array and aligned forms;
+// the nothrow forms call these by default).
+static std::atomic<long long> g_allocations{0};
+
+static void* counted_alloc(std::size_t size) {
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+
+static void* counted_aligned_alloc(std::size_t size, std::align_val_t align) {
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    const std::size_t alignment = static_cast<std::size_t>(align);
+    // aligned_alloc wants a non-zero multiple of the alignment
+    const std::size_t rounded = (std::max<std::size_t>(size, 1) + alignment - 1) / alignment * alignment;
+#if defined(_MSC_VER)
+    if (void* p = _aligned_malloc(rounded, alignment)) return p;
+#else
+    if (void* p = std::aligned_alloc(alignment, rounded)) return p;
+#endif
+    throw std::bad_alloc();
+}
+
+static void counted_aligned_free(void* p) {
+#if defined(_MSC_VER)
+    _aligned_free(p);
+#else
+    std::free(p);
+#endif
+}
+
+void* operator new(std::size_t size) { return counted_alloc(size); }
+void* operator new[](std::size_t size) { return counted_alloc(size); }
+void* operator new(std::size_t size, std::align_val_t align) { return counted_aligned_alloc(size, align); }
+void* operator new[](std::size_t size, std::align_val_t align) { return counted_aligned_alloc(size, align); }
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::size_t) noexcept { std::free(p); }
+void operator delete(void* p, std::align_val_t) noexcept { counted_aligned_free(p); }
+void operator delete[](void* p, std::align_val_t) noexcept { counted_aligned_free(p); }
+void operator delete(void* p, std::size_t, std::align_val_t) noexcept { counted_aligned_free(p); }
+void operator delete[](void* p, std::size_t, std::align_val_t) noexcept { counted_aligned_free(p); }
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+double elapsed_ms(Clock::time_point t0) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - t0).count();
+}
+
+sim::SimConfig load_config_or_defaults(const std::string& cli_path) {
+    sim::SimConfig config;
+    std::string path = cli_path;
+    if (path.empty()) {
+        for (const char* p : {"hyperparameters.txt", "../hyperparameters.txt"}) {
+            if (std::filesystem::exists(p)) { path = p; break; }
+        }
+    }
+    if (path.empty() || !sim::load_config(path, config)) {
+        std::cout << "Config not loaded; using defaults.\n";
+        sim::set_default_config(config);
+    } else {
+        std::cout << "Loading config: " << path << "\n";
+    }
+    return config;
+}
+
+// side x side 4-connected lattice with random energies and weights; the two
+// opposite corners are sources.
+sim::Graph build_lattice_graph(int side, unsigned seed) {
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<float> energy_dist(0.2f, 1.0f);
+    std::uniform_real_distribution<float> weight_dist(0.1f, 2.0f);
+
+    sim::Graph graph;
+    for (int row = 0; row < side; ++row) {
+        for (int col = 0; col < side; ++col) {
+            sim::Node node;
+            node.pos = {sim::cell_cx(col), sim::cell_cy(row)};
+            node.is_dead = false;
+            node.energy = energy_dist(rng);
+            sim::add_node(graph, node);
+        }
+    }
+    for (int corner : {0, side * side - 1}) {
+        graph.nodes[corner].is_source = true;
+        graph.nodes[corner].is_pinned = true;
+    }
+
+    auto link = [&](int a, int b) {
+        sim::add_link(graph, a, b, weight_dist(rng));
+    };
+    for (int row = 0; row < side; ++row) {
+        for (int col = 0; col < side; ++col) {
+            const int i = row * side + col;
+            if (col + 1 < side) link(i, i + 1);
+            if (row + 1 < side) link(i, i + side);
+        }
+    }
+    return graph;
+}
+
+bool same_state(const sim::Graph& a, const sim::Graph& b) {
+    if (a.nodes.size() != b.nodes.size() || a.links.size() != b.links.size()) return false;
+    for (size_t i = 0; i < a.nodes.size(); ++i) {
+        const sim::Node& x = a.nodes[i];
+        const sim::Node& y = b.nodes[i];
+        if (std::memcmp(&x.energy, &y.energy, sizeof(float)) != 0) return false;
+        if (x.is_dead != y.is_dead || x.links != y.links) return false;
+    }
+    for (size_t l = 0; l < a.links.size(); ++l) {
+        const sim::Link& x = a.links[l];
+        const sim::Link& y = b.links[l];
+        if (x.a != y.a || x.b != y.b) return false;
+        if (std::memcmp(&x.w_ab, &y.w_ab, sizeof(float)) != 0) return false;
+        if (std::memcmp(&x.w_ba, &y.w_ba, sizeof(float)) != 0) return false;
+    }
+    return true;
+}
+
+bool same_soa_state(const sim::GraphSoA& a, const sim::GraphSoA& b) {
+    auto same_bits = [](const auto& x, const auto& y) {
+        return x.size() == y.size() &&
+               std::memcmp(x.data(), y.data(), x.size() * sizeof(x[0])) == 0;
+    };
+    return same_bits(a.energy, b.energy) && same_bits(a.flags, b.flags) &&
+           same_bits(a.edge_weight, b.edge_weight);
+}
+
+int run_diffusion(int argc, char* argv[]) {
+    const long max_edges = (argc > 2) ? std::max(1000L, std::stol(argv[2])) : 1000000L;
+    const int threads = (argc > 3) ? std::max(1, std::stoi(argv[3])) : 4;
+    const sim::SimConfig config = load_config_or_defaults((argc > 4) ? argv[4] : "");
+
+    sim::ThreadPool pool(threads);
+    std::cout << "diffusion: " << threads << " threads ("
+              << std::thread::hardware_concurrency() << " hardware)\n";
+
+    bool ok = true;
+    for (long edges = 1000; edges <= max_edges; edges *= 10) {
+        // A side x side lattice has 2 * side * (side - 1) links.
+        const int side = std::max(2, static_cast<int>(std::lround(std::sqrt(edges / 2.0))) + 1);
+        const int reps = static_cast<int>(std::max(3L, 20000000L / edges));
+        const sim::Graph graph = build_lattice_graph(side, 1u);
+        const sim::Vec2 target = {static_cast<float>(side) - 0.5f, static_cast<float>(side) - 0.5f};
+
+        sim::GraphSoA base;
+        sim::graph_to_soa(graph, base);
+        sim::GraphSoA one, many, converted;
+
+        sim::Graph ref;
+        double ref_ms = 0.0;
+        for (int r = 0; r < reps; ++r) {
+            ref = graph;
+            const auto t0 = Clock::now();
+            sim::apply_energy_rules(ref, target, config);
+            ref_ms += elapsed_ms(t0);
+        }
+        ref_ms /= reps;
+
+        auto time_kernel = [&](sim::GraphSoA& soa, auto&& kernel) {
+            double ms = 0.0;
+            for (int r = 0; r < reps; ++r) {
+                soa = base;
+                const auto t0 = Clock::now();
+                kernel(soa);
+                ms += elapsed_ms(t0);
+            }
+            return ms / reps;
+        };
+        const double one_ms = time_kernel(one, [&](sim::GraphSoA& soa) {
+            sim::soa_apply_energy_rules_parallel(soa, target, config, nullptr);
+        });
+        const double many_ms = time_kernel(many, [&](sim::GraphSoA& soa) {
+            sim::soa_apply_energy_rules_parallel(soa, target, config, &pool);
+        });
+        sim::Graph written;
+        double converted_ms = 0.0;
+        for (int r = 0; r < reps; ++r) {
+            written = graph;
+            const auto t0 = Clock::now();
+            sim::graph_to_soa(written, converted);
+            sim::soa_apply_energy_rules_parallel(converted, target, config, &pool);
+            sim::soa_write_back_state(converted, written);
+            converted_ms += elapsed_ms(t0);
+        }
+        converted_ms /= reps;
+
+        float max_dev = 0.0f;
+        for (int i = 0; i < one.node_count(); ++i) {
+            const float e = ref.nodes[i].energy;
+            max_dev = std::max(max_dev, std::abs(one.energy[i] - e) / std::max(1.0f, std::abs(e)));
+        }
+        const bool identical = same_soa_state(one, many);
+        ok = ok && identical;
+
+        std::cout << "  " << graph.links.size() << " links, " << reps << " reps\n"
+                  << "    graph reference : " << ref_ms << " ms/pass\n"
+                  << "    gather, 1 thread: " << one_ms << " ms/pass"
+                  << "  (x" << (one_ms > 0.0 ? ref_ms / one_ms : 0.0) << ")\n"
+                  << "    gather, " << threads << " threads: " << many_ms << " ms/pass"
+                  << "  (x" << (many_ms > 0.0 ? ref_ms / many_ms : 0.0) << ")\n"
+                  << "    + conversion    : " << converted_ms << " ms/pass"
+                  << "  (x" << (converted_ms > 0.0 ? ref_ms / converted_ms : 0.0) << ")\n"
+                  << "    thread counts " << (identical ? "identical" : "DIFFER")
+                  << ", max relative deviation from reference " << max_dev << "\n";
+    }
+    return ok ? 0 : 1;
+}
+
+// Open side x side maze (no interior walls) matching build_lattice_graph.
+sim::Maze build_open_maze(int side, const sim::SimConfig& config) {
+    sim::Maze maze;
+    maze.width = side;
+    maze.height = side;
+    maze.grid.assign(static_cast<size_t>(side), std::vector<int>(static_cast<size_t>(side), 0));
+    sim::prepare_maze(maze, config);
+    return maze;
+}
+
+// Live nodes in index order, each with its (dense neighbour id, weight) list.
+std::vector<std::vector<std::pair<int, float>>> live_adjacency(const sim::Graph& graph) {
+    std::vector<int> id(graph.nodes.size(), -1);
+    int next_id = 0;
+    for (size_t i = 0; i < graph.nodes.size(); ++i) {
+        if (!graph.nodes[i].is_dead) id[i] = next_id++;
+    }
+    std::vector<std::vector<std::pair<int, float>>> adj;
+    for (size_t i = 0; i < graph.nodes.size(); ++i) {
+        if (id[i] < 0) continue;
+        adj.emplace_back();
+        for (int l : graph.nodes[i].links) {
+            const sim::Link& link = graph.links[l];
+            adj.back().push_back({id[sim::link_other(link, static_cast<int>(i))],
+                                  sim::link_out_weight(link, static_cast<int>(i))});
+        }
+    }
+    return adj;
+}
+
+int run_cleanup(int argc, char* argv[]) {
+    const int side = (argc > 2) ? std::max(2, std::stoi(argv[2])) : 200;
+    const int reps = (argc > 3) ? std::max(1, std::stoi(argv[3])) : 20;
+    const int dead_percent = (argc > 4) ? std::max(0, std::min(100, std::stoi(argv[4]))) : 1;
+    const sim::SimConfig config = load_config_or_defaults((argc > 5) ? argv[5] : "");
+
+    sim::Graph base = build_lattice_graph(side, 1u);
+    const sim::Maze maze = build_open_maze(side, config);
+    sim::cleanup_dead(base, maze, config);  // links canonical, nothing touched
+
+    // Kill a random subset, as apoptosis would (own directions set to -1).
+    std::mt19937 rng(2u);
+    std::uniform_int_distribution<int> percent(0, 99);
+    int killed = 0;
+    for (int i = 0; i < static_cast<int>(base.nodes.size()); ++i) {
+        if (base.nodes[i].is_source || percent(rng) >= dead_percent) continue;
+        sim::kill_node(base, i);
+        for (int l : base.nodes[i].links) {
+            sim::link_out_weight(base.links[l], i) = -1.0f;
+        }
+        ++killed;
+    }
+
+    std::cout << "cleanup: " << base.nodes.size() << " nodes (" << killed << " dead), "
+              << base.links.size() << " links, " << reps << " reps\n";
+
+    sim::SimConfig dense_config = config;
+    dense_config.NODE_FREE_LIST = false;
+    sim::SimConfig free_config = config;
+    free_config.NODE_FREE_LIST = true;
+
+    sim::Graph dense = base;
+    sim::Graph released = base;
+    double dense_ms = 0.0;
+    double free_ms = 0.0;
+    for (int r = 0; r < reps; ++r) {
+        dense = base;
+        auto t0 = Clock::now();
+        sim::cleanup_dead(dense, maze, dense_config);
+        dense_ms += elapsed_ms(t0);
+
+        released = base;
+        t0 = Clock::now();
+        sim::cleanup_dead(released, maze, free_config);
+        free_ms += elapsed_ms(t0);
+    }
+
+    const bool identical = live_adjacency(dense) == live_adjacency(released);
+    std::cout << "  dense compaction: " << dense_ms / reps << " ms/pass\n"
+              << "  free-list       : " << free_ms / reps << " ms/pass"
+              << "  (x" << (free_ms > 0.0 ? dense_ms / free_ms : 0.0) << ")\n"
+              << "  results " << (identical ? "identical" : "DIFFER") << "\n";
+    return identical ? 0 : 1;
+}
+
+int run_handles(int argc, char* argv[]) {
+    const int side = (argc > 2) ? std::max(3, std::stoi(argv[2])) : 20;
+    const sim::SimConfig config = load_config_or_defaults((argc > 3) ? argv[3] : "");
+    const sim::Maze maze = build_open_maze(side, config);
+
+    std::cout << "handles: " << side << "x" << side << " lattice\n";
+
+    // Each node's energy is its original index, so a resolved handle can be
+    // checked against the node it was taken from.
+    auto check = [&](bool free_list) {
+        sim::SimConfig run_config = config;
+        run_config.NODE_FREE_LIST = free_list;
+        run_config.NODE_DEFRAG_FREE_FRACTION = 1.0f;  // defragment explicitly below
+
+        sim::Graph graph = build_lattice_graph(side, 1u);
+        sim::cleanup_dead(graph, maze, run_config);
+        const int n = static_cast<int>(graph.nodes.size());
+        std::vector<sim::NodeHandle> handles;
+        for (int i = 0; i < n; ++i) {
+            graph.nodes[i].energy = static_cast<float>(i);
+            handles.push_back(sim::node_handle(graph, i));
+        }
+
+        // Kill every third node of the second half and most of the last
+        // quarter: the first half keeps its slots, and dense compaction drops
+        // tail slots for the appends below to reuse.
+        std::vector<char> killed(static_cast<size_t>(n), 0);
+        for (int i = n / 2; i < n; ++i) {
+            if (graph.nodes[i].is_source || (i % 3 != 1 && i < n - n / 4)) continue;
+            sim::kill_node(graph, i);
+            for (int l : graph.nodes[i].links) {
+                sim::Link& link = graph.links[l];
+                sim::link_out_weight(link, i) = -1.0f;
+                sim::link_out_weight(link, sim::link_other(link, i)) = -1.0f;
+            }
+            killed[i] = 1;
+        }
+        sim::cleanup_dead(graph, maze, run_config);
+        if (free_list) {
+            run_config.NODE_DEFRAG_FREE_FRACTION = 0.0f;
+            sim::cleanup_dead(graph, maze, run_config);
+        }
+
+        // Refill every slot the cleanup dropped, and a few more.
+        while (static_cast<int>(graph.nodes.size()) < n + 8) {
+            sim::Node node;
+            node.pos = {sim::cell_cx(0), sim::cell_cy(0)};
+            node.is_dead = false;
+            node.energy = -1.0f;
+            sim::add_node(graph, node);
+        }
+
+        int resolved = 0;
+        int wrong = 0;
+        for (int i = 0; i < n; ++i) {
+            const int idx = sim::resolve_handle(graph, handles[i]);
+            if (idx < 0) continue;
+            ++resolved;
+            if (killed[i] || idx != i || graph.nodes[idx].energy != static_cast<float>(i)) ++wrong;
+        }
+        std::cout << "  " << (free_list ? "free list" : "dense    ") << ": " << n << " handles, "
+                  << resolved << " still resolve, " << wrong << " to the wrong node\n";
+        return wrong == 0 && resolved > 0;
+    };
+
+    const bool ok = check(false) && check(true);
+    std::cout << "  " << (ok ? "OK" : "FAIL") << "\n";
+    return ok ? 0 : 1;
+}
+
+// Invalidate every direction into and out of each node in `dead`, the way
+// energy apoptosis did before it used the link table: a scan of all edges
+// per dead node, O(dead x E).
+void kill_by_scan(sim::Graph& graph, const std::vector<int>& dead) {
+    const int m = static_cast<int>(graph.nodes.size());
+    for (int i : dead) {
+        sim::kill_node(graph, i);
+        for (int l : graph.nodes[i].links) {
+            sim::link_out_weight(graph.links[l], i) = -1.0f;
+        }
+        for (int j = 0; j < m; ++j) {
+            if (j == i || graph.nodes[j].is_dead) continue;
+            for (int l : graph.nodes[j].links) {
+                sim::Link& link = graph.links[l];
+                if (sim::link_other(link, j) == i) {
+                    sim::link_out_weight(link, j) = -1.0f;
+                }
+            }
+        }
+    }
+}
+
+// Same through the dead node's own links, O(degree) per dead node (what
+// apply_energy_rules does).
+void kill_by_links(sim::Graph& graph, const std::vector<int>& dead) {
+    for (int i : dead) {
+        sim::kill_node(graph, i);
+        for (int l : graph.nodes[i].links) {
+            sim::Link& link = graph.links[l];
+            sim::link_out_weight(link, i) = -1.0f;
+            const int j = sim::link_other(link, i);
+            if (j == i || graph.nodes[j].is_dead) continue;
+            sim::link_out_weight(link, j) = -1.0f;
+        }
+    }
+}
+
+int run_dieoff(int argc, char* argv[]) {
+    const int side = (argc > 2) ? std::max(2, std::stoi(argv[2])) : 100;
+    const int reps = (argc > 3) ? std::max(1, std::stoi(argv[3])) : 3;
+    const int dead_percent = (argc > 4) ? std::max(0, std::min(100, std::stoi(argv[4]))) : 30;
+    const sim::SimConfig config = load_config_or_defaults((argc > 5) ? argv[5] : "");
+
+    // Victims start at the energy floor and survivors well above the gate, so
+    // one energy pass past warmup kills (about) dead_percent of the nodes.
+    sim::Graph base = build_lattice_graph(side, 1u);
+    base.simulation_step = static_cast<int>(config.APOPTOSIS_WARMUP_STEPS) + 1;
+    std::mt19937 rng(3u);
+    std::uniform_int_distribution<int> percent(0, 99);
+    std::vector<int> victims;
+    for (int i = 0; i < static_cast<int>(base.nodes.size()); ++i) {
+        sim::Node& node = base.nodes[i];
+        if (node.is_source) continue;
+        if (percent(rng) < dead_percent) {
+            node.energy = config.ENERGY_MIN_CLAMP;
+            victims.push_back(i);
+        } else {
+            node.energy = config.NN_APOPTOSIS_ENERGY_GATE + 100.0f;
+        }
+    }
+    const sim::Vec2 target = {static_cast<float>(side) - 0.5f, static_cast<float>(side) - 0.5f};
+
+    std::cout << "dieoff: " << base.nodes.size() << " nodes, " << base.links.size()
+              << " links, " << victims.size() << " victims, " << reps << " reps\n";
+
+    double scan_ms = 0.0;
+    double links_ms = 0.0;
+    double graph_ms = 0.0;
+    sim::Graph scanned;
+    sim::Graph linked;
+    sim::Graph ref;
+    for (int r = 0; r < reps; ++r) {
+        scanned = base;
+        auto t0 = Clock::now();
+        kill_by_scan(scanned, victims);
+        scan_ms += elapsed_ms(t0);
+
+        linked = base;
+        t0 = Clock::now();
+        kill_by_links(linked, victims);
+        links_ms += elapsed_ms(t0);
+
+        ref = base;
+        t0 = Clock::now();
+        sim::apply_energy_rules(ref, target, config);
+        graph_ms += elapsed_ms(t0);
+    }
+
+    int died = 0;
+    for (size_t i = 0; i < ref.nodes.size(); ++i) {
+        if (ref.nodes[i].is_dead && !base.nodes[i].is_dead) ++died;
+    }
+
+    const bool kill_identical = same_state(scanned, linked);
+    std::cout << "  invalidate by scan : " << scan_ms / reps << " ms\n"
+              << "  invalidate by links: " << links_ms / reps << " ms"
+              << "  (x" << (links_ms > 0.0 ? scan_ms / links_ms : 0.0) << ")\n"
+              << "  energy pass        : " << graph_ms / reps << " ms (" << died << " died)\n"
+              << "  results " << (kill_identical ? "identical" : "DIFFER") << "\n";
+    return kill_identical ? 0 : 1;
+}
+
+// Capacities of every buffer the graph and the workspace own. Unchanged
+// across a step means the step grew neither the graph's storage nor the
+// workspace's high-water marks.
+std::vector<size_t> storage_capacities(const sim::Graph& graph, const sim::StepWorkspace& ws) {
+    std::vector<size_t> caps;
+    caps.reserve(graph.nodes.size() + ws.index.cells.size() + 32);
+    caps.push_back(graph.nodes.capacity());
+    caps.push_back(graph.links.capacity());
+    caps.push_back(graph.free_links.capacity());
+    caps.push_back(graph.touched_nodes.capacity());
+    for (const sim::Node& node : graph.nodes) caps.push_back(node.links.capacity());
+
+    caps.push_back(ws.index.cells.capacity());
+    caps.push_back(ws.index.overflow.capacity());
+    for (const auto& bucket : ws.index.cells) caps.push_back(bucket.capacity());
+    for (size_t c : {ws.old_energy.capacity(), ws.next_energy.capacity(),
+                     ws.raw_outflow.capacity(), ws.outflow_scale.capacity(),
+                     ws.pair_fluxes.capacity(), ws.merged_away.capacity(),
+                     ws.reconnected.capacity(), ws.candidates.capacity(),
+                     ws.inc_i.capacity(), ws.inc_j.capacity(), ws.neighbors.capacity(),
+                     ws.reconnectable.capacity(), ws.dirty_links.capacity(), ws.keep_link.capacity(),
+                     ws.node_remap.capacity(), ws.link_remap.capacity(),
+                     ws.eval_nodes.capacity(), ws.intents.capacity(), ws.sprouted.capacity()}) {
+        caps.push_back(c);
+    }
+    auto intent_capacities = [&](const sim::StepWorkspace::VibeIntent& intent) {
+        caps.push_back(intent.prune.capacity());
+        caps.push_back(intent.thicken.capacity());
+        caps.push_back(intent.out_weights.capacity());
+    };
+    intent_capacities(ws.intent);
+    for (const auto& intent : ws.intents) intent_capacities(intent);
+    return caps;
+}
+
+int run_alloc(int argc, char* argv[]) {
+    const int steps = (argc > 2) ? std::max(1, std::stoi(argv[2])) : 600;
+    const int size = (argc > 3) ? std::max(2, std::stoi(argv[3])) : 8;
+    const unsigned seed = (argc > 4) ? static_cast<unsigned>(std::stoul(argv[4])) : 0u;
+    const sim::SimConfig config = load_config_or_defaults((argc > 5) ? argv[5] : "");
+
+    node_nn::Model nn;
+    bool loaded = false;
+    for (const char* p : {"node_nn_model.nn", "../node_nn_model.nn"}) {
+        if (std::filesystem::exists(p) && node_nn::load_model(p, nn)) { loaded = true; break; }
+    }
+    std::cout << "alloc: " << size << "x" << size << " maze, seed " << seed << ", " << steps
+              << " steps, " << (loaded ? "trained" : "random") << " model\n";
+
+    const sim::Maze maze = sim::generate_maze(size, size, seed, config);
+    const sim::Vec2 target = {static_cast<float>(maze.width) - 1.5f,
+                              static_cast<float>(maze.height) - 1.5f};
+
+    // Heap allocations over `steps` steps, optionally with a reused
+    // workspace. Also counts the steady steps (neither the graph's storage nor
+    // the workspace grew) and how many of those allocated anyway.
+    struct Counts {
+        long long allocs = 0;
+        int steady_steps = 0;
+        int steady_allocating = 0;
+    };
+    auto run = [&](const sim::SimConfig& run_config, bool use_workspace) {
+        Counts counts;
+        sim::Graph graph = sim::build_initial_graph(maze, run_config);
+        sim::StepWorkspace workspace;
+        for (int t = 0; t < steps; ++t) {
+            const std::vector<size_t> caps_before = storage_capacities(graph, workspace);
+            const long long before = g_allocations.load();
+            sim::step(graph, nn, target, maze, run_config, use_workspace ? &workspace : nullptr);
+            const long long allocs = g_allocations.load() - before;
+            counts.allocs += allocs;
+            if (storage_capacities(graph, workspace) == caps_before) {
+                ++counts.steady_steps;
+                if (allocs > 0) ++counts.steady_allocating;
+            }
+        }
+        return counts;
+    };
+
+    const Counts plain = run(config, false);
+    const Counts reused = run(config, true);
+
+    // Steady-state check in both node storage modes. Dense mode compacts a
+    // node sprouted and killed within one step away before the capacities
+    // are compared, so a step can look steady although the graph grew; the
+    // check is stricter there. Free-list mode keeps the slot, so every step
+    // that grew the graph shows up as a capacity change.
+    sim::SimConfig dense_config = config;
+    dense_config.NODE_FREE_LIST = false;
+    sim::SimConfig free_config = config;
+    free_config.NODE_FREE_LIST = true;
+    const Counts dense_check = run(dense_config, true);
+    const Counts free_check = run(free_config, true);
+    const bool ok = dense_check.steady_allocating == 0 && free_check.steady_allocating == 0;
+
+    std::cout << "  no workspace  : " << static_cast<double>(plain.allocs) / steps << " allocs/step\n"
+              << "  with workspace: " << static_cast<double>(reused.allocs) / steps << " allocs/step\n"
+              << "  steady steps  : dense " << dense_check.steady_steps << ", "
+              << dense_check.steady_allocating << " of them allocated; free list "
+              << free_check.steady_steps << ", " << free_check.steady_allocating << " of them allocated\n"
+              << "  " << (ok ? "OK" : "FAIL") << "\n";
+    return ok ? 0 : 1;
+}
+
+int run_sync(int argc, char* argv[]) {
+    const int steps = (argc > 2) ? std::max(1, std::stoi(argv[2])) : 300;
+    const int size = (argc > 3) ? std::max(2, std::stoi(argv[3])) : 24;
+    const unsigned seed = (argc > 4) ? static_cast<unsigned>(std::stoul(argv[4])) : 0u;
+    const int threads = (argc > 5) ? std::max(1, std::stoi(argv[5])) : 4;
+    const sim::SimConfig config = load_config_or_defaults((argc > 6) ? argv[6] : "");
+
+    node_nn::Model nn;
+    for (const char* p : {"node_nn_model.nn", "../node_nn_model.nn"}) {
+        if (std::filesystem::exists(p) && node_nn::load_model(p, nn)) break;
+    }
+
+    const sim::Maze maze = sim::generate_maze(size, size, seed, config);
+    const sim::Vec2 target = {static_cast<float>(maze.width) - 1.5f,
+                              static_cast<float>(maze.height) - 1.5f};
+    std::cout << "sync: " << size << "x" << size << " maze, seed " << seed << ", "
+              << steps << " steps, " << std::thread::hardware_concurrency()
+              << " hardware threads\n";
+
+    auto run = [&](bool sync, int thread_count, double& ms, long long& node_steps) {
+        sim::SimConfig run_config = config;
+        run_config.STEP_SYNC_UPDATE = sync;
+        run_config.STEP_THREADS = static_cast<float>(thread_count);
+        sim::Graph graph = sim::build_initial_graph(maze, run_config);
+        sim::StepWorkspace workspace;
+        ms = 0.0;
+        node_steps = 0;
+        for (int t = 0; t < steps; ++t) {
+            node_steps += sim::live_node_count(graph);
+            const auto t0 = Clock::now();
+            sim::step(graph, nn, target, maze, run_config, &workspace);
+            ms += elapsed_ms(t0);
+        }
+        return graph;
+    };
+
+    double seq_ms, sync1_ms, syncn_ms;
+    long long seq_nodes, sync1_nodes, syncn_nodes;
+    run(false, 1, seq_ms, seq_nodes);
+    const sim::Graph sync1 = run(true, 1, sync1_ms, sync1_nodes);
+    const sim::Graph syncn = run(true, threads, syncn_ms, syncn_nodes);
+
+    const bool identical = same_state(sync1, syncn);
+    auto report = [&](const char* name, double ms, long long nodes) {
+        std::cout << "  " << name << ms / steps << " ms/step, "
+                  << static_cast<double>(nodes) / steps << " live nodes/step\n";
+    };
+    report("sequential       : ", seq_ms, seq_nodes);
+    report("sync, 1 thread   : ", sync1_ms, sync1_nodes);
+    std::cout << "  sync, " << threads << " threads  : " << syncn_ms / steps << " ms/step"
+              << "  (x" << (syncn_ms > 0.0 ? sync1_ms / syncn_ms : 0.0) << " vs 1 thread)\n"
+              << "  sync results " << (identical ? "identical" : "DIFFER")
+              << " across thread counts\n";
+    return identical ? 0 : 1;
+}
+
+// `forward` mode for one concrete topology.
+template <typename Network>
+int run_forward_kernels(Network& nn, int samples, int reps) {
+    // Inputs span the clamp range the simulator feeds the network.
+    std::mt19937 rng(1234);
+    std::uniform_real_distribution<float> dist(-3.0f, 3.0f);
+    std::vector<float> x(static_cast<size_t>(samples) * node_nn::INPUT_SIZE);
+    for (float& v : x) v = dist(rng);
+
+    std::cout << "forward: " << nn.INPUT_SIZE << "-" << nn.HIDDEN_SIZE << "-" << nn.OUTPUT_SIZE << " network, "
+              << samples << " samples x " << reps << " reps, AVX2 "
+              << (node_nn::has_avx2() ? "available" : "not available") << "\n";
+
+    using Kernel = void (*)(const Network&, const float*, float*, int, float*);
+    auto run = [&](Kernel kernel, std::vector<float>& y) {
+        y.assign(static_cast<size_t>(samples) * node_nn::OUTPUT_SIZE, 0.0f);
+        const auto t0 = Clock::now();
+        for (int r = 0; r < reps; ++r) {
+            if (kernel) {
+                kernel(nn, x.data(), y.data(), samples, nullptr);
+            } else {
+                std::array<float, node_nn::INPUT_SIZE> in{};
+                std::array<float, node_nn::OUTPUT_SIZE> out{};
+                for (int s = 0; s < samples; ++s) {
+                    for (int j = 0; j < node_nn::INPUT_SIZE; ++j) in[j] = x[static_cast<size_t>(j) * samples + s];
+                    node_nn::forward(nn, in, out);
+                    for (int i = 0; i < node_nn::OUTPUT_SIZE; ++i) y[static_cast<size_t>(i) * samples + s] = out[i];
+                }
+            }
+        }
+        return elapsed_ms(t0);
+    };
+
+    // Speed-ups are relative to the exact-tanh forward per sample.
+    bool all_identical = true;
+    double exact_scalar_ms = 0.0;
+    for (node_nn::Activation activation : {node_nn::Activation::TANH, node_nn::Activation::FAST_TANH}) {
+        nn.activation = activation;
+        std::cout << "  " << (activation == node_nn::Activation::TANH ? "tanh" : "fast_tanh") << "\n";
+
+        std::vector<float> y_scalar, y_portable, y_avx2;
+        const double scalar_ms = run(nullptr, y_scalar);
+        if (activation == node_nn::Activation::TANH) exact_scalar_ms = scalar_ms;
+        const double portable_ms = run(&node_nn::forward_batch_portable<Network::INPUT_SIZE, Network::HIDDEN_SIZE,
+                                                                         Network::OUTPUT_SIZE>, y_portable);
+        bool identical = std::memcmp(y_scalar.data(), y_portable.data(), y_scalar.size() * sizeof(float)) == 0;
+
+        auto report = [&](const char* name, double ms) {
+            std::cout << "    " << name << (ms > 0.0 ? static_cast<double>(samples) * reps / ms * 1.0e3 : 0.0)
+                      << " samples/s  (x" << (ms > 0.0 ? exact_scalar_ms / ms : 0.0) << ")\n";
+        };
+        report("forward per sample    : ", scalar_ms);
+        report("forward_batch portable: ", portable_ms);
+        if (node_nn::has_avx2()) {
+            const double avx2_ms = run(&node_nn::forward_batch_avx2<Network::INPUT_SIZE, Network::HIDDEN_SIZE,
+                                                                     Network::OUTPUT_SIZE>, y_avx2);
+            identical = identical &&
+                        std::memcmp(y_scalar.data(), y_avx2.data(), y_scalar.size() * sizeof(float)) == 0;
+            report("forward_batch AVX2    : ", avx2_ms);
+        }
+        std::cout << "    outputs " << (identical ? "identical" : "DIFFER") << "\n";
+        all_identical = all_identical && identical;
+    }
+    return all_identical ? 0 : 1;
+}
+
+int run_forward(int argc, char* argv[]) {
+    const int samples = (argc > 2) ? std::max(1, std::stoi(argv[2])) : 4096;
+    const int reps = (argc > 3) ? std::max(1, std::stoi(argv[3])) : 200;
+
+    // The trained model, or a random network with `hidden` hidden units.
+    node_nn::Model model;
+    if (argc > 4) {
+        const node_nn::Topology topology = {node_nn::INPUT_SIZE, std::stoi(argv[4]), node_nn::OUTPUT_SIZE};
+        if (!node_nn::create_model(topology, model)) {
+            std::cerr << "No built-in topology with " << topology.hidden << " hidden units\n";
+            return 1;
+        }
+    } else {
+        for (const char* p : {"node_nn_model.nn", "../node_nn_model.nn"}) {
+            if (std::filesystem::exists(p) && node_nn::load_model(p, model)) break;
+        }
+    }
+    return std::visit([&](auto& nn) { return run_forward_kernels(nn, samples, reps); }, model);
+}
+
+int run_activation(int argc, char* argv[]) {
+    const int trials = (argc > 2) ? std::max(1, std::stoi(argv[2])) : 64;
+    const int steps = (argc > 3) ? std::max(1, std::stoi(argv[3])) : 1200;
+    const int cols = (argc > 4) ? std::max(2, std::stoi(argv[4])) : 5;
+    const int rows = (argc > 5) ? std::max(2, std::stoi(argv[5])) : 5;
+    const sim::SimConfig config = load_config_or_defaults((argc > 6) ? argv[6] : "");
+
+    node_nn::Model nn;
+    for (const char* p : {"node_nn_model.nn", "../node_nn_model.nn"}) {
+        if (std::filesystem::exists(p) && node_nn::load_model(p, nn)) break;
+    }
+
+    // fast_tanh against tanh in double over a dense sweep of [-10, 10]
+    // (past +-7.9053 both are +-1 in float).
+    double fast_error = 0.0;
+    double float_error = 0.0;
+    float worst_x = 0.0f;
+    for (int k = -2000000; k <= 2000000; ++k) {
+        const float v = static_cast<float>(k) * 5.0e-6f;
+        const double exact = std::tanh(static_cast<double>(v));
+        const double error = std::fabs(static_cast<double>(node_nn::fast_tanh(v)) - exact);
+        if (error > fast_error) {
+            fast_error = error;
+            worst_x = v;
+        }
+        float_error = std::max(float_error, std::fabs(static_cast<double>(std::tanh(v)) - exact));
+    }
+    const bool within_bound = fast_error <= node_nn::FAST_TANH_MAX_ERROR;
+    std::cout << "activation: fast_tanh max |error| " << fast_error << " at x = " << worst_x
+              << " (documented bound " << node_nn::FAST_TANH_MAX_ERROR << ", "
+              << (within_bound ? "holds" : "EXCEEDED") << "); std::tanh in float: "
+              << float_error << "\n";
+
+    // Per-sample network output deviation over inputs in the clamp range.
+    {
+        std::mt19937 rng(1234);
+        std::uniform_real_distribution<float> dist(-3.0f, 3.0f);
+        node_nn::Model fast_nn = nn;
+        node_nn::set_activation(fast_nn, node_nn::Activation::FAST_TANH);
+        std::array<float, node_nn::INPUT_SIZE> in{};
+        std::array<float, node_nn::OUTPUT_SIZE> exact_out{}, fast_out{};
+        double output_error = 0.0;
+        for (int s = 0; s < 100000; ++s) {
+            for (float& v : in) v = dist(rng);
+            node_nn::forward(nn, in, exact_out);
+            node_nn::forward(fast_nn, in, fast_out);
+            for (int i = 0; i < node_nn::OUTPUT_SIZE; ++i) {
+                output_error = std::max(output_error, static_cast<double>(std::fabs(fast_out[i] - exact_out[i])));
+            }
+        }
+        std::cout << "  network outputs: max |deviation| " << output_error << " over 100000 samples\n";
+    }
+
+    // End-of-run metrics of eval_seed_trials (seeds 0 .. trials - 1) with the
+    // exact and the fast activation.
+    struct Outcome {
+        bool connected;
+        int  nodes;
+    };
+    auto run = [&](bool fast, double& ms) {
+        sim::SimConfig run_config = config;
+        run_config.NN_FAST_TANH = fast;
+        std::vector<Outcome> outcomes;
+        ms = 0.0;
+        for (int seed = 0; seed < trials; ++seed) {
+            const sim::Maze maze = sim::generate_maze(cols, rows, static_cast<unsigned>(seed), run_config);
+            sim::Graph graph = sim::build_initial_graph(maze, run_config);
+            sim::StepWorkspace workspace;
+            const sim::Vec2 target = {static_cast<float>(maze.width) - 1.5f,
+                                      static_cast<float>(maze.height) - 1.5f};
+            const auto t0 = Clock::now();
+            for (int t = 0; t < steps; ++t) sim::step(graph, nn, target, maze, run_config, &workspace);
+            ms += elapsed_ms(t0);
+            outcomes.push_back({sim::sources_connected(graph, 1.0e-6f), sim::live_node_count(graph)});
+        }
+        return outcomes;
+    };
+
+    std::cout << "  " << trials << " seeds, " << cols << "x" << rows << " mazes, " << steps << " steps\n";
+    double exact_ms, fast_ms;
+    const std::vector<Outcome> exact = run(false, exact_ms);
+    const std::vector<Outcome> fast = run(true, fast_ms);
+
+    int exact_connected = 0, fast_connected = 0, flipped = 0, node_changed = 0, max_node_delta = 0;
+    long long node_delta_sum = 0;
+    for (int seed = 0; seed < trials; ++seed) {
+        exact_connected += exact[seed].connected ? 1 : 0;
+        fast_connected += fast[seed].connected ? 1 : 0;
+        flipped += (exact[seed].connected != fast[seed].connected) ? 1 : 0;
+        const int delta = std::abs(fast[seed].nodes - exact[seed].nodes);
+        node_changed += (delta != 0) ? 1 : 0;
+        node_delta_sum += delta;
+        max_node_delta = std::max(max_node_delta, delta);
+    }
+    std::cout << "  connected at the end: " << exact_connected << "/" << trials << " exact, "
+              << fast_connected << "/" << trials << " fast; " << flipped << " seeds differ\n"
+              << "  live nodes at the end: " << node_changed << " seeds differ, mean |delta| "
+              << static_cast<double>(node_delta_sum) / trials << ", max |delta| " << max_node_delta << "\n"
+              << "  simulation: exact " << exact_ms / trials << " ms/seed, fast " << fast_ms / trials
+              << " ms/seed  (x" << (fast_ms > 0.0 ? exact_ms / fast_ms : 0.0) << ")\n";
+    return within_bound ? 0 : 1;
+}
+
+void usage() {
+    std::cout << "usage: bench_sim <mode> [args]\n"
+              << "  cleanup [side=200] [reps=20] [dead_percent=1] [config]\n"
+              << "  handles [side=20] [config]\n"
+              << "  dieoff [side=100] [reps=3] [dead_percent=30] [config]\n"
+              << "  alloc [steps=600] [maze_size=8] [seed=0] [config]\n"
+              << "  sync [steps=300] [maze_size=24] [seed=0] [threads=4] [config]\n"
+              << "  diffusion [max_edges=1000000] [threads=4] [config]\n"
+              << "  forward [samples=4096] [reps=200] [hidden]\n"
+              << "  activation [trials=64] [steps=1200] [cols=5] [rows=5] [config]\n";
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        usage();
+        return 1;
+    }
+
+    const std::string mode = argv[1];
+    if (mode == "cleanup") return run_cleanup(argc, argv);
+    if (mode == "handles") return run_handles(argc, argv);
+    if (mode == "dieoff") return run_dieoff(argc, argv);
+    if (mode == "alloc") return run_alloc(argc, argv);
+    if (mode == "sync") return run_sync(argc, argv);
+    if (mode == "diffusion") return run_diffusion(argc, argv);
+    if (mode == "forward") return run_forward(argc, argv);
+    if (mode == "activation") return run_activation(argc, argv);
+
+    usage();
+    return 1;
+}
@@ -6,9 +6,12 @@
 // (random-weight) NeuralNetwork.  Results are written to sim_output.json.
 //
 // Build & run:
-//   cmake --build cmake-build-debug && ./cmake-build-debug/mycelium
+//   cmake --build cmake-build-debug && ./cmake-build-debug/mycelium [config] [threads]
 //
-// Then load sim_output.json in the HTML visualiser.
+// Seeds run one per worker on the trial scheduler (`threads` 0: all hardware
+// threads), sharing the config and model read-only. Each seed's console
+// output is printed as one block, in seed order; with one thread it streams
+// live. Then load sim_output_seed_<seed>.json in the HTML visualiser.
 // ---------------------------------------------------------------------------
 
 #include "node_nn/nn.h"
@@ -16,19 +19,83 @@
 #include "graph.h"    // sim::Graph, sim::step, sim::cleanup_dead
 #include "maze.h"     // sim::generate_maze, sim::Maze
 #include "export.h"   // sim::SimExporter
-#include "config.h"   // sim::load_config
+#include "step_workspace.h"  // sim::StepWorkspace
+#include "trial_scheduler.h"  // sim::run_trials
+#include "config.h"   // sim::SimConfig, sim::load_config
 
+#include <chrono>
 #include <iostream>
 #include <filesystem>
+#include <sstream>
 #include <string>
 #include <vector>
 
+namespace {
+
+// ---- Maze setup ---------------------------------------------------
+constexpr int MAZE_COLS = 5;   // "room" columns  -> grid width  = 11
+constexpr int MAZE_ROWS = 5;   // "room" rows     -> grid height = 11
+constexpr unsigned MAZE_SEED_BEGIN = 42u;
+constexpr unsigned MAZE_SEED_END   = 62u;
+
+constexpr int NUM_STEPS = 1200;
+
+// Runs one maze seed for NUM_STEPS steps and exports it to
+// sim_output_seed_<seed>.json. Console output goes to `log`.
+void run_seed(unsigned              maze_seed,
+              const node_nn::Model& nn,
+              const sim::SimConfig& config,
+              std::ostream&         log) {
+    const auto t0 = std::chrono::steady_clock::now();
+
+    sim::Maze maze = sim::generate_maze(MAZE_COLS, MAZE_ROWS, maze_seed, config);
+    const sim::Vec2 start = {1.5f, 1.5f};
+    const sim::Vec2 target = {
+        static_cast<float>(maze.width) - 1.5f,
+        static_cast<float>(maze.height) - 1.5f
+    };
+
+    sim::Graph graph = sim::build_initial_graph(maze, config);
+    sim::StepWorkspace workspace;
+
+    const std::string output_path = "sim_output_seed_" + std::to_string(maze_seed) + ".json";
+    sim::SimExporter exporter(output_path, maze);
+
+    log << "\n=== Maze seed " << maze_seed << " ===\n";
+    log << "Maze: " << maze.width << " x " << maze.height << " cells\n";
+    log << "Start:  (" << start.x << ", " << start.y << ")\n";
+    log << "Target: (" << target.x << ", " << target.y << ")\n";
+    log << "Initial graph: " << graph.nodes.size() << " nodes (all empty cells), start/end pinned\n";
+
+    for (int t = 0; t < NUM_STEPS; ++t) {
+        exporter.record(graph, t);
+
+        if ((t + 1) % 100 == 0 || t < 3) {
+            log << "[seed " << maze_seed << "] step " << (t + 1)
+                << " nodes=" << sim::live_node_count(graph) << "\n";
+        }
+
+        sim::step(graph, nn, target, maze, config, &workspace);
+    }
+
+    exporter.record(graph, NUM_STEPS);
+    exporter.finish();
+
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    log << "Done in " << seconds << " s (" << (seconds > 0.0 ? NUM_STEPS / seconds : 0.0)
+        << " steps/s). Output written to: "
+        << std::filesystem::absolute(output_path).string() << "\n";
+}
+
+} // namespace
+
 int main(int argc, char* argv[]) {
     // Ensure output is not buffered
     std::cout.setf(std::ios::unitbuf);
     
     // ---- Load hyperparameters from file -------------------------------
     // Check for command-line argument first
+    sim::SimConfig config;
     std::string config_path;
     if (argc > 1) {
         config_path = argv[1];
@@ -51,85 +118,21 @@ int main(int argc, char* argv[]) {
         
         if (!found) {
             std::cout << "Config file not found in default locations, using defaults.\n";
-            sim::set_default_config();
+            sim::set_default_config(config);
             config_path = "";
         }
     }
     
     if (!config_path.empty()) {
         std::cout << "Loading config from: " << config_path << "\n";
-        if (!sim::load_config(config_path)) {
+        if (!sim::load_config(config_path, config)) {
             std::cout << "Failed to load config, using defaults.\n";
-            sim::set_default_config();
+            sim::set_default_config(config);
         }
     }
     
-    // ---- Maze setup ---------------------------------------------------
-    constexpr int MAZE_COLS = 5;   // "room" columns  -> grid width  = 11
-    constexpr int MAZE_ROWS = 5;   // "room" rows     -> grid height = 11
-    constexpr unsigned MAZE_SEED_BEGIN = 42u;
-    constexpr unsigned MAZE_SEED_END   = 62u;
-
-    auto build_initial_graph = [](const sim::Maze& maze) {
-        sim::Graph graph;
-        const int start_col = 1;
-        const int start_row = 1;
-        const int end_col = maze.width - 2;
-        const int end_row = maze.height - 2;
-
-        std::vector<std::vector<int>> cell_to_node(
-            maze.height,
-            std::vector<int>(maze.width, -1));
-
-        for (int row = 0; row < maze.height; ++row) {
-            for (int col = 0; col < maze.width; ++col) {
-                if (maze.grid[row][col] != 0) {
-                    continue;
-                }
-
-                sim::Node node;
-                node.pos = {sim::cell_cx(col), sim::cell_cy(row)};
-                node.is_dead = false;
-                node.is_source = (col == start_col && row == start_row) ||
-                                 (col == end_col && row == end_row);
-                node.is_pinned = node.is_source;
-                node.energy = node.is_source ? sim::ENERGY_SOURCE_VALUE : sim::ENERGY_INITIAL;
-
-                graph.nodes.push_back(node);
-                cell_to_node[row][col] = static_cast<int>(graph.nodes.size()) - 1;
-            }
-        }
-
-        auto connect_if_open = [&](int row_a, int col_a, int row_b, int col_b) {
-            if (row_b < 0 || row_b >= maze.height || col_b < 0 || col_b >= maze.width) {
-                return;
-            }
-
-            int idx_a = cell_to_node[row_a][col_a];
-            int idx_b = cell_to_node[row_b][col_b];
-            if (idx_a < 0 || idx_b < 0) {
-                return;
-            }
-
-            graph.nodes[idx_a].edges.push_back({idx_b, sim::INITIAL_WEIGHT});
-            graph.nodes[idx_b].edges.push_back({idx_a, sim::INITIAL_WEIGHT});
-        };
-
-        for (int row = 0; row < maze.height; ++row) {
-            for (int col = 0; col < maze.width; ++col) {
-                if (cell_to_node[row][col] < 0) {
-                    continue;
-                }
-                connect_if_open(row, col, row, col + 1);
-                connect_if_open(row, col, row + 1, col);
-            }
-        }
-
-        return graph;
-    };
-
     // ---- Neural network: load trained model --------------------------
-    node_nn::NeuralNetwork nn;
+    node_nn::Model nn;
     const std::vector<std::string> model_paths = {
         "node_nn_model.nn",     // if running from project root
         "../node_nn_model.nn"   // if running from cmake-build-debug
@@ -148,47 +151,42 @@ int main(int argc, char* argv[]) {
         return 1;
     }
 
-    std::cout << "NeuralNetwork: loaded trained model from " << loaded_model_path << "\n";
+    const node_nn::Topology topology = node_nn::model_topology(nn);
+    std::cout << "NeuralNetwork: loaded trained model from " << loaded_model_path << " ("
+              << topology.input << "-" << topology.hidden << "-" << topology.output << ")\n";
 
     // ---- Run simulation ----------------------------------------------
-    constexpr int NUM_STEPS = 1200;
-
-    for (unsigned maze_seed = MAZE_SEED_BEGIN; maze_seed <= MAZE_SEED_END; ++maze_seed) {
-        sim::Maze maze = sim::generate_maze(MAZE_COLS, MAZE_ROWS, maze_seed);
-        const sim::Vec2 start = {1.5f, 1.5f};
-        const sim::Vec2 target = {
-            static_cast<float>(maze.width) - 1.5f,
-            static_cast<float>(maze.height) - 1.5f
-        };
-
-        sim::Graph graph = build_initial_graph(maze);
-
-        const std::string output_path = "sim_output_seed_" + std::to_string(maze_seed) + ".json";
-        sim::SimExporter exporter(output_path, maze);
-
-        std::cout << "\n=== Maze seed " << maze_seed << " ===\n";
-        std::cout << "Maze: " << maze.width << " x " << maze.height << " cells\n";
-        std::cout << "Start:  (" << start.x << ", " << start.y << ")\n";
-        std::cout << "Target: (" << target.x << ", " << target.y << ")\n";
-        std::cout << "Initial graph: " << graph.nodes.size() << " nodes (all empty cells), start/end pinned\n";
-
-        for (int t = 0; t < NUM_STEPS; ++t) {
-            exporter.record(graph, t);
-
-            if ((t + 1) % 100 == 0 || t < 3) {
-                std::cout << "[seed " << maze_seed << "] step " << (t + 1)
-                          << " nodes=" << graph.nodes.size() << "\n";
-            }
-
-            sim::step(graph, nn, target, maze);
+    const int num_seeds = static_cast<int>(MAZE_SEED_END - MAZE_SEED_BEGIN) + 1;
+    sim::TrialSchedulerOptions scheduler;
+    scheduler.threads = (argc > 2) ? std::stoi(argv[2]) : 0;  // 0: all hardware threads
+    const int num_threads = sim::trial_thread_count(scheduler, num_seeds);
+    std::cout << "Running " << num_seeds << " seeds on " << num_threads << " threads\n";
+
+    const auto t0 = std::chrono::steady_clock::now();
+    if (num_threads == 1) {
+        for (int i = 0; i < num_seeds; ++i) {
+            run_seed(MAZE_SEED_BEGIN + static_cast<unsigned>(i), nn, config, std::cout);
         }
-
-        exporter.record(graph, NUM_STEPS);
-        exporter.finish();
-
-        std::cout << "Done. Output written to: "
-                  << std::filesystem::absolute(output_path).string() << "\n";
+    } else {
+        sim::run_trials(
+            num_seeds,
+            scheduler,
+            [](int) { return 1.0; },
+            [&](int i) {
+                std::ostringstream log;
+                run_seed(MAZE_SEED_BEGIN + static_cast<unsigned>(i), nn, config, log);
+                return log.str();
+            },
+            [](int, std::string& log) { std::cout << log; });
     }
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+
+    std::cout << "\n=== Summary ===\n"
+              << num_seeds << " seeds x " << NUM_STEPS << " steps on " << num_threads
+              << " threads in " << seconds << " s wall\n"
+              << "Throughput: " << (seconds > 0.0 ? num_seeds / seconds : 0.0) << " seeds/s, "
+              << (seconds > 0.0 ? static_cast<double>(num_seeds) * NUM_STEPS / seconds : 0.0)
+              << " steps/s\n";
 
     return 0;
 }
\ No newline at end of file
@@ -0,0 +1,253 @@
+#include "../nn.h"
+#include <algorithm>
+
+// AVX2 kernel: compiled for AVX2 with a per-function target on GCC / Clang
+// (the rest of the library keeps the baseline ISA) and picked at run time.
+// No FMA: fused multiply-adds would round differently from forward().
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define NODE_NN_HAVE_AVX2 1
+#define NODE_NN_AVX2_TARGET __attribute__((target("avx2")))
+#include <immintrin.h>
+#elif defined(_MSC_VER) && defined(_M_X64)
+#define NODE_NN_HAVE_AVX2 1
+#define NODE_NN_AVX2_TARGET
+#include <immintrin.h>
+#include <intrin.h>
+#else
+#define NODE_NN_HAVE_AVX2 0
+#endif
+
+namespace node_nn {
+
+    // ---- Portable kernel -------------------------------------------------
+    //
+    // Samples go through in tiles so the hidden layer stays on the stack; the
+    // per-feature inner loops are left to the compiler's vectoriser. Per sample
+    // the sums run in the same order as in forward(). Tiles too short to pay
+    // for the loop setup use forward() itself.
+
+    // v[s] = activation(v[s] + bias), with the activation chosen outside the
+    // loop so fast_tanh vectorises.
+    static void activate_row(float *v, int n, float bias, Activation activation) {
+        if (activation == Activation::FAST_TANH) {
+            for (int s = 0; s < n; s++) v[s] = fast_tanh(v[s] + bias);
+        } else {
+            for (int s = 0; s < n; s++) v[s] = activate(v[s] + bias);
+        }
+    }
+
+    template <std::size_t IN, std::size_t HIDDEN, std::size_t OUT>
+    void forward_batch_portable(const BasicNeuralNetwork<IN, HIDDEN, OUT> &nn,
+                                const float *x,
+                                float *y,
+                                int count,
+                                float *h_out) {
+
+        constexpr int TILE = 64;
+        constexpr int MIN_TILE = 8;
+        float h[HIDDEN][TILE];
+
+        for (int s0 = 0; s0 < count; s0 += TILE) {
+            const int n = std::min(TILE, count - s0);
+
+            if (n < MIN_TILE) {
+                std::array<float, IN> xs{};
+                std::array<float, OUT> ys{};
+                std::array<float, HIDDEN> hs{};
+                for (int s = s0; s < s0 + n; s++) {
+                    for (size_t j = 0; j < IN; j++) xs[j] = x[j * count + s];
+                    forward(nn, xs, ys, hs);
+                    for (size_t i = 0; i < OUT; i++) y[i * count + s] = ys[i];
+                    if (h_out) {
+                        for (size_t i = 0; i < HIDDEN; i++) h_out[i * count + s] = hs[i];
+                    }
+                }
+                continue;
+            }
+
+            for (size_t i = 0; i < HIDDEN; i++) {
+                float *hi = h[i];
+                for (int s = 0; s < n; s++) hi[s] = 0.0f;
+                NODE_NN_UNROLL
+                for (size_t j = 0; j < IN; j++) {
+                    const float w = nn.W1[i][j];
+                    const float *xj = x + j * count + s0;
+                    for (int s = 0; s < n; s++) hi[s] += xj[s] * w;
+                }
+                activate_row(hi, n, nn.b1[i], nn.activation);
+                if (h_out) std::copy(hi, hi + n, h_out + i * count + s0);
+            }
+
+            for (size_t i = 0; i < OUT; i++) {
+                float *yi = y + i * count + s0;
+                for (int s = 0; s < n; s++) yi[s] = 0.0f;
+                NODE_NN_UNROLL
+                for (size_t j = 0; j < HIDDEN; j++) {
+                    const float w = nn.W2[i][j];
+                    const float *hj = h[j];
+                    for (int s = 0; s < n; s++) yi[s] += hj[s] * w;
+                }
+                activate_row(yi, n, nn.b2[i], nn.activation);
+            }
+        }
+    }
+
+    // ---- AVX2 kernel -----------------------------------------------------
+    //
+    // Eight samples per register: the whole 8 -> 8 -> 7 pass for a block of
+    // eight stays in registers. Exact tanh goes lane by lane through
+    // activate(); fast_tanh runs on the whole register with the scalar
+    // version's operations, so results match forward() exactly either way.
+    // The last count % 8 samples use forward().
+
+#if NODE_NN_HAVE_AVX2
+
+    bool has_avx2() {
+#if defined(_MSC_VER) && !defined(__clang__)
+        int regs[4];
+        __cpuid(regs, 0);
+        if (regs[0] < 7) return false;
+        __cpuid(regs, 1);
+        const bool osxsave = (regs[2] & (1 << 27)) != 0;
+        const bool avx = (regs[2] & (1 << 28)) != 0;
+        if (!osxsave || !avx || (_xgetbv(0) & 6) != 6) return false;
+        __cpuidex(regs, 7, 0);
+        return (regs[1] & (1 << 5)) != 0;
+#else
+        return __builtin_cpu_supports("avx2");
+#endif
+    }
+
+    NODE_NN_AVX2_TARGET static __m256 fast_tanh8(__m256 x) {
+        const __m256 c = _mm256_min_ps(_mm256_max_ps(x, _mm256_set1_ps(-7.90531110763549805f)),
+                                       _mm256_set1_ps(7.90531110763549805f));
+        const __m256 x2 = _mm256_mul_ps(c, c);
+        __m256 p = _mm256_set1_ps(-2.76076847742355e-16f);
+        p = _mm256_add_ps(_mm256_mul_ps(p, x2), _mm256_set1_ps(2.00018790482477e-13f));
+        p = _mm256_add_ps(_mm256_mul_ps(p, x2), _mm256_set1_ps(-8.60467152213735e-11f));
+        p = _mm256_add_ps(_mm256_mul_ps(p, x2), _mm256_set1_ps(5.12229709037114e-08f));
+        p = _mm256_add_ps(_mm256_mul_ps(p, x2), _mm256_set1_ps(1.48572235717979e-05f));
+        p = _mm256_add_ps(_mm256_mul_ps(p, x2), _mm256_set1_ps(6.37261928875436e-04f));
+        p = _mm256_add_ps(_mm256_mul_ps(p, x2), _mm256_set1_ps(4.89352455891786e-03f));
+        p = _mm256_mul_ps(p, c);
+        __m256 q = _mm256_set1_ps(1.19825839466702e-06f);
+        q = _mm256_add_ps(_mm256_mul_ps(q, x2), _mm256_set1_ps(1.18534705686654e-04f));
+        q = _mm256_add_ps(_mm256_mul_ps(q, x2), _mm256_set1_ps(2.26843463243900e-03f));
+        q = _mm256_add_ps(_mm256_mul_ps(q, x2), _mm256_set1_ps(4.89352518554385e-03f));
+        return _mm256_div_ps(p, q);
+    }
+
+    NODE_NN_AVX2_TARGET static __m256 activate8(__m256 v, Activation activation) {
+        if (activation == Activation::FAST_TANH) return fast_tanh8(v);
+        alignas(32) float lanes[8];
+        _mm256_store_ps(lanes, v);
+        for (float &lane : lanes) lane = activate(lane);
+        return _mm256_load_ps(lanes);
+    }
+
+    // The blocks of eight. A separate static template: GCC treats a target
+    // attribute on a template definition as another version of the function,
+    // not as the definition of the declaration in nn.h.
+    template <std::size_t IN, std::size_t HIDDEN, std::size_t OUT>
+    NODE_NN_AVX2_TARGET static void forward_blocks_avx2(const BasicNeuralNetwork<IN, HIDDEN, OUT> &nn,
+                                                        const float *x,
+                                                        float *y,
+                                                        int count,
+                                                        float *h_out) {
+
+        const int blocks = count / 8;
+        for (int b = 0; b < blocks; b++) {
+            const int s0 = b * 8;
+
+            __m256 xv[IN];
+            NODE_NN_UNROLL
+            for (size_t j = 0; j < IN; j++) xv[j] = _mm256_loadu_ps(x + j * count + s0);
+
+            __m256 hv[HIDDEN];
+            NODE_NN_UNROLL
+            for (size_t i = 0; i < HIDDEN; i++) {
+                __m256 acc = _mm256_setzero_ps();
+                NODE_NN_UNROLL
+                for (size_t j = 0; j < IN; j++) {
+                    acc = _mm256_add_ps(acc, _mm256_mul_ps(xv[j], _mm256_set1_ps(nn.W1[i][j])));
+                }
+                hv[i] = activate8(_mm256_add_ps(acc, _mm256_set1_ps(nn.b1[i])), nn.activation);
+                if (h_out) _mm256_storeu_ps(h_out + i * count + s0, hv[i]);
+            }
+
+            NODE_NN_UNROLL
+            for (size_t i = 0; i < OUT; i++) {
+                __m256 acc = _mm256_setzero_ps();
+                NODE_NN_UNROLL
+                for (size_t j = 0; j < HIDDEN; j++) {
+                    acc = _mm256_add_ps(acc, _mm256_mul_ps(hv[j], _mm256_set1_ps(nn.W2[i][j])));
+                }
+                _mm256_storeu_ps(y + i * count + s0,
+                                 activate8(_mm256_add_ps(acc, _mm256_set1_ps(nn.b2[i])), nn.activation));
+            }
+        }
+    }
+
+    template <std::size_t IN, std::size_t HIDDEN, std::size_t OUT>
+    void forward_batch_avx2(const BasicNeuralNetwork<IN, HIDDEN, OUT> &nn,
+                            const float *x,
+                            float *y,
+                            int count,
+                            float *h_out) {
+
+        forward_blocks_avx2(nn, x, y, count, h_out);
+
+        const int blocks = count / 8;
+        std::array<float, IN> xs{};
+        std::array<float, OUT> ys{};
+        std::array<float, HIDDEN> hs{};
+        for (int s = blocks * 8; s < count; s++) {
+            for (size_t j = 0; j < IN; j++) xs[j] = x[j * count + s];
+            forward(nn, xs, ys, hs);
+            for (size_t i = 0; i < OUT; i++) y[i * count + s] = ys[i];
+            if (h_out) {
+                for (size_t i = 0; i < HIDDEN; i++) h_out[i * count + s] = hs[i];
+            }
+        }
+    }
+
+#else
+
+    bool has_avx2() {
+        return false;
+    }
+
+    template <std::size_t IN, std::size_t HIDDEN, std::size_t OUT>
+    void forward_batch_avx2(const BasicNeuralNetwork<IN, HIDDEN, OUT> &nn, const float *x, float *y, int count,
+                            float *h_out) {
+        forward_batch_portable(nn, x, y, count, h_out);
+    }
+
+#endif
+
+    // ---- Dispatch --------------------------------------------------------
+
+    template <std::size_t IN, std::size_t HIDDEN, std::size_t OUT>
+    void forward_batch(const BasicNeuralNetwork<IN, HIDDEN, OUT> &nn, const float *x, float *y, int count, float *h) {
+        static const bool use_avx2 = has_avx2();
+        if (use_avx2) {
+            forward_batch_avx2(nn, x, y, count, h);
+        } else {
+            forward_batch_portable(nn, x, y, count, h);
+        }
+    }
+
+    // ---- Explicit instantiations -----------------------------------------
+
+#define NODE_NN_INSTANTIATE(I, H, O)                                                                         \
+    template void forward_batch(const BasicNeuralNetwork<I, H, O> &, const float *, float *, int, float *);  \
+    template void forward_batch_portable(const BasicNeuralNetwork<I, H, O> &, const float *, float *, int,   \
+                                         float *);                                                           \
+    template void forward_batch_avx2(const BasicNeuralNetwork<I, H, O> &, const float *, float *, int,       \
+                                     float *);
+
+    NODE_NN_TOPOLOGIES(NODE_NN_INSTANTIATE)
+
+#undef NODE_NN_INSTANTIATE
+
+}
@@ -0,0 +1,71 @@
+#include "model.h"
+
+namespace node_nn {
+
+    // ---- Dispatch table --------------------------------------------------
+    //
+    // One entry per built-in topology: what a model file may declare, and how
+    // to construct the matching network.
+
+    struct TopologyEntry {
+        Topology topology;
+        void (*create)(Model &model);
+    };
+
+#define NODE_NN_TOPOLOGY_ENTRY(I, H, O)                                                      \
+    {{I, H, O}, [](Model &model) { model.emplace<BasicNeuralNetwork<I, H, O>>(); }},
+#define NODE_NN_CHECK_IO(I, H, O)                                                            \
+    static_assert(I == INPUT_SIZE && O == OUTPUT_SIZE,                                       \
+                  "NODE_NN_TOPOLOGIES entries must keep the simulator's input / output sizes");
+
+    NODE_NN_TOPOLOGIES(NODE_NN_CHECK_IO)
+
+    static const TopologyEntry TOPOLOGIES[] = {
+        NODE_NN_TOPOLOGIES(NODE_NN_TOPOLOGY_ENTRY)
+    };
+
+#undef NODE_NN_CHECK_IO
+#undef NODE_NN_TOPOLOGY_ENTRY
+
+    const std::vector<Topology> &topologies() {
+        static const std::vector<Topology> list = [] {
+            std::vector<Topology> result;
+            for (const TopologyEntry &entry : TOPOLOGIES) result.push_back(entry.topology);
+            return result;
+        }();
+        return list;
+    }
+
+    bool create_model(const Topology &topology, Model &model) {
+        for (const TopologyEntry &entry : TOPOLOGIES) {
+            if (entry.topology == topology) {
+                entry.create(model);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // ---- Accessors -------------------------------------------------------
+
+    Topology model_topology(const Model &model) {
+        return std::visit([](const auto &nn) { return nn.TOPOLOGY; }, model);
+    }
+
+    Activation model_activation(const Model &model) {
+        return std::visit([](const auto &nn) { return nn.activation; }, model);
+    }
+
+    void set_activation(Model &model, Activation activation) {
+        std::visit([&](auto &nn) { nn.activation = activation; }, model);
+    }
+
+    void forward(const Model &model, const std::array<float, INPUT_SIZE> &x, std::array<float, OUTPUT_SIZE> &y) {
+        std::visit([&](const auto &nn) { forward(nn, x, y); }, model);
+    }
+
+    void forward_batch(const Model &model, const float *x, float *y, int count, float *h) {
+        std::visit([&](const auto &nn) { forward_batch(nn, x, y, count, h); }, model);
+    }
+
+}
@@ -0,0 +1,41 @@
+#pragma once
+#include "nn.h"
+#include <variant>
+#include <vector>
+
+namespace node_nn {
+
+    namespace detail {
+        template <typename Void, typename... Networks>
+        struct ModelVariant {
+            using type = std::variant<Networks...>;
+        };
+    }
+
+    // A network of any topology in NODE_NN_TOPOLOGIES, chosen at run time
+    // (e.g. by the model file it was loaded from). Default-constructs as a
+    // random network of the default topology. Code that needs the concrete
+    // network visits it:
+    //
+    //   std::visit([&](auto &nn) { node_nn::adam(nn, data, state_for(nn)); }, model);
+#define NODE_NN_MODEL_NETWORK(I, H, O) , BasicNeuralNetwork<I, H, O>
+    using Model = detail::ModelVariant<void NODE_NN_TOPOLOGIES(NODE_NN_MODEL_NETWORK)>::type;
+#undef NODE_NN_MODEL_NETWORK
+
+    // Built-in topologies, in NODE_NN_TOPOLOGIES order.
+    const std::vector<Topology> &topologies();
+
+    // Replaces `model` with a randomly initialised network of `topology`.
+    // Returns false, leaving `model` unchanged, if it is not built in.
+    bool create_model(const Topology &topology, Model &model);
+
+    Topology model_topology(const Model &model);
+    Activation model_activation(const Model &model);
+    void set_activation(Model &model, Activation activation);
+
+    // forward / forward_batch of whichever network `model` holds (`h`, if
+    // given, has model_topology(model).hidden rows).
+    void forward(const Model &model, const std::array<float, INPUT_SIZE> &x, std::array<float, OUTPUT_SIZE> &y);
+    void forward_batch(const Model &model, const float *x, float *y, int count, float *h = nullptr);
+
+}
@@ -1,17 +1,20 @@
 #include "../nn.h"
+#include <algorithm>
 #include <cmath>
 #include <vector>
 #include <random>
 
 namespace node_nn {
-    void Parameters::set_zero() {
+    template <std::size_t IN, std::size_t HIDDEN, std::size_t OUT>
+    void BasicParameters<IN, HIDDEN, OUT>::set_zero() {
         for (auto& row : W1) row.fill(0.0f);
         b1.fill(0.0f);
         for (auto& row : W2) row.fill(0.0f);
         b2.fill(0.0f);
     }
 
-    void Parameters::randomize() {
+    template <std::size_t IN, std::size_t HIDDEN, std::size_t OUT>
+    void BasicParameters<IN, HIDDEN, OUT>::randomize() {
         std::random_device rd;
         auto gen = std::mt19937(rd());
         auto dist = std::uniform_real_distribution<float>(-1.0f, 1.0f);
@@ -27,122 +30,233 @@ namespace node_nn {
         for (auto& b : b2) b = dist(gen);
     }
 
-    NeuralNetwork::NeuralNetwork() : Parameters() {
+    template <std::size_t IN, std::size_t HIDDEN, std::size_t OUT>
+    BasicNeuralNetwork<IN, HIDDEN, OUT>::BasicNeuralNetwork() : BasicParameters<IN, HIDDEN, OUT>() {
         this->randomize();
     }
 
-    Gradients::Gradients() : Parameters() {
+    template <std::size_t IN, std::size_t HIDDEN, std::size_t OUT>
+    BasicGradients<IN, HIDDEN, OUT>::BasicGradients() : BasicParameters<IN, HIDDEN, OUT>() {
         this->set_zero();
     }
 
-    AdamM::AdamM() : Parameters() {
+    template <std::size_t IN, std::size_t HIDDEN, std::size_t OUT>
+    BasicAdamM<IN, HIDDEN, OUT>::BasicAdamM() : BasicParameters<IN, HIDDEN, OUT>() {
         this->set_zero();
     }
 
-    AdamV::AdamV() : Parameters() {
+    template <std::size_t IN, std::size_t HIDDEN, std::size_t OUT>
+    BasicAdamV<IN, HIDDEN, OUT>::BasicAdamV() : BasicParameters<IN, HIDDEN, OUT>() {
         this->set_zero();
     }
 
-    AdamState::AdamState() : m(), v(), t(0) {}
+    template <std::size_t IN, std::size_t HIDDEN, std::size_t OUT>
+    BasicAdamState<IN, HIDDEN, OUT>::BasicAdamState() : m(), v(), t(0) {}
+
+    template <std::size_t IN, std::size_t HIDDEN, std::size_t OUT>
+    void forward(const BasicNeuralNetwork<IN, HIDDEN, OUT> &nn,
+                 const std::array<float, IN> &x,
+                 std::array<float, OUT> &y,
+                 std::array<float, HIDDEN> &h) {
+
+        NODE_NN_UNROLL
+        for (size_t i = 0; i < HIDDEN; i++) {
+            float sum = 0.0f;
+            NODE_NN_UNROLL
+            for (size_t j = 0; j < IN; j++) {
+                sum += x[j] * nn.W1[i][j];
+            }
+            h[i] = activate(sum + nn.b1[i], nn.activation);
+        }
 
-    void forward(const NeuralNetwork &nn,
-                 const std::array<float, INPUT_SIZE> &x,
-                 std::array<float, OUTPUT_SIZE> &y,
-                 std::array<float, HIDDEN_SIZE> &h) {
+        NODE_NN_UNROLL
+        for (size_t i = 0; i < OUT; i++) {
+            float sum = 0.0f;
+            NODE_NN_UNROLL
+            for (size_t j = 0; j < HIDDEN; j++) {
+                sum += h[j] * nn.W2[i][j];
+            }
+            y[i] = activate(sum + nn.b2[i], nn.activation);
+        }
+    }
 
-        h = {};
-        y = {};
+    template <std::size_t IN, std::size_t HIDDEN, std::size_t OUT>
+    void forward(const BasicNeuralNetwork<IN, HIDDEN, OUT> &nn,
+                 const std::array<float, IN> &x,
+                 std::array<float, OUT> &y) {
+        std::array<float, HIDDEN> h = {};
+        forward(nn, x, y, h);
+    }
 
-        for (int i = 0; i < HIDDEN_SIZE; i++) {
-            for (int j = 0; j < INPUT_SIZE; j++) {
-                h[i] += x[j] * nn.W1[i][j];
+    // Runs forward_batch over samples sample(0 .. count) in chunks and calls
+    // visit(i, y, h) for every sample in order with its outputs and hidden
+    // activations (the values forward() would give).
+    template <std::size_t IN, std::size_t HIDDEN, std::size_t OUT, typename Sample, typename Visit>
+    static void for_each_forward(const BasicNeuralNetwork<IN, HIDDEN, OUT> &nn,
+                                 size_t count,
+                                 Sample sample,
+                                 Visit visit) {
+
+        constexpr size_t CHUNK = 256;
+        const size_t chunk = std::min(CHUNK, count);
+        std::vector<float> xs(IN * chunk);
+        std::vector<float> ys(OUT * chunk);
+        std::vector<float> hs(HIDDEN * chunk);
+        std::array<float, OUT> y{};
+        std::array<float, HIDDEN> h{};
+
+        for (size_t s0 = 0; s0 < count; s0 += CHUNK) {
+            const int n = static_cast<int>(std::min(CHUNK, count - s0));
+            for (int s = 0; s < n; s++) {
+                const std::array<float, IN> &x = sample(s0 + s);
+                for (size_t j = 0; j < IN; j++) xs[j * n + s] = x[j];
+            }
+            forward_batch(nn, xs.data(), ys.data(), n, hs.data());
+            for (int s = 0; s < n; s++) {
+                for (size_t i = 0; i < OUT; i++) y[i] = ys[i * n + s];
+                for (size_t i = 0; i < HIDDEN; i++) h[i] = hs[i * n + s];
+                visit(s0 + s, y, h);
             }
-            h[i] += nn.b1[i];
-            h[i] = activate(h[i]);
         }
+    }
 
-        for (int i = 0; i < OUTPUT_SIZE; i++) {
-            for (int j = 0; j < HIDDEN_SIZE; j++) {
-                y[i] += h[j] * nn.W2[i][j];
+    // Backward pass of one sample given its forward values.
+    template <std::size_t IN, std::size_t HIDDEN, std::size_t OUT>
+    static void accumulate_gradients(const BasicNeuralNetwork<IN, HIDDEN, OUT> &nn,
+                                     const std::array<float, IN> &x,
+                                     const std::array<float, OUT> &target,
+                                     const std::array<float, OUT> &y,
+                                     const std::array<float, HIDDEN> &h,
+                                     BasicGradients<IN, HIDDEN, OUT> &gradient) {
+
+        std::array<float, OUT> output_deltas{};
+        std::array<float, HIDDEN> hidden_deltas{};
+        NODE_NN_UNROLL
+        for (size_t i = 0; i < OUT; i++) {
+            float output_error = target[i] - y[i];
+            output_deltas[i] = output_error * (1 - y[i] * y[i]);
+        }
+        NODE_NN_UNROLL
+        for (size_t i = 0; i < HIDDEN; i++) {
+            float hidden_error = 0.0f;
+            NODE_NN_UNROLL
+            for (size_t j = 0; j < OUT; j++) {
+                hidden_error += output_deltas[j] * nn.W2[j][i];
             }
-            y[i] += nn.b2[i];
-            y[i] = activate(y[i]);
+            hidden_deltas[i] = hidden_error * (1 - h[i] * h[i]);
+        }
+        NODE_NN_UNROLL
+        for (size_t i = 0; i < OUT; i++) {
+            NODE_NN_UNROLL
+            for (size_t j = 0; j < HIDDEN; j++) {
+                gradient.W2[i][j] += output_deltas[i] * h[j];
+            }
+            gradient.b2[i] += output_deltas[i];
+        }
+        NODE_NN_UNROLL
+        for (size_t i = 0; i < HIDDEN; i++) {
+            NODE_NN_UNROLL
+            for (size_t j = 0; j < IN; j++) {
+                gradient.W1[i][j] += hidden_deltas[i] * x[j];
+            }
+            gradient.b1[i] += hidden_deltas[i];
         }
     }
 
-    void forward(const NeuralNetwork &nn,
-                 const std::array<float, INPUT_SIZE> &x,
-                 std::array<float, OUTPUT_SIZE> &y) {
-        std::array<float, HIDDEN_SIZE> h = {};
-        forward(nn, x, y, h);
+    // add_gradients over every sample, with batched forward passes.
+    template <std::size_t IN, std::size_t HIDDEN, std::size_t OUT>
+    static void add_gradients(const BasicNeuralNetwork<IN, HIDDEN, OUT> &nn,
+                              const std::vector<std::array<float, IN>> &input,
+                              const std::vector<std::array<float, OUT>> &target,
+                              BasicGradients<IN, HIDDEN, OUT> &gradient) {
+
+        for_each_forward(nn, input.size(),
+                         [&](size_t i) -> const std::array<float, IN> & { return input[i]; },
+                         [&](size_t i, const std::array<float, OUT> &y, const std::array<float, HIDDEN> &h) {
+                             accumulate_gradients(nn, input[i], target[i], y, h, gradient);
+                         });
     }
 
-    void cost(const std::array<float, OUTPUT_SIZE> &y,
-              const std::array<float, OUTPUT_SIZE> &target,
-              float &error) {
-        error = 0.0f;
-        for (int i = 0; i < OUTPUT_SIZE; i++) {
-            error += (y[i] - target[i]) * (y[i] - target[i]);
-        }
-        error /= (OUTPUT_SIZE * 2);
+    template <std::size_t IN, std::size_t HIDDEN, std::size_t OUT>
+    void add_gradients(const BasicNeuralNetwork<IN, HIDDEN, OUT> &nn,
+                       const std::vector<std::array<float, IN>> &input,
+                       const std::vector<std::array<float, OUT>> &target,
+                       const std::vector<size_t> &order,
+                       size_t begin,
+                       size_t end,
+                       BasicGradients<IN, HIDDEN, OUT> &gradient) {
+
+        for_each_forward(nn, end - begin,
+                         [&](size_t k) -> const std::array<float, IN> & { return input[order[begin + k]]; },
+                         [&](size_t k, const std::array<float, OUT> &y, const std::array<float, HIDDEN> &h) {
+                             const size_t i = order[begin + k];
+                             accumulate_gradients(nn, input[i], target[i], y, h, gradient);
+                         });
     }
 
-    void single_back_propagate(NeuralNetwork &nn,
-                               const std::array<float, INPUT_SIZE> &x,
-                               const std::array<float, OUTPUT_SIZE> &target) {
+    template <std::size_t IN, std::size_t HIDDEN, std::size_t OUT>
+    void single_back_propagate(BasicNeuralNetwork<IN, HIDDEN, OUT> &nn,
+                               const std::array<float, IN> &x,
+                               const std::array<float, OUT> &target) {
 
-        Gradients gradient;
+        BasicGradients<IN, HIDDEN, OUT> gradient;
         add_gradients(nn, x, target, gradient);
         apply_gradients(nn, gradient, 1.0f);
     }
 
-    void back_propagate(NeuralNetwork &nn,
-                        const std::vector<std::array<float, INPUT_SIZE>> &input,
-                        const std::vector<std::array<float, OUTPUT_SIZE>> &target) {
+    template <std::size_t IN, std::size_t HIDDEN, std::size_t OUT>
+    void back_propagate(BasicNeuralNetwork<IN, HIDDEN, OUT> &nn,
+                        const std::vector<std::array<float, IN>> &input,
+                        const std::vector<std::array<float, OUT>> &target) {
 
         if (input.size() != target.size()) {
             return;
         }
 
-        Gradients gradient;
-        for (int i = 0;i < input.size(); i++) {
-            add_gradients(nn, input[i], target[i], gradient);
-        }
+        BasicGradients<IN, HIDDEN, OUT> gradient;
+        add_gradients(nn, input, target, gradient);
         apply_gradients(nn, gradient, static_cast<float>(input.size()));
     }
 
-    void back_propagate(NeuralNetwork &nn, const TrainingData &data) {
+    template <std::size_t IN, std::size_t HIDDEN, std::size_t OUT>
+    void back_propagate(BasicNeuralNetwork<IN, HIDDEN, OUT> &nn, const BasicTrainingData<IN, OUT> &data) {
         back_propagate(nn, data.input, data.target);
     }
 
-    void adam(NeuralNetwork &nn,
-              const std::vector<std::array<float, INPUT_SIZE>> &input,
-              const std::vector<std::array<float, OUTPUT_SIZE>> &target,
-              AdamState &state) {
+    template <std::size_t IN, std::size_t HIDDEN, std::size_t OUT>
+    void adam(BasicNeuralNetwork<IN, HIDDEN, OUT> &nn,
+              const std::vector<std::array<float, IN>> &input,
+              const std::vector<std::array<float, OUT>> &target,
+              BasicAdamState<IN, HIDDEN, OUT> &state) {
 
         if (input.size() != target.size()) {
             return;
         }
 
-        Gradients gradient;
-
-        for (int i = 0;i < input.size(); i++) {
-            add_gradients(nn, input[i], target[i], gradient);
-        }
+        BasicGradients<IN, HIDDEN, OUT> gradient;
+        add_gradients(nn, input, target, gradient);
 
         average_gradients(gradient, static_cast<float>(input.size()));
+        adam_step(nn, gradient, state, LEARNING_RATE);
+    }
+
+    template <std::size_t IN, std::size_t HIDDEN, std::size_t OUT>
+    void adam_step(BasicNeuralNetwork<IN, HIDDEN, OUT> &nn,
+                   const BasicGradients<IN, HIDDEN, OUT> &gradient,
+                   BasicAdamState<IN, HIDDEN, OUT> &state,
+                   const float learning_rate) {
 
         state.t += 1;
 
         float bias_correction_1 = 1.0f - std::pow(BETA_1, static_cast<float>(state.t));
         float bias_correction_2 = 1.0f - std::pow(BETA_2, static_cast<float>(state.t));
 
-        const float lr = LEARNING_RATE;
+        const float lr = learning_rate;
         const float beta_1_complement = 1 - BETA_1;
         const float beta_2_complement = 1 - BETA_2;
 
-        for (int i = 0; i < HIDDEN_SIZE; i++) {
-            for (int j = 0; j < INPUT_SIZE; j++) {
+        for (size_t i = 0; i < HIDDEN; i++) {
+            for (size_t j = 0; j < IN; j++) {
                 state.m.W1[i][j] = BETA_1 * state.m.W1[i][j] + beta_1_complement * gradient.W1[i][j];
                 state.v.W1[i][j] = BETA_2 * state.v.W1[i][j] + beta_2_complement * gradient.W1[i][j] * gradient.W1[i][j];
                 float m_hat = state.m.W1[i][j] / bias_correction_1;
@@ -155,8 +269,8 @@ namespace node_nn {
             float v_hat = state.v.b1[i] / bias_correction_2;
             nn.b1[i] = nn.b1[i] + lr * (m_hat / std::sqrt(v_hat + EPSILON));
         }
-        for (int i = 0; i < OUTPUT_SIZE; i++) {
-            for (int j = 0; j < HIDDEN_SIZE; j++) {
+        for (size_t i = 0; i < OUT; i++) {
+            for (size_t j = 0; j < HIDDEN; j++) {
                 state.m.W2[i][j] = BETA_1 * state.m.W2[i][j] + beta_1_complement * gradient.W2[i][j];
                 state.v.W2[i][j] = BETA_2 * state.v.W2[i][j] + beta_2_complement * gradient.W2[i][j] * gradient.W2[i][j];
                 float m_hat = state.m.W2[i][j] / bias_correction_1;
@@ -171,106 +285,130 @@ namespace node_nn {
         }
     }
 
-    void adam(NeuralNetwork &nn,
-              const TrainingData &data,
-              AdamState &state) {
+    template <std::size_t IN, std::size_t HIDDEN, std::size_t OUT>
+    void adam(BasicNeuralNetwork<IN, HIDDEN, OUT> &nn,
+              const BasicTrainingData<IN, OUT> &data,
+              BasicAdamState<IN, HIDDEN, OUT> &state) {
         adam(nn, data.input, data.target, state);
     }
 
-    void add_gradients(const NeuralNetwork &nn,
-                       const std::array<float, INPUT_SIZE> &x,
-                       const std::array<float, OUTPUT_SIZE> &target,
-                       Gradients &gradient) {
+    template <std::size_t IN, std::size_t HIDDEN, std::size_t OUT>
+    void add_gradients(const BasicNeuralNetwork<IN, HIDDEN, OUT> &nn,
+                       const std::array<float, IN> &x,
+                       const std::array<float, OUT> &target,
+                       BasicGradients<IN, HIDDEN, OUT> &gradient) {
 
-        std::array<float, HIDDEN_SIZE> h = {};
-        std::array<float, OUTPUT_SIZE> y = {};
-        float error;
+        std::array<float, HIDDEN> h = {};
+        std::array<float, OUT> y = {};
 
         forward(nn, x, y, h);
-        cost(y, target, error);
-        std::array<float, OUTPUT_SIZE> output_deltas{};
-        std::array<float, HIDDEN_SIZE> hidden_deltas{};
-        for (int i = 0; i < OUTPUT_SIZE; i++) {
-            float output_error = target[i] - y[i];
-            output_deltas[i] = output_error * (1 - y[i] * y[i]);
-        }
-        for (int i = 0; i < HIDDEN_SIZE; i++) {
-            float hidden_error = 0.0f;
-            for (int j = 0; j < OUTPUT_SIZE; j++) {
-                hidden_error += output_deltas[j] * nn.W2[j][i];
-            }
-            hidden_deltas[i] = hidden_error * (1 - h[i] * h[i]);
-        }
-        for (int i = 0; i < OUTPUT_SIZE; i++) {
-            for (int j = 0; j < HIDDEN_SIZE; j++) {
-                gradient.W2[i][j] += output_deltas[i] * h[j];
-            }
-            gradient.b2[i] += output_deltas[i];
-        }
-        for (int i = 0; i < HIDDEN_SIZE; i++) {
-            for (int j = 0; j < INPUT_SIZE; j++) {
-                gradient.W1[i][j] += hidden_deltas[i] * x[j];
-            }
-            gradient.b1[i] += hidden_deltas[i];
-        }
+        accumulate_gradients(nn, x, target, y, h, gradient);
     }
 
-    void apply_gradients(NeuralNetwork &nn, const Gradients &gradient, float batch_size) {
+    template <std::size_t IN, std::size_t HIDDEN, std::size_t OUT>
+    void apply_gradients(BasicNeuralNetwork<IN, HIDDEN, OUT> &nn,
+                         const BasicGradients<IN, HIDDEN, OUT> &gradient,
+                         float batch_size) {
         float lr = LEARNING_RATE / batch_size;
-        for (int i = 0; i < HIDDEN_SIZE; i++) {
-            for (int j = 0; j < INPUT_SIZE; j++) {
+        for (size_t i = 0; i < HIDDEN; i++) {
+            for (size_t j = 0; j < IN; j++) {
                 nn.W1[i][j] += gradient.W1[i][j] * lr;
             }
             nn.b1[i] += gradient.b1[i] * lr;
         }
-        for (int i = 0; i < OUTPUT_SIZE; i++) {
-            for (int j = 0; j < HIDDEN_SIZE; j++) {
+        for (size_t i = 0; i < OUT; i++) {
+            for (size_t j = 0; j < HIDDEN; j++) {
                 nn.W2[i][j] += gradient.W2[i][j] * lr;
             }
             nn.b2[i] += gradient.b2[i] * lr;
         }
     }
 
-    void average_gradients(Gradients &g, const float batch_size) {
-        for (int i = 0; i < HIDDEN_SIZE; i++) {
-            for (int j = 0; j < INPUT_SIZE; j++) {
+    template <std::size_t IN, std::size_t HIDDEN, std::size_t OUT>
+    void average_gradients(BasicGradients<IN, HIDDEN, OUT> &g, const float batch_size) {
+        for (size_t i = 0; i < HIDDEN; i++) {
+            for (size_t j = 0; j < IN; j++) {
                 g.W1[i][j] /= batch_size;
             }
             g.b1[i] /= batch_size;
         }
-        for (int i = 0; i < OUTPUT_SIZE; i++) {
-            for (int j = 0; j < HIDDEN_SIZE; j++) {
+        for (size_t i = 0; i < OUT; i++) {
+            for (size_t j = 0; j < HIDDEN; j++) {
                 g.W2[i][j] /= batch_size;
             }
             g.b2[i] /= batch_size;
         }
     }
 
-    float average_cost(const NeuralNetwork &nn, const TrainingData &data) {
-        float total_cost = 0.0f;
-        for (size_t i = 0; i < data.input.size(); i++) {
-            std::array<float, OUTPUT_SIZE> y = {};
-            forward(nn, data.input[i], y);
-            float error;
-            cost(y, data.target[i], error);
-            total_cost += error;
+    template <std::size_t IN, std::size_t HIDDEN, std::size_t OUT>
+    void merge_gradients(BasicGradients<IN, HIDDEN, OUT> &total, const BasicGradients<IN, HIDDEN, OUT> &g) {
+        for (size_t i = 0; i < HIDDEN; i++) {
+            for (size_t j = 0; j < IN; j++) {
+                total.W1[i][j] += g.W1[i][j];
+            }
+            total.b1[i] += g.b1[i];
+        }
+        for (size_t i = 0; i < OUT; i++) {
+            for (size_t j = 0; j < HIDDEN; j++) {
+                total.W2[i][j] += g.W2[i][j];
+            }
+            total.b2[i] += g.b2[i];
         }
-        return total_cost / static_cast<float>(data.input.size());
     }
 
-    void separate_train_data(TrainingData &learn, TrainingData &test, float test_ratio) {
-        size_t total_size = learn.input.size();
-        size_t test_size = static_cast<size_t>(total_size * test_ratio);
-
-        test.input.insert(test.input.end(), learn.input.end() - test_size, learn.input.end());
-        test.target.insert(test.target.end(), learn.target.end() - test_size, learn.target.end());
-
-        learn.input.resize(total_size - test_size);
-        learn.target.resize(total_size - test_size);
+    template <std::size_t IN, std::size_t HIDDEN, std::size_t OUT>
+    float average_cost(const BasicNeuralNetwork<IN, HIDDEN, OUT> &nn, const BasicTrainingData<IN, OUT> &data) {
+        float total_cost = 0.0f;
+        for_each_forward(nn, data.input.size(),
+                         [&](size_t i) -> const std::array<float, IN> & { return data.input[i]; },
+                         [&](size_t i, const std::array<float, OUT> &y, const std::array<float, HIDDEN> &) {
+                             float error;
+                             cost(y, data.target[i], error);
+                             total_cost += error;
+                         });
+        return total_cost / static_cast<float>(data.input.size());
     }
 
     float activate(float x) {
         return std::tanh(x);
     }
 
-}
\ No newline at end of file
+    // ---- Explicit instantiations -----------------------------------------
+
+#define NODE_NN_INSTANTIATE(I, H, O)                                                                         \
+    template struct BasicParameters<I, H, O>;                                                                \
+    template struct BasicNeuralNetwork<I, H, O>;                                                             \
+    template struct BasicGradients<I, H, O>;                                                                 \
+    template struct BasicAdamM<I, H, O>;                                                                     \
+    template struct BasicAdamV<I, H, O>;                                                                     \
+    template struct BasicAdamState<I, H, O>;                                                                 \
+    template void forward(const BasicNeuralNetwork<I, H, O> &, const std::array<float, I> &,                 \
+                          std::array<float, O> &);                                                           \
+    template void forward(const BasicNeuralNetwork<I, H, O> &, const std::array<float, I> &,                 \
+                          std::array<float, O> &, std::array<float, H> &);                                   \
+    template void add_gradients(const BasicNeuralNetwork<I, H, O> &, const std::array<float, I> &,           \
+                                const std::array<float, O> &, BasicGradients<I, H, O> &);                    \
+    template void apply_gradients(BasicNeuralNetwork<I, H, O> &, const BasicGradients<I, H, O> &, float);    \
+    template void single_back_propagate(BasicNeuralNetwork<I, H, O> &, const std::array<float, I> &,         \
+                                        const std::array<float, O> &);                                       \
+    template void add_gradients(const BasicNeuralNetwork<I, H, O> &, const std::vector<std::array<float, I>> &,\
+                                const std::vector<std::array<float, O>> &, const std::vector<size_t> &,      \
+                                size_t, size_t, BasicGradients<I, H, O> &);                                  \
+    template void average_gradients(BasicGradients<I, H, O> &, float);                                       \
+    template void merge_gradients(BasicGradients<I, H, O> &, const BasicGradients<I, H, O> &);               \
+    template void back_propagate(BasicNeuralNetwork<I, H, O> &, const std::vector<std::array<float, I>> &,   \
+                                 const std::vector<std::array<float, O>> &);                                 \
+    template void back_propagate(BasicNeuralNetwork<I, H, O> &, const BasicTrainingData<I, O> &);            \
+    template void adam(BasicNeuralNetwork<I, H, O> &, const std::vector<std::array<float, I>> &,             \
+                       const std::vector<std::array<float, O>> &, BasicAdamState<I, H, O> &);                \
+    template void adam(BasicNeuralNetwork<I, H, O> &, const BasicTrainingData<I, O> &,                       \
+                       BasicAdamState<I, H, O> &);                                                           \
+    template void adam_step(BasicNeuralNetwork<I, H, O> &, const BasicGradients<I, H, O> &,                  \
+                            BasicAdamState<I, H, O> &, float);                                               \
+    template float average_cost(const BasicNeuralNetwork<I, H, O> &, const BasicTrainingData<I, O> &);
+
+    NODE_NN_TOPOLOGIES(NODE_NN_INSTANTIATE)
+
+#undef NODE_NN_INSTANTIATE
+
+}
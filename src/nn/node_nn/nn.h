@@ -1,9 +1,32 @@
 #pragma once
+#include <algorithm>
 #include <array>
+#include <cstddef>
 #include <vector>
 
+// Topologies built into the library (input, hidden, output): every template
+// below is explicitly instantiated for each line (nn.cpp, forward_batch.cpp),
+// and a model file may declare any of them (node_nn/model.h). Add a line to
+// support another; all keep the simulator's INPUT_SIZE inputs and
+// OUTPUT_SIZE outputs.
+#define NODE_NN_TOPOLOGIES(X) \
+    X(8, 8, 7)                \
+    X(8, 16, 7)               \
+    X(8, 32, 7)
+
+// Marks a loop with a compile-time trip count for full unrolling.
+#if defined(__clang__)
+#define NODE_NN_UNROLL _Pragma("unroll")
+#elif defined(__GNUC__)
+#define NODE_NN_UNROLL _Pragma("GCC unroll 64")
+#else
+#define NODE_NN_UNROLL
+#endif
+
 namespace node_nn {
 
+    // Default topology: the simulator's 8 sensor inputs and 7 vibe outputs,
+    // and the hidden layer of the shipped model.
     constexpr int INPUT_SIZE = 8;
     constexpr int HIDDEN_SIZE = 8;
     constexpr int OUTPUT_SIZE = 7;
@@ -14,79 +37,226 @@ namespace node_nn {
 
     constexpr float EPSILON = 1.0e-8;
 
-    struct Parameters {
-        std::array<std::array<float, INPUT_SIZE>, HIDDEN_SIZE> W1;
-        std::array<float, HIDDEN_SIZE> b1;
-        std::array<std::array<float, HIDDEN_SIZE>, OUTPUT_SIZE> W2;
-        std::array<float, OUTPUT_SIZE> b2;
+    struct Topology {
+        int input;
+        int hidden;
+        int output;
+
+        bool operator==(const Topology &other) const {
+            return input == other.input && hidden == other.hidden && output == other.output;
+        }
+        bool operator!=(const Topology &other) const { return !(*this == other); }
+    };
+
+    // Activation of both layers. TANH is std::tanh; FAST_TANH is fast_tanh()
+    // below, a bounded-error approximation that the batched kernels evaluate
+    // in vector registers.
+    enum class Activation { TANH, FAST_TANH };
+
+    template <std::size_t IN, std::size_t HIDDEN, std::size_t OUT>
+    struct BasicParameters {
+        static constexpr int INPUT_SIZE = static_cast<int>(IN);
+        static constexpr int HIDDEN_SIZE = static_cast<int>(HIDDEN);
+        static constexpr int OUTPUT_SIZE = static_cast<int>(OUT);
+        static constexpr Topology TOPOLOGY = {INPUT_SIZE, HIDDEN_SIZE, OUTPUT_SIZE};
+
+        std::array<std::array<float, IN>, HIDDEN> W1;
+        std::array<float, HIDDEN> b1;
+        std::array<std::array<float, HIDDEN>, OUT> W2;
+        std::array<float, OUT> b2;
 
         void set_zero();
         void randomize();
     };
 
-    struct NeuralNetwork : Parameters {
-        NeuralNetwork();
+    template <std::size_t IN, std::size_t HIDDEN, std::size_t OUT>
+    struct BasicNeuralNetwork : BasicParameters<IN, HIDDEN, OUT> {
+        Activation activation = Activation::TANH;  // not stored in model files
+
+        BasicNeuralNetwork();
     };
 
-    struct Gradients : Parameters {
-        Gradients();
+    template <std::size_t IN, std::size_t HIDDEN, std::size_t OUT>
+    struct BasicGradients : BasicParameters<IN, HIDDEN, OUT> {
+        BasicGradients();
     };
 
-    struct AdamM : Parameters {
-        AdamM();
+    template <std::size_t IN, std::size_t HIDDEN, std::size_t OUT>
+    struct BasicAdamM : BasicParameters<IN, HIDDEN, OUT> {
+        BasicAdamM();
     };
 
-    struct AdamV : Parameters {
-        AdamV();
+    template <std::size_t IN, std::size_t HIDDEN, std::size_t OUT>
+    struct BasicAdamV : BasicParameters<IN, HIDDEN, OUT> {
+        BasicAdamV();
     };
 
-    struct AdamState {
-        AdamM m;
-        AdamV v;
+    template <std::size_t IN, std::size_t HIDDEN, std::size_t OUT>
+    struct BasicAdamState {
+        BasicAdamM<IN, HIDDEN, OUT> m;
+        BasicAdamV<IN, HIDDEN, OUT> v;
         int t;
 
-        AdamState();
+        BasicAdamState();
     };
 
-    struct TrainingData {
-        std::vector<std::array<float, INPUT_SIZE>> input;
-        std::vector<std::array<float, OUTPUT_SIZE>> target;
+    template <std::size_t IN, std::size_t OUT>
+    struct BasicTrainingData {
+        std::vector<std::array<float, IN>> input;
+        std::vector<std::array<float, OUT>> target;
     };
 
+    using Parameters = BasicParameters<INPUT_SIZE, HIDDEN_SIZE, OUTPUT_SIZE>;
+    using NeuralNetwork = BasicNeuralNetwork<INPUT_SIZE, HIDDEN_SIZE, OUTPUT_SIZE>;
+    using Gradients = BasicGradients<INPUT_SIZE, HIDDEN_SIZE, OUTPUT_SIZE>;
+    using AdamM = BasicAdamM<INPUT_SIZE, HIDDEN_SIZE, OUTPUT_SIZE>;
+    using AdamV = BasicAdamV<INPUT_SIZE, HIDDEN_SIZE, OUTPUT_SIZE>;
+    using AdamState = BasicAdamState<INPUT_SIZE, HIDDEN_SIZE, OUTPUT_SIZE>;
+    using TrainingData = BasicTrainingData<INPUT_SIZE, OUTPUT_SIZE>;
+
     float activate(float x);
 
-    void forward(const NeuralNetwork &nn, const std::array<float, INPUT_SIZE> &x, std::array<float, OUTPUT_SIZE> &y);
+    // Largest |fast_tanh(x) - tanh(x)| over all finite floats (measured:
+    // 4.1e-7, at x ~ 5.83; std::tanh in float is off by up to 1.0e-7).
+    constexpr float FAST_TANH_MAX_ERROR = 4.2e-7f;
+
+    // tanh(x) as x * P(x^2) / Q(x^2), a 13 / 6 rational approximation, with
+    // the input clamped to +-7.9053 where it reaches +-1 in float. Branch-free
+    // and vectorisable; the AVX2 kernel evaluates the same sequence of
+    // multiplies and adds, so both give the same result.
+    inline float fast_tanh(float x) {
+        const float c = std::min(std::max(x, -7.90531110763549805f), 7.90531110763549805f);
+        const float x2 = c * c;
+        float p = -2.76076847742355e-16f;
+        p = p * x2 + 2.00018790482477e-13f;
+        p = p * x2 + -8.60467152213735e-11f;
+        p = p * x2 + 5.12229709037114e-08f;
+        p = p * x2 + 1.48572235717979e-05f;
+        p = p * x2 + 6.37261928875436e-04f;
+        p = p * x2 + 4.89352455891786e-03f;
+        p = p * c;
+        float q = 1.19825839466702e-06f;
+        q = q * x2 + 1.18534705686654e-04f;
+        q = q * x2 + 2.26843463243900e-03f;
+        q = q * x2 + 4.89352518554385e-03f;
+        return p / q;
+    }
+
+    inline float activate(float x, Activation activation) {
+        return activation == Activation::FAST_TANH ? fast_tanh(x) : activate(x);
+    }
+
+    // The functions below are templates over the layer sizes, defined and
+    // explicitly instantiated for NODE_NN_TOPOLOGIES in nn.cpp /
+    // forward_batch.cpp. Their loops have compile-time trip counts and are
+    // fully unrolled per topology; the sums run in the same order for every
+    // kernel.
+
+    template <std::size_t IN, std::size_t HIDDEN, std::size_t OUT>
+    void forward(const BasicNeuralNetwork<IN, HIDDEN, OUT> &nn, const std::array<float, IN> &x,
+                 std::array<float, OUT> &y);
+
+    template <std::size_t IN, std::size_t HIDDEN, std::size_t OUT>
+    void forward(const BasicNeuralNetwork<IN, HIDDEN, OUT> &nn, const std::array<float, IN> &x,
+                 std::array<float, OUT> &y, std::array<float, HIDDEN> &h);
+
+    // Forward pass over `count` samples stored per feature (structure of
+    // arrays): x[j * count + s] is input j of sample s, y[i * count + s]
+    // receives output i and, if given, h[i * count + s] hidden activation i.
+    // Each sample's result equals forward() bit for bit, with either
+    // activation. Uses the AVX2 kernel when the CPU supports it, otherwise
+    // the portable one (node_nn/forward_batch.cpp).
+    template <std::size_t IN, std::size_t HIDDEN, std::size_t OUT>
+    void forward_batch(const BasicNeuralNetwork<IN, HIDDEN, OUT> &nn, const float *x, float *y, int count,
+                       float *h = nullptr);
+
+    // The kernels behind forward_batch, exposed for benchmarks.
+    // forward_batch_avx2 falls back to the portable kernel on builds without
+    // AVX2 support and must not be called unless has_avx2().
+    bool has_avx2();
+    template <std::size_t IN, std::size_t HIDDEN, std::size_t OUT>
+    void forward_batch_portable(const BasicNeuralNetwork<IN, HIDDEN, OUT> &nn, const float *x, float *y,
+                                int count, float *h = nullptr);
+    template <std::size_t IN, std::size_t HIDDEN, std::size_t OUT>
+    void forward_batch_avx2(const BasicNeuralNetwork<IN, HIDDEN, OUT> &nn, const float *x, float *y,
+                            int count, float *h = nullptr);
+
+    // cost() and separate_train_data() depend only on the input / output
+    // sizes, which topologies share, so they are defined here.
+    template <std::size_t OUT>
+    void cost(const std::array<float, OUT> &y, const std::array<float, OUT> &target, float &error) {
+        error = 0.0f;
+        for (size_t i = 0; i < OUT; i++) {
+            error += (y[i] - target[i]) * (y[i] - target[i]);
+        }
+        error /= (OUT * 2);
+    }
+
+    template <std::size_t IN, std::size_t HIDDEN, std::size_t OUT>
+    void add_gradients(const BasicNeuralNetwork<IN, HIDDEN, OUT> &nn, const std::array<float, IN> &x,
+                       const std::array<float, OUT> &target, BasicGradients<IN, HIDDEN, OUT> &gradient);
+
+    // Adds the gradients of samples input[order[k]], k in [begin, end), to
+    // `gradient`, summed in that order: one shard of a shuffled mini-batch.
+    template <std::size_t IN, std::size_t HIDDEN, std::size_t OUT>
+    void add_gradients(const BasicNeuralNetwork<IN, HIDDEN, OUT> &nn,
+                       const std::vector<std::array<float, IN>> &input,
+                       const std::vector<std::array<float, OUT>> &target,
+                       const std::vector<std::size_t> &order, std::size_t begin, std::size_t end,
+                       BasicGradients<IN, HIDDEN, OUT> &gradient);
+
+    template <std::size_t IN, std::size_t HIDDEN, std::size_t OUT>
+    void merge_gradients(BasicGradients<IN, HIDDEN, OUT> &total, const BasicGradients<IN, HIDDEN, OUT> &g);
+
+    template <std::size_t IN, std::size_t HIDDEN, std::size_t OUT>
+    void apply_gradients(BasicNeuralNetwork<IN, HIDDEN, OUT> &nn, const BasicGradients<IN, HIDDEN, OUT> &gradient,
+                         float batch_size);
+
+    template <std::size_t IN, std::size_t HIDDEN, std::size_t OUT>
+    void single_back_propagate(BasicNeuralNetwork<IN, HIDDEN, OUT> &nn, const std::array<float, IN> &x,
+                               const std::array<float, OUT> &target);
+
+    template <std::size_t IN, std::size_t HIDDEN, std::size_t OUT>
+    void average_gradients(BasicGradients<IN, HIDDEN, OUT> &g, float batch_size);
 
-    void forward(const NeuralNetwork &nn, const std::array<float, INPUT_SIZE> &x, std::array<float, OUTPUT_SIZE> &y,
-                 std::array<float, HIDDEN_SIZE> &h);
+    template <std::size_t IN, std::size_t HIDDEN, std::size_t OUT>
+    void back_propagate(BasicNeuralNetwork<IN, HIDDEN, OUT> &nn,
+                        const std::vector<std::array<float, IN>> &input,
+                        const std::vector<std::array<float, OUT>> &target);
 
-    void cost(const std::array<float, OUTPUT_SIZE> &y, const std::array<float, OUTPUT_SIZE> &target, float &error);
+    template <std::size_t IN, std::size_t HIDDEN, std::size_t OUT>
+    void back_propagate(BasicNeuralNetwork<IN, HIDDEN, OUT> &nn, const BasicTrainingData<IN, OUT> &data);
 
-    void add_gradients(const NeuralNetwork &nn, const std::array<float, INPUT_SIZE> &x,
-                       const std::array<float, OUTPUT_SIZE> &target, Gradients &gradient);
+    template <std::size_t IN, std::size_t HIDDEN, std::size_t OUT>
+    void adam(BasicNeuralNetwork<IN, HIDDEN, OUT> &nn,
+              const std::vector<std::array<float, IN>> &input,
+              const std::vector<std::array<float, OUT>> &target,
+              BasicAdamState<IN, HIDDEN, OUT> &state);
 
-    void apply_gradients(NeuralNetwork &nn, const Gradients &gradient, float batch_size);
+    template <std::size_t IN, std::size_t HIDDEN, std::size_t OUT>
+    void adam(BasicNeuralNetwork<IN, HIDDEN, OUT> &nn,
+              const BasicTrainingData<IN, OUT> &data,
+              BasicAdamState<IN, HIDDEN, OUT> &state);
 
-    void single_back_propagate(NeuralNetwork &nn, const std::array<float, INPUT_SIZE> &x,
-                               const std::array<float, OUTPUT_SIZE> &target);
+    // One Adam update from the mean gradient of a batch; adam() is the full
+    // batch with LEARNING_RATE.
+    template <std::size_t IN, std::size_t HIDDEN, std::size_t OUT>
+    void adam_step(BasicNeuralNetwork<IN, HIDDEN, OUT> &nn, const BasicGradients<IN, HIDDEN, OUT> &gradient,
+                   BasicAdamState<IN, HIDDEN, OUT> &state, float learning_rate);
 
-    void average_gradients(Gradients &g, float batch_size);
+    template <std::size_t IN, std::size_t HIDDEN, std::size_t OUT>
+    float average_cost(const BasicNeuralNetwork<IN, HIDDEN, OUT> &nn, const BasicTrainingData<IN, OUT> &data);
 
-    void back_propagate(NeuralNetwork &nn, const std::array<float, INPUT_SIZE> &input, const std::array<float, OUTPUT_SIZE> &target);
+    template <std::size_t IN, std::size_t OUT>
+    void separate_train_data(BasicTrainingData<IN, OUT> &learn, BasicTrainingData<IN, OUT> &test, float test_ratio) {
+        size_t total_size = learn.input.size();
+        size_t test_size = static_cast<size_t>(total_size * test_ratio);
 
-    void back_propagate(NeuralNetwork &nn, const TrainingData &data);
+        test.input.insert(test.input.end(), learn.input.end() - test_size, learn.input.end());
+        test.target.insert(test.target.end(), learn.target.end() - test_size, learn.target.end());
 
-    void adam(NeuralNetwork &nn,
-              const std::vector<std::array<float, INPUT_SIZE>> &input,
-              const std::vector<std::array<float, OUTPUT_SIZE>> &target,
-              AdamState &state);
-    
-    void adam(NeuralNetwork &nn,
-              const TrainingData &data,
-              AdamState &state);
-    
-    float average_cost(const NeuralNetwork &nn, const TrainingData &data);
-    
-    void separate_train_data(TrainingData &learn, TrainingData &test, float test_ratio);
+        learn.input.resize(total_size - test_size);
+        learn.target.resize(total_size - test_size);
+    }
 
-}
\ No newline at end of file
+}
@@ -1,15 +1,25 @@
-#include "../nn.h"
+#include "io.h"
+#include <algorithm>
+#include <cstdint>
 #include <iostream>
 #include <fstream>
 #include <string>
+#include <type_traits>
 
 namespace node_nn {
 
-    bool save_model(const std::string &filename, const NeuralNetwork &nn) {
+    static constexpr char MODEL_MAGIC[4] = {'N', 'N', 'M', '1'};
+
+    static std::string model_path(const std::string &filename) {
         std::string full_path = filename;
         if (full_path.find('.') == std::string::npos) {
             full_path += ".nn";
         }
+        return full_path;
+    }
+
+    bool save_model(const std::string &filename, const Model &model) {
+        const std::string full_path = model_path(filename);
 
         std::ofstream ofs(full_path, std::ios::binary);
         if (!ofs) {
@@ -17,16 +27,21 @@ namespace node_nn {
             return false;
         }
 
-        ofs.write(reinterpret_cast<const char*>(&nn), sizeof(Parameters));
+        const Topology topology = model_topology(model);
+        const std::int32_t sizes[3] = {topology.input, topology.hidden, topology.output};
+        ofs.write(MODEL_MAGIC, sizeof(MODEL_MAGIC));
+        ofs.write(reinterpret_cast<const char*>(sizes), sizeof(sizes));
+        std::visit([&](const auto &nn) {
+            using Net = std::decay_t<decltype(nn)>;
+            using Params = BasicParameters<Net::INPUT_SIZE, Net::HIDDEN_SIZE, Net::OUTPUT_SIZE>;
+            ofs.write(reinterpret_cast<const char*>(&static_cast<const Params &>(nn)), sizeof(Params));
+        }, model);
 
         return ofs.good();
     }
 
-    bool load_model(const std::string &filename, NeuralNetwork &nn) {
-        std::string full_path = filename;
-        if (full_path.find('.') == std::string::npos) {
-            full_path += ".nn";
-        }
+    bool load_model(const std::string &filename, Model &model) {
+        const std::string full_path = model_path(filename);
 
         std::ifstream ifs(full_path, std::ios::binary);
         if (!ifs) {
@@ -35,15 +50,54 @@ namespace node_nn {
         }
 
         ifs.seekg(0, std::ios::end);
-        if (ifs.tellg() != sizeof(Parameters)) {
+        const std::streamoff file_size = ifs.tellg();
+        ifs.seekg(0, std::ios::beg);
+
+        constexpr std::streamoff header_size = sizeof(MODEL_MAGIC) + 3 * sizeof(std::int32_t);
+        char magic[sizeof(MODEL_MAGIC)] = {};
+        ifs.read(magic, sizeof(magic));
+        Topology topology = {INPUT_SIZE, HIDDEN_SIZE, OUTPUT_SIZE};
+        std::streamoff offset = 0;
+        if (ifs && std::equal(magic, magic + sizeof(magic), MODEL_MAGIC)) {
+            std::int32_t sizes[3] = {};
+            ifs.read(reinterpret_cast<char*>(sizes), sizeof(sizes));
+            topology = {sizes[0], sizes[1], sizes[2]};
+            offset = header_size;
+        } else if (file_size != static_cast<std::streamoff>(sizeof(Parameters))) {
             std::cerr << "Error: File size mismatch in " << full_path << std::endl;
             return false;
         }
-        ifs.seekg(0, std::ios::beg);
+        ifs.clear();
+
+        Model loaded;
+        if (!create_model(topology, loaded)) {
+            std::cerr << "Error: " << full_path << " declares an unsupported topology " << topology.input
+                      << "-" << topology.hidden << "-" << topology.output << std::endl;
+            return false;
+        }
 
-        ifs.read(reinterpret_cast<char*>(&nn), sizeof(Parameters));
+        bool ok = false;
+        std::visit([&](auto &nn) {
+            using Net = std::decay_t<decltype(nn)>;
+            using Params = BasicParameters<Net::INPUT_SIZE, Net::HIDDEN_SIZE, Net::OUTPUT_SIZE>;
+            if (file_size != offset + static_cast<std::streamoff>(sizeof(Params))) {
+                std::cerr << "Error: File size mismatch in " << full_path << std::endl;
+                return;
+            }
+            ifs.seekg(offset, std::ios::beg);
+            ifs.read(reinterpret_cast<char*>(&static_cast<Params &>(nn)), sizeof(Params));
+            ok = ifs.good();
+        }, loaded);
+        if (!ok) return false;
+
+        model = std::move(loaded);
+        return true;
+    }
 
-        return ifs.good();
+    void report_topology_mismatch(const std::string &filename, const Topology &expected, const Topology &found) {
+        std::cerr << "Error: " << model_path(filename) << " holds a " << found.input << "-" << found.hidden << "-"
+                  << found.output << " network, expected " << expected.input << "-" << expected.hidden << "-"
+                  << expected.output << std::endl;
     }
 
     bool load_training_data(const std::string &filename, TrainingData &data) {
@@ -1,14 +1,42 @@
 #pragma once
 
 #include "../nn.h"
+#include "../model.h"
 #include <string>
 
 namespace node_nn {
 
-    bool save_model(const std::string &filename, const NeuralNetwork &nn);
+    // Model files declare their topology: the magic "NNM1", the input, hidden
+    // and output sizes as int32, then W1, b1, W2 and b2 as float32. A file of
+    // exactly sizeof(Parameters) bytes without that header (the format from
+    // before topologies were selectable) loads as the default topology.
+    bool save_model(const std::string &filename, const Model &model);
 
-    bool load_model(const std::string &filename, NeuralNetwork &nn);
+    // Loads whichever built-in topology the file declares.
+    bool load_model(const std::string &filename, Model &model);
 
     bool load_training_data(const std::string &filename, TrainingData &data);
-    
-}
\ No newline at end of file
+
+    void report_topology_mismatch(const std::string &filename, const Topology &expected, const Topology &found);
+
+    template <std::size_t IN, std::size_t HIDDEN, std::size_t OUT>
+    bool save_model(const std::string &filename, const BasicNeuralNetwork<IN, HIDDEN, OUT> &nn) {
+        return save_model(filename, Model(nn));
+    }
+
+    // Loads the parameters of a model of this exact topology (nn.activation
+    // is kept); fails if the file declares another one.
+    template <std::size_t IN, std::size_t HIDDEN, std::size_t OUT>
+    bool load_model(const std::string &filename, BasicNeuralNetwork<IN, HIDDEN, OUT> &nn) {
+        Model model;
+        if (!load_model(filename, model)) return false;
+        const auto *loaded = std::get_if<BasicNeuralNetwork<IN, HIDDEN, OUT>>(&model);
+        if (!loaded) {
+            report_topology_mismatch(filename, nn.TOPOLOGY, model_topology(model));
+            return false;
+        }
+        static_cast<BasicParameters<IN, HIDDEN, OUT> &>(nn) = *loaded;
+        return true;
+    }
+
+}
@@ -7,78 +7,93 @@
 namespace sim {
 
 // ---------------------------------------------------------------------------
-// Global hyperparameter variables
+// Global configuration and compatibility aliases
 // ---------------------------------------------------------------------------
 
+SimConfig global_config;
+
 // Input computation
-float WALL_PRESSURE_COEFF = 10.0f;
-float CROWD_RADIUS        = 5.0f;
-float R_MIN               = 0.3f;
-bool  TARGET_USE_NEAREST_SOURCE = true;
-float TARGET_SOURCE_BLEND = 0.85f;
+float& WALL_PRESSURE_COEFF = global_config.WALL_PRESSURE_COEFF;
+float& CROWD_RADIUS        = global_config.CROWD_RADIUS;
+float& R_MIN               = global_config.R_MIN;
+bool&  TARGET_USE_NEAREST_SOURCE = global_config.TARGET_USE_NEAREST_SOURCE;
+float& TARGET_SOURCE_BLEND = global_config.TARGET_SOURCE_BLEND;
 
 // Output thresholds & multipliers
-float THRESHOLD_APOPTOSIS = 0.8f;
-float THRESHOLD_DEAD_EDGE = 0.1f;
-float PRUNE_EXPONENT      = 3.0f;
-float GROW_MULTIPLIER     = 1.5f;
+float& THRESHOLD_APOPTOSIS = global_config.THRESHOLD_APOPTOSIS;
+float& THRESHOLD_DEAD_EDGE = global_config.THRESHOLD_DEAD_EDGE;
+float& PRUNE_EXPONENT      = global_config.PRUNE_EXPONENT;
+float& GROW_MULTIPLIER     = global_config.GROW_MULTIPLIER;
 
 // Snap logic
-float SNAP_ANGLE_COS   = 0.866f;
-float THRESHOLD_SPROUT = 0.5f;
-float SNAP_RADIUS      = 3.0f;
-float INITIAL_WEIGHT   = 0.5f;
+float& SNAP_ANGLE_COS   = global_config.SNAP_ANGLE_COS;
+float& THRESHOLD_SPROUT = global_config.THRESHOLD_SPROUT;
+float& SNAP_RADIUS      = global_config.SNAP_RADIUS;
+float& INITIAL_WEIGHT   = global_config.INITIAL_WEIGHT;
 
 // Shift logic
-float SHIFT_RATE             = 0.5f;
-float WALL_AVOIDANCE_STRENGTH = 0.3f;
-float WALL_STUCK_THRESHOLD    = 0.6f;
-float WALL_UNSTUCK_FORCE      = 0.8f;
+float& SHIFT_RATE             = global_config.SHIFT_RATE;
+float& WALL_AVOIDANCE_STRENGTH = global_config.WALL_AVOIDANCE_STRENGTH;
+float& WALL_STUCK_THRESHOLD    = global_config.WALL_STUCK_THRESHOLD;
+float& WALL_UNSTUCK_FORCE      = global_config.WALL_UNSTUCK_FORCE;
 
 // Input/Output limits
-float INPUT_CLAMP = 5.0f;
+float& INPUT_CLAMP = global_config.INPUT_CLAMP;
 
 // Raycast & collision detection
-float WALL_SAFETY_MARGIN = 0.05f;
-float RAYCAST_STEP       = 0.05f;
-float EDGE_CHECK_STEP    = 0.1f;
-float MIN_SPROUT_DISTANCE = 0.05f;
+float& WALL_SAFETY_MARGIN = global_config.WALL_SAFETY_MARGIN;
+float& RAYCAST_STEP       = global_config.RAYCAST_STEP;
+float& EDGE_CHECK_STEP    = global_config.EDGE_CHECK_STEP;
+float& MIN_SPROUT_DISTANCE = global_config.MIN_SPROUT_DISTANCE;
+bool&  RAYCAST_EXACT      = global_config.RAYCAST_EXACT;
 
 // Debug flags
-bool DEBUG_GROW  = false;
-bool DEBUG_SHIFT = false;
+bool& DEBUG_GROW  = global_config.DEBUG_GROW;
+bool& DEBUG_SHIFT = global_config.DEBUG_SHIFT;
 
 // Energy dynamics
-float ENERGY_SOURCE_VALUE    = 100.0f;
-float ENERGY_MAINTENANCE_COST = 1.0f;
-float ENERGY_MAINTENANCE_PER_WEIGHT = 0.02f;
-float ENERGY_DIFFUSION_ALPHA  = 0.05f;
-float ENERGY_FLOW_GAIN        = 1.0f;
-bool  ENERGY_FLOW_NORMALIZE_BY_DEGREE = true;
-bool  ENERGY_PULSE_ENABLE     = false;
-float ENERGY_PULSE_PERIOD_STEPS = 50.0f;
-float ENERGY_PULSE_LOW_RATIO  = 0.35f;
-float ENERGY_PULSE_SINK_VALUE = 0.0f;
-float EDGE_WEIGHT_MAX         = 80.0f;
-float ENERGY_INITIAL          = 20.0f;
-bool  ENERGY_USE_AS_IMPORTANCE = true;
-float ENERGY_IMPORTANCE_SCALE  = 0.05f;
-float ENERGY_DEATH_PATIENCE    = 6.0f;
-float ENERGY_COST_EDGE_THICKEN = 0.8f;
-float ENERGY_COST_NEW_CONNECTION = 1.5f;
-float ENERGY_COST_SPROUT = 8.0f;
-float ENERGY_CHILD_INITIAL = 6.0f;
-float ENERGY_MIN_CLAMP = -50.0f;
-float ENERGY_MAX_CLAMP = 200.0f;
-
-float APOPTOSIS_WARMUP_STEPS   = 20.0f;
-float NN_APOPTOSIS_ENERGY_GATE = 0.45f;
-
-float FUSION_DISTANCE            = 0.75f;
-float FUSION_MAX_MERGES_PER_STEP = 8.0f;
-float FUSION_MIN_RETAIN_RATIO    = 0.90f;
-
-bool ENABLE_BACKBONE_PROTECTION = false;
+float& ENERGY_SOURCE_VALUE    = global_config.ENERGY_SOURCE_VALUE;
+float& ENERGY_MAINTENANCE_COST = global_config.ENERGY_MAINTENANCE_COST;
+float& ENERGY_MAINTENANCE_PER_WEIGHT = global_config.ENERGY_MAINTENANCE_PER_WEIGHT;
+float& ENERGY_DIFFUSION_ALPHA  = global_config.ENERGY_DIFFUSION_ALPHA;
+float& ENERGY_FLOW_GAIN        = global_config.ENERGY_FLOW_GAIN;
+bool&  ENERGY_FLOW_NORMALIZE_BY_DEGREE = global_config.ENERGY_FLOW_NORMALIZE_BY_DEGREE;
+bool&  ENERGY_PULSE_ENABLE     = global_config.ENERGY_PULSE_ENABLE;
+float& ENERGY_PULSE_PERIOD_STEPS = global_config.ENERGY_PULSE_PERIOD_STEPS;
+float& ENERGY_PULSE_LOW_RATIO  = global_config.ENERGY_PULSE_LOW_RATIO;
+float& ENERGY_PULSE_SINK_VALUE = global_config.ENERGY_PULSE_SINK_VALUE;
+float& EDGE_WEIGHT_MAX         = global_config.EDGE_WEIGHT_MAX;
+float& ENERGY_INITIAL          = global_config.ENERGY_INITIAL;
+bool&  ENERGY_USE_AS_IMPORTANCE = global_config.ENERGY_USE_AS_IMPORTANCE;
+float& ENERGY_IMPORTANCE_SCALE  = global_config.ENERGY_IMPORTANCE_SCALE;
+float& ENERGY_DEATH_PATIENCE    = global_config.ENERGY_DEATH_PATIENCE;
+float& ENERGY_COST_EDGE_THICKEN = global_config.ENERGY_COST_EDGE_THICKEN;
+float& ENERGY_COST_NEW_CONNECTION = global_config.ENERGY_COST_NEW_CONNECTION;
+float& ENERGY_COST_SPROUT = global_config.ENERGY_COST_SPROUT;
+float& ENERGY_CHILD_INITIAL = global_config.ENERGY_CHILD_INITIAL;
+float& ENERGY_MIN_CLAMP = global_config.ENERGY_MIN_CLAMP;
+float& ENERGY_MAX_CLAMP = global_config.ENERGY_MAX_CLAMP;
+
+float& APOPTOSIS_WARMUP_STEPS   = global_config.APOPTOSIS_WARMUP_STEPS;
+float& NN_APOPTOSIS_ENERGY_GATE = global_config.NN_APOPTOSIS_ENERGY_GATE;
+
+float& FUSION_DISTANCE            = global_config.FUSION_DISTANCE;
+float& FUSION_MAX_MERGES_PER_STEP = global_config.FUSION_MAX_MERGES_PER_STEP;
+float& FUSION_MIN_RETAIN_RATIO    = global_config.FUSION_MIN_RETAIN_RATIO;
+
+bool& ENABLE_BACKBONE_PROTECTION = global_config.ENABLE_BACKBONE_PROTECTION;
+
+bool&  USE_SPATIAL_INDEX     = global_config.USE_SPATIAL_INDEX;
+bool&  WALL_FIELD_ENABLE     = global_config.WALL_FIELD_ENABLE;
+float& WALL_FIELD_RESOLUTION = global_config.WALL_FIELD_RESOLUTION;
+bool&  WALL_FIELD_VALIDATE   = global_config.WALL_FIELD_VALIDATE;
+bool&  USE_LOS_CACHE         = global_config.USE_LOS_CACHE;
+bool&  ENERGY_PARALLEL_KERNEL = global_config.ENERGY_PARALLEL_KERNEL;
+bool&  NODE_FREE_LIST        = global_config.NODE_FREE_LIST;
+float& NODE_DEFRAG_FREE_FRACTION = global_config.NODE_DEFRAG_FREE_FRACTION;
+bool&  STEP_SYNC_UPDATE      = global_config.STEP_SYNC_UPDATE;
+float& STEP_THREADS          = global_config.STEP_THREADS;
+bool&  NN_FAST_TANH          = global_config.NN_FAST_TANH;
 
 // ---------------------------------------------------------------------------
 // Helper functions
@@ -112,76 +127,189 @@ static bool parse_line(const std::string& line, std::string& key, float& value)
     }
 }
 
+// ---------------------------------------------------------------------------
+// Key lookup
+// ---------------------------------------------------------------------------
+
+// Config file key -> SimConfig member. Bools are stored as value > 0.5.
+struct ConfigKey {
+    const char*         key;
+    float SimConfig::*  float_member;
+    bool  SimConfig::*  bool_member;
+};
+
+static const ConfigKey CONFIG_KEYS[] = {
+    {"WALL_PRESSURE_COEFF",             &SimConfig::WALL_PRESSURE_COEFF, nullptr},
+    {"CROWD_RADIUS",                    &SimConfig::CROWD_RADIUS, nullptr},
+    {"R_MIN",                           &SimConfig::R_MIN, nullptr},
+    {"TARGET_USE_NEAREST_SOURCE",       nullptr, &SimConfig::TARGET_USE_NEAREST_SOURCE},
+    {"TARGET_SOURCE_BLEND",             &SimConfig::TARGET_SOURCE_BLEND, nullptr},
+    {"THRESHOLD_APOPTOSIS",             &SimConfig::THRESHOLD_APOPTOSIS, nullptr},
+    {"THRESHOLD_DEAD_EDGE",             &SimConfig::THRESHOLD_DEAD_EDGE, nullptr},
+    {"PRUNE_EXPONENT",                  &SimConfig::PRUNE_EXPONENT, nullptr},
+    {"GROW_MULTIPLIER",                 &SimConfig::GROW_MULTIPLIER, nullptr},
+    {"SNAP_ANGLE_COS",                  &SimConfig::SNAP_ANGLE_COS, nullptr},
+    {"THRESHOLD_SPROUT",                &SimConfig::THRESHOLD_SPROUT, nullptr},
+    {"SNAP_RADIUS",                     &SimConfig::SNAP_RADIUS, nullptr},
+    {"INITIAL_WEIGHT",                  &SimConfig::INITIAL_WEIGHT, nullptr},
+    {"SHIFT_RATE",                      &SimConfig::SHIFT_RATE, nullptr},
+    {"WALL_AVOIDANCE_STRENGTH",         &SimConfig::WALL_AVOIDANCE_STRENGTH, nullptr},
+    {"WALL_STUCK_THRESHOLD",            &SimConfig::WALL_STUCK_THRESHOLD, nullptr},
+    {"WALL_UNSTUCK_FORCE",              &SimConfig::WALL_UNSTUCK_FORCE, nullptr},
+    {"INPUT_CLAMP",                     &SimConfig::INPUT_CLAMP, nullptr},
+    {"WALL_SAFETY_MARGIN",              &SimConfig::WALL_SAFETY_MARGIN, nullptr},
+    {"RAYCAST_STEP",                    &SimConfig::RAYCAST_STEP, nullptr},
+    {"MIN_SPROUT_DISTANCE",             &SimConfig::MIN_SPROUT_DISTANCE, nullptr},
+    {"EDGE_CHECK_STEP",                 &SimConfig::EDGE_CHECK_STEP, nullptr},
+    {"RAYCAST_EXACT",                   nullptr, &SimConfig::RAYCAST_EXACT},
+    {"DEBUG_GROW",                      nullptr, &SimConfig::DEBUG_GROW},
+    {"DEBUG_SHIFT",                     nullptr, &SimConfig::DEBUG_SHIFT},
+    {"ENERGY_SOURCE_VALUE",             &SimConfig::ENERGY_SOURCE_VALUE, nullptr},
+    {"ENERGY_MAINTENANCE_COST",         &SimConfig::ENERGY_MAINTENANCE_COST, nullptr},
+    {"ENERGY_MAINTENANCE_PER_WEIGHT",   &SimConfig::ENERGY_MAINTENANCE_PER_WEIGHT, nullptr},
+    {"ENERGY_DIFFUSION_ALPHA",          &SimConfig::ENERGY_DIFFUSION_ALPHA, nullptr},
+    {"ENERGY_FLOW_GAIN",                &SimConfig::ENERGY_FLOW_GAIN, nullptr},
+    {"ENERGY_FLOW_NORMALIZE_BY_DEGREE", nullptr, &SimConfig::ENERGY_FLOW_NORMALIZE_BY_DEGREE},
+    {"ENERGY_PULSE_ENABLE",             nullptr, &SimConfig::ENERGY_PULSE_ENABLE},
+    {"ENERGY_PULSE_PERIOD_STEPS",       &SimConfig::ENERGY_PULSE_PERIOD_STEPS, nullptr},
+    {"ENERGY_PULSE_LOW_RATIO",          &SimConfig::ENERGY_PULSE_LOW_RATIO, nullptr},
+    {"ENERGY_PULSE_SINK_VALUE",         &SimConfig::ENERGY_PULSE_SINK_VALUE, nullptr},
+    {"EDGE_WEIGHT_MAX",                 &SimConfig::EDGE_WEIGHT_MAX, nullptr},
+    {"ENERGY_INITIAL",                  &SimConfig::ENERGY_INITIAL, nullptr},
+    {"ENERGY_USE_AS_IMPORTANCE",        nullptr, &SimConfig::ENERGY_USE_AS_IMPORTANCE},
+    {"ENERGY_IMPORTANCE_SCALE",         &SimConfig::ENERGY_IMPORTANCE_SCALE, nullptr},
+    {"ENERGY_DEATH_PATIENCE",           &SimConfig::ENERGY_DEATH_PATIENCE, nullptr},
+    {"ENERGY_COST_EDGE_THICKEN",        &SimConfig::ENERGY_COST_EDGE_THICKEN, nullptr},
+    {"ENERGY_COST_NEW_CONNECTION",      &SimConfig::ENERGY_COST_NEW_CONNECTION, nullptr},
+    {"ENERGY_COST_SPROUT",              &SimConfig::ENERGY_COST_SPROUT, nullptr},
+    {"ENERGY_CHILD_INITIAL",            &SimConfig::ENERGY_CHILD_INITIAL, nullptr},
+    {"ENERGY_MIN_CLAMP",                &SimConfig::ENERGY_MIN_CLAMP, nullptr},
+    {"ENERGY_MAX_CLAMP",                &SimConfig::ENERGY_MAX_CLAMP, nullptr},
+    {"APOPTOSIS_WARMUP_STEPS",          &SimConfig::APOPTOSIS_WARMUP_STEPS, nullptr},
+    {"NN_APOPTOSIS_ENERGY_GATE",        &SimConfig::NN_APOPTOSIS_ENERGY_GATE, nullptr},
+    {"FUSION_DISTANCE",                 &SimConfig::FUSION_DISTANCE, nullptr},
+    {"FUSION_MAX_MERGES_PER_STEP",      &SimConfig::FUSION_MAX_MERGES_PER_STEP, nullptr},
+    {"FUSION_MIN_RETAIN_RATIO",         &SimConfig::FUSION_MIN_RETAIN_RATIO, nullptr},
+    {"ENABLE_BACKBONE_PROTECTION",      nullptr, &SimConfig::ENABLE_BACKBONE_PROTECTION},
+    {"USE_SPATIAL_INDEX",               nullptr, &SimConfig::USE_SPATIAL_INDEX},
+    {"WALL_FIELD_ENABLE",               nullptr, &SimConfig::WALL_FIELD_ENABLE},
+    {"WALL_FIELD_RESOLUTION",           &SimConfig::WALL_FIELD_RESOLUTION, nullptr},
+    {"WALL_FIELD_VALIDATE",             nullptr, &SimConfig::WALL_FIELD_VALIDATE},
+    {"USE_LOS_CACHE",                   nullptr, &SimConfig::USE_LOS_CACHE},
+    {"ENERGY_PARALLEL_KERNEL",          nullptr, &SimConfig::ENERGY_PARALLEL_KERNEL},
+    {"NODE_FREE_LIST",                  nullptr, &SimConfig::NODE_FREE_LIST},
+    {"NODE_DEFRAG_FREE_FRACTION",       &SimConfig::NODE_DEFRAG_FREE_FRACTION, nullptr},
+    {"STEP_SYNC_UPDATE",                nullptr, &SimConfig::STEP_SYNC_UPDATE},
+    {"STEP_THREADS",                    &SimConfig::STEP_THREADS, nullptr},
+    {"NN_FAST_TANH",                    nullptr, &SimConfig::NN_FAST_TANH},
+};
+
+static const ConfigKey* find_config_key(const std::string& key) {
+    for (const ConfigKey& entry : CONFIG_KEYS) {
+        if (key == entry.key) return &entry;
+    }
+    return nullptr;
+}
+
+bool set_config_value(SimConfig& config, const std::string& key, float value) {
+    const ConfigKey* entry = find_config_key(key);
+    if (!entry) return false;
+    if (entry->float_member) config.*entry->float_member = value;
+    else                     config.*entry->bool_member = (value > 0.5f);
+    return true;
+}
+
+bool get_config_value(const SimConfig& config, const std::string& key, float& value) {
+    const ConfigKey* entry = find_config_key(key);
+    if (!entry) return false;
+    value = entry->float_member ? config.*entry->float_member
+                                : (config.*entry->bool_member ? 1.0f : 0.0f);
+    return true;
+}
+
 // ---------------------------------------------------------------------------
 // Configuration loader
 // ---------------------------------------------------------------------------
 
-void set_default_config() {
-    WALL_PRESSURE_COEFF = 10.0f;
-    CROWD_RADIUS        = 5.0f;
-    R_MIN               = 0.3f;
-    TARGET_USE_NEAREST_SOURCE = true;
-    TARGET_SOURCE_BLEND = 0.85f;
+void set_default_config(SimConfig& config) {
+    config.WALL_PRESSURE_COEFF = 10.0f;
+    config.CROWD_RADIUS        = 5.0f;
+    config.R_MIN               = 0.3f;
+    config.TARGET_USE_NEAREST_SOURCE = true;
+    config.TARGET_SOURCE_BLEND = 0.85f;
     
-    THRESHOLD_APOPTOSIS = 0.8f;
-    THRESHOLD_DEAD_EDGE = 0.1f;
-    PRUNE_EXPONENT      = 3.0f;
-    GROW_MULTIPLIER     = 1.5f;
+    config.THRESHOLD_APOPTOSIS = 0.8f;
+    config.THRESHOLD_DEAD_EDGE = 0.1f;
+    config.PRUNE_EXPONENT      = 3.0f;
+    config.GROW_MULTIPLIER     = 1.5f;
     
-    SNAP_ANGLE_COS   = 0.866f;
-    THRESHOLD_SPROUT = 0.5f;
-    SNAP_RADIUS      = 3.0f;
-    INITIAL_WEIGHT   = 0.5f;
+    config.SNAP_ANGLE_COS   = 0.866f;
+    config.THRESHOLD_SPROUT = 0.5f;
+    config.SNAP_RADIUS      = 3.0f;
+    config.INITIAL_WEIGHT   = 0.5f;
     
-    SHIFT_RATE             = 0.5f;
-    WALL_AVOIDANCE_STRENGTH = 0.3f;
-    WALL_STUCK_THRESHOLD    = 0.6f;
-    WALL_UNSTUCK_FORCE      = 0.8f;
+    config.SHIFT_RATE             = 0.5f;
+    config.WALL_AVOIDANCE_STRENGTH = 0.3f;
+    config.WALL_STUCK_THRESHOLD    = 0.6f;
+    config.WALL_UNSTUCK_FORCE      = 0.8f;
     
-    INPUT_CLAMP = 5.0f;
+    config.INPUT_CLAMP = 5.0f;
     
-    WALL_SAFETY_MARGIN = 0.05f;
-    RAYCAST_STEP       = 0.05f;
-    EDGE_CHECK_STEP    = 0.1f;
-    MIN_SPROUT_DISTANCE = 0.05f;
-
-    ENERGY_SOURCE_VALUE     = 100.0f;
-    ENERGY_MAINTENANCE_COST = 0.6f;
-    ENERGY_MAINTENANCE_PER_WEIGHT = 0.02f;
-    ENERGY_DIFFUSION_ALPHA  = 0.15f;
-    ENERGY_FLOW_GAIN        = 1.0f;
-    ENERGY_FLOW_NORMALIZE_BY_DEGREE = true;
-    ENERGY_PULSE_ENABLE     = false;
-    ENERGY_PULSE_PERIOD_STEPS = 50.0f;
-    ENERGY_PULSE_LOW_RATIO  = 0.35f;
-    ENERGY_PULSE_SINK_VALUE = 0.0f;
-    EDGE_WEIGHT_MAX         = 80.0f;
-    ENERGY_INITIAL          = 40.0f;
-    ENERGY_USE_AS_IMPORTANCE = true;
-    ENERGY_IMPORTANCE_SCALE  = 0.05f;
-    ENERGY_DEATH_PATIENCE    = 6.0f;
-    ENERGY_COST_EDGE_THICKEN = 0.8f;
-    ENERGY_COST_NEW_CONNECTION = 1.5f;
-    ENERGY_COST_SPROUT = 8.0f;
-    ENERGY_CHILD_INITIAL = 6.0f;
-    ENERGY_MIN_CLAMP = -50.0f;
-    ENERGY_MAX_CLAMP = 200.0f;
-
-    APOPTOSIS_WARMUP_STEPS   = 20.0f;
-    NN_APOPTOSIS_ENERGY_GATE = 0.45f;
-
-    FUSION_DISTANCE            = 0.75f;
-    FUSION_MAX_MERGES_PER_STEP = 8.0f;
-    FUSION_MIN_RETAIN_RATIO    = 0.90f;
-
-    ENABLE_BACKBONE_PROTECTION = false;
+    config.WALL_SAFETY_MARGIN = 0.05f;
+    config.RAYCAST_STEP       = 0.05f;
+    config.EDGE_CHECK_STEP    = 0.1f;
+    config.MIN_SPROUT_DISTANCE = 0.05f;
+    config.RAYCAST_EXACT      = false;
+
+    config.ENERGY_SOURCE_VALUE     = 100.0f;
+    config.ENERGY_MAINTENANCE_COST = 0.6f;
+    config.ENERGY_MAINTENANCE_PER_WEIGHT = 0.02f;
+    config.ENERGY_DIFFUSION_ALPHA  = 0.15f;
+    config.ENERGY_FLOW_GAIN        = 1.0f;
+    config.ENERGY_FLOW_NORMALIZE_BY_DEGREE = true;
+    config.ENERGY_PULSE_ENABLE     = false;
+    config.ENERGY_PULSE_PERIOD_STEPS = 50.0f;
+    config.ENERGY_PULSE_LOW_RATIO  = 0.35f;
+    config.ENERGY_PULSE_SINK_VALUE = 0.0f;
+    config.EDGE_WEIGHT_MAX         = 80.0f;
+    config.ENERGY_INITIAL          = 40.0f;
+    config.ENERGY_USE_AS_IMPORTANCE = true;
+    config.ENERGY_IMPORTANCE_SCALE  = 0.05f;
+    config.ENERGY_DEATH_PATIENCE    = 6.0f;
+    config.ENERGY_COST_EDGE_THICKEN = 0.8f;
+    config.ENERGY_COST_NEW_CONNECTION = 1.5f;
+    config.ENERGY_COST_SPROUT = 8.0f;
+    config.ENERGY_CHILD_INITIAL = 6.0f;
+    config.ENERGY_MIN_CLAMP = -50.0f;
+    config.ENERGY_MAX_CLAMP = 200.0f;
+
+    config.APOPTOSIS_WARMUP_STEPS   = 20.0f;
+    config.NN_APOPTOSIS_ENERGY_GATE = 0.45f;
+
+    config.FUSION_DISTANCE            = 0.75f;
+    config.FUSION_MAX_MERGES_PER_STEP = 8.0f;
+    config.FUSION_MIN_RETAIN_RATIO    = 0.90f;
+
+    config.ENABLE_BACKBONE_PROTECTION = false;
+
+    config.USE_SPATIAL_INDEX     = true;
+    config.WALL_FIELD_ENABLE     = true;
+    config.WALL_FIELD_RESOLUTION = 4.0f;
+    config.WALL_FIELD_VALIDATE   = false;
+    config.USE_LOS_CACHE         = true;
+    config.ENERGY_PARALLEL_KERNEL = false;
+    config.NODE_FREE_LIST        = false;
+    config.NODE_DEFRAG_FREE_FRACTION = 0.5f;
+    config.STEP_SYNC_UPDATE      = false;
+    config.STEP_THREADS          = 1.0f;
+    config.NN_FAST_TANH          = false;
 }
 
-bool load_config(const std::string& filepath) {
+bool load_config(const std::string& filepath, SimConfig& config) {
     std::ifstream ifs(filepath);
     if (!ifs) {
         // Don't print error here - let caller handle it
-        set_default_config();
+        set_default_config(config);
         return false;
     }
     
@@ -198,69 +326,12 @@ bool load_config(const std::string& filepath) {
         
         if (!parse_line(line, key, value)) continue;
         
-        // Match key to variable
-        bool recognized = true;
-        
-        if      (key == "WALL_PRESSURE_COEFF")     WALL_PRESSURE_COEFF = value;
-        else if (key == "CROWD_RADIUS")            CROWD_RADIUS = value;
-        else if (key == "R_MIN")                   R_MIN = value;
-        else if (key == "TARGET_USE_NEAREST_SOURCE") TARGET_USE_NEAREST_SOURCE = (value > 0.5f);
-        else if (key == "TARGET_SOURCE_BLEND")     TARGET_SOURCE_BLEND = value;
-        else if (key == "THRESHOLD_APOPTOSIS")     THRESHOLD_APOPTOSIS = value;
-        else if (key == "THRESHOLD_DEAD_EDGE")     THRESHOLD_DEAD_EDGE = value;
-        else if (key == "PRUNE_EXPONENT")          PRUNE_EXPONENT = value;
-        else if (key == "GROW_MULTIPLIER")         GROW_MULTIPLIER = value;
-        else if (key == "SNAP_ANGLE_COS")          SNAP_ANGLE_COS = value;
-        else if (key == "THRESHOLD_SPROUT")        THRESHOLD_SPROUT = value;
-        else if (key == "SNAP_RADIUS")             SNAP_RADIUS = value;
-        else if (key == "INITIAL_WEIGHT")          INITIAL_WEIGHT = value;
-        else if (key == "SHIFT_RATE")              SHIFT_RATE = value;
-        else if (key == "WALL_AVOIDANCE_STRENGTH") WALL_AVOIDANCE_STRENGTH = value;
-        else if (key == "WALL_STUCK_THRESHOLD")    WALL_STUCK_THRESHOLD = value;
-        else if (key == "WALL_UNSTUCK_FORCE")      WALL_UNSTUCK_FORCE = value;
-        else if (key == "INPUT_CLAMP")             INPUT_CLAMP = value;
-        else if (key == "WALL_SAFETY_MARGIN")      WALL_SAFETY_MARGIN = value;
-        else if (key == "RAYCAST_STEP")            RAYCAST_STEP = value;
-        else if (key == "MIN_SPROUT_DISTANCE")     MIN_SPROUT_DISTANCE = value;
-        else if (key == "EDGE_CHECK_STEP")         EDGE_CHECK_STEP = value;
-        else if (key == "DEBUG_GROW")              DEBUG_GROW = (value > 0.5f);
-        else if (key == "DEBUG_SHIFT")             DEBUG_SHIFT = (value > 0.5f);
-        else if (key == "ENERGY_SOURCE_VALUE")     ENERGY_SOURCE_VALUE = value;
-        else if (key == "ENERGY_MAINTENANCE_COST") ENERGY_MAINTENANCE_COST = value;
-        else if (key == "ENERGY_MAINTENANCE_PER_WEIGHT") ENERGY_MAINTENANCE_PER_WEIGHT = value;
-        else if (key == "ENERGY_DIFFUSION_ALPHA")  ENERGY_DIFFUSION_ALPHA = value;
-        else if (key == "ENERGY_FLOW_GAIN")        ENERGY_FLOW_GAIN = value;
-        else if (key == "ENERGY_FLOW_NORMALIZE_BY_DEGREE") ENERGY_FLOW_NORMALIZE_BY_DEGREE = (value > 0.5f);
-        else if (key == "ENERGY_PULSE_ENABLE")     ENERGY_PULSE_ENABLE = (value > 0.5f);
-        else if (key == "ENERGY_PULSE_PERIOD_STEPS") ENERGY_PULSE_PERIOD_STEPS = value;
-        else if (key == "ENERGY_PULSE_LOW_RATIO")  ENERGY_PULSE_LOW_RATIO = value;
-        else if (key == "ENERGY_PULSE_SINK_VALUE") ENERGY_PULSE_SINK_VALUE = value;
-        else if (key == "EDGE_WEIGHT_MAX")         EDGE_WEIGHT_MAX = value;
-        else if (key == "ENERGY_INITIAL")          ENERGY_INITIAL = value;
-        else if (key == "ENERGY_USE_AS_IMPORTANCE") ENERGY_USE_AS_IMPORTANCE = (value > 0.5f);
-        else if (key == "ENERGY_IMPORTANCE_SCALE")  ENERGY_IMPORTANCE_SCALE = value;
-        else if (key == "ENERGY_DEATH_PATIENCE")    ENERGY_DEATH_PATIENCE = value;
-        else if (key == "ENERGY_COST_EDGE_THICKEN") ENERGY_COST_EDGE_THICKEN = value;
-        else if (key == "ENERGY_COST_NEW_CONNECTION") ENERGY_COST_NEW_CONNECTION = value;
-        else if (key == "ENERGY_COST_SPROUT")       ENERGY_COST_SPROUT = value;
-        else if (key == "ENERGY_CHILD_INITIAL")     ENERGY_CHILD_INITIAL = value;
-        else if (key == "ENERGY_MIN_CLAMP")         ENERGY_MIN_CLAMP = value;
-        else if (key == "ENERGY_MAX_CLAMP")         ENERGY_MAX_CLAMP = value;
-        else if (key == "APOPTOSIS_WARMUP_STEPS")   APOPTOSIS_WARMUP_STEPS = value;
-        else if (key == "NN_APOPTOSIS_ENERGY_GATE") NN_APOPTOSIS_ENERGY_GATE = value;
-        else if (key == "FUSION_DISTANCE")          FUSION_DISTANCE = value;
-        else if (key == "FUSION_MAX_MERGES_PER_STEP") FUSION_MAX_MERGES_PER_STEP = value;
-        else if (key == "FUSION_MIN_RETAIN_RATIO")  FUSION_MIN_RETAIN_RATIO = value;
-        else if (key == "ENABLE_BACKBONE_PROTECTION") ENABLE_BACKBONE_PROTECTION = (value > 0.5f);
-        else {
-            std::cerr << "[config] Warning: unknown parameter '" 
-                      << key << "' at line " << line_num << "\n";
-            recognized = false;
-        }
-        
-        if (recognized) {
+        if (set_config_value(config, key, value)) {
             ++loaded;
             std::cout << "[config]   " << key << " = " << value << "\n";
+        } else {
+            std::cerr << "[config] Warning: unknown parameter '" 
+                      << key << "' at line " << line_num << "\n";
         }
     }
     
@@ -269,4 +340,12 @@ bool load_config(const std::string& filepath) {
     return true;
 }
 
+void set_default_config() {
+    set_default_config(global_config);
+}
+
+bool load_config(const std::string& filepath) {
+    return load_config(filepath, global_config);
+}
+
 } // namespace sim
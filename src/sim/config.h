@@ -6,91 +6,223 @@ namespace sim {
 
 // ---------------------------------------------------------------------------
 // Hyperparameters (loaded from external file)
+//
+// SimConfig holds one complete set of hyperparameters; member names match the
+// keys of the config file. step(), compute_inputs(), apply_vibe(),
+// cleanup_dead() and the energy kernels read only the SimConfig passed to
+// them, so threads may simulate different configurations at the same time.
+//
+//   SimConfig config;
+//   load_config("hyperparameters.txt", config);
+//   step(graph, nn, target, maze, config, &workspace);
 // ---------------------------------------------------------------------------
 
+struct SimConfig {
+    // Input computation
+    float WALL_PRESSURE_COEFF = 10.0f;
+    float CROWD_RADIUS = 5.0f;
+    float R_MIN = 0.3f;
+    bool  TARGET_USE_NEAREST_SOURCE = true;
+    float TARGET_SOURCE_BLEND = 0.85f;
+
+    // Output thresholds & multipliers
+    float THRESHOLD_APOPTOSIS = 0.8f;
+    float THRESHOLD_DEAD_EDGE = 0.1f;
+    float PRUNE_EXPONENT = 3.0f;
+    float GROW_MULTIPLIER = 1.5f;
+
+    // Snap logic
+    float SNAP_ANGLE_COS = 0.866f;
+    float THRESHOLD_SPROUT = 0.5f;
+    float SNAP_RADIUS = 3.0f;
+    float INITIAL_WEIGHT = 0.5f;
+
+    // Shift logic
+    float SHIFT_RATE = 0.5f;
+    float WALL_AVOIDANCE_STRENGTH = 0.3f;
+    float WALL_STUCK_THRESHOLD = 0.6f;
+    float WALL_UNSTUCK_FORCE = 0.8f;
+
+    // Input/Output limits
+    float INPUT_CLAMP = 5.0f;
+
+    // Raycast & collision detection
+    float WALL_SAFETY_MARGIN = 0.05f;
+    float RAYCAST_STEP = 0.05f;
+    float EDGE_CHECK_STEP = 0.1f;
+    float MIN_SPROUT_DISTANCE = 0.05f;
+    bool  RAYCAST_EXACT = false;              // cell-traversal raycast instead of RAYCAST_STEP marching
+
+    // Debug flags
+    bool  DEBUG_GROW = false;
+    bool  DEBUG_SHIFT = false;
+
+    // Energy dynamics
+    float ENERGY_SOURCE_VALUE = 100.0f;
+    float ENERGY_MAINTENANCE_COST = 1.0f;
+    float ENERGY_MAINTENANCE_PER_WEIGHT = 0.02f;
+    float ENERGY_DIFFUSION_ALPHA = 0.05f;
+    float ENERGY_FLOW_GAIN = 1.0f;
+    bool  ENERGY_FLOW_NORMALIZE_BY_DEGREE = true;
+    bool  ENERGY_PULSE_ENABLE = false;
+    float ENERGY_PULSE_PERIOD_STEPS = 50.0f;
+    float ENERGY_PULSE_LOW_RATIO = 0.35f;
+    float ENERGY_PULSE_SINK_VALUE = 0.0f;
+    float EDGE_WEIGHT_MAX = 80.0f;
+    float ENERGY_INITIAL = 20.0f;
+    bool  ENERGY_USE_AS_IMPORTANCE = true;
+    float ENERGY_IMPORTANCE_SCALE = 0.05f;
+    float ENERGY_DEATH_PATIENCE = 6.0f;
+    float ENERGY_COST_EDGE_THICKEN = 0.8f;
+    float ENERGY_COST_NEW_CONNECTION = 1.5f;
+    float ENERGY_COST_SPROUT = 8.0f;
+    float ENERGY_CHILD_INITIAL = 6.0f;
+    float ENERGY_MIN_CLAMP = -50.0f;
+    float ENERGY_MAX_CLAMP = 200.0f;
+
+    // Apoptosis stabilization
+    float APOPTOSIS_WARMUP_STEPS = 20.0f;
+    float NN_APOPTOSIS_ENERGY_GATE = 0.45f;
+
+    // Anastomosis (node merge)
+    float FUSION_DISTANCE = 0.75f;
+    float FUSION_MAX_MERGES_PER_STEP = 8.0f;
+    float FUSION_MIN_RETAIN_RATIO = 0.90f;
+
+    // Research/Submission mode switch
+    bool  ENABLE_BACKBONE_PROTECTION = false;
+
+    // Acceleration structures (results are identical with the flag off; kept
+    // switchable for A/B checks)
+    bool  USE_SPATIAL_INDEX = true;
+    bool  WALL_FIELD_ENABLE = true;           // precomputed nearest-wall field per maze
+    float WALL_FIELD_RESOLUTION = 4.0f;       // field lattice samples per cell
+    bool  WALL_FIELD_VALIDATE = false;        // print max deviation vs exact scan on build
+    bool  USE_LOS_CACHE = true;               // per-maze cell-pair line-of-sight cache
+    bool  ENERGY_PARALLEL_KERNEL = false;     // energy rules via the per-node gather kernel (SoA, threaded)
+    bool  NODE_FREE_LIST = false;             // release dead nodes/links in place instead of compacting every step
+    float NODE_DEFRAG_FREE_FRACTION = 0.5f;   // free-list mode: compact when free slots exceed this fraction
+    bool  STEP_SYNC_UPDATE = false;           // evaluate all nodes' NN from one snapshot, then apply
+    float STEP_THREADS = 1.0f;                // threads for the synchronous update / parallel energy kernel
+    bool  NN_FAST_TANH = false;               // node NN with the bounded-error fast tanh (results drift)
+};
+
+// ---------------------------------------------------------------------------
+// Process-wide configuration (compatibility shim)
+//
+// The UPPER_CASE globals below are references into global_config; overloads
+// without a SimConfig parameter (step(), load_config(path), ...) use it.
+// ---------------------------------------------------------------------------
+
+extern SimConfig global_config;
+
 // Input computation
-extern float WALL_PRESSURE_COEFF;
-extern float CROWD_RADIUS;
-extern float R_MIN;
-extern bool  TARGET_USE_NEAREST_SOURCE;
-extern float TARGET_SOURCE_BLEND;
+extern float& WALL_PRESSURE_COEFF;
+extern float& CROWD_RADIUS;
+extern float& R_MIN;
+extern bool&  TARGET_USE_NEAREST_SOURCE;
+extern float& TARGET_SOURCE_BLEND;
 
 // Output thresholds & multipliers
-extern float THRESHOLD_APOPTOSIS;
-extern float THRESHOLD_DEAD_EDGE;
-extern float PRUNE_EXPONENT;
-extern float GROW_MULTIPLIER;
+extern float& THRESHOLD_APOPTOSIS;
+extern float& THRESHOLD_DEAD_EDGE;
+extern float& PRUNE_EXPONENT;
+extern float& GROW_MULTIPLIER;
 
 // Snap logic
-extern float SNAP_ANGLE_COS;
-extern float THRESHOLD_SPROUT;
-extern float SNAP_RADIUS;
-extern float INITIAL_WEIGHT;
+extern float& SNAP_ANGLE_COS;
+extern float& THRESHOLD_SPROUT;
+extern float& SNAP_RADIUS;
+extern float& INITIAL_WEIGHT;
 
 // Shift logic
-extern float SHIFT_RATE;
-extern float WALL_AVOIDANCE_STRENGTH;
-extern float WALL_STUCK_THRESHOLD;
-extern float WALL_UNSTUCK_FORCE;
+extern float& SHIFT_RATE;
+extern float& WALL_AVOIDANCE_STRENGTH;
+extern float& WALL_STUCK_THRESHOLD;
+extern float& WALL_UNSTUCK_FORCE;
 
 // Input/Output limits
-extern float INPUT_CLAMP;
+extern float& INPUT_CLAMP;
 
 // Raycast & collision detection
-extern float WALL_SAFETY_MARGIN;
-extern float RAYCAST_STEP;
-extern float EDGE_CHECK_STEP;
-extern float MIN_SPROUT_DISTANCE;
+extern float& WALL_SAFETY_MARGIN;
+extern float& RAYCAST_STEP;
+extern float& EDGE_CHECK_STEP;
+extern float& MIN_SPROUT_DISTANCE;
+extern bool&  RAYCAST_EXACT;  // cell-traversal raycast instead of RAYCAST_STEP marching
 
 // Debug flags
-extern bool DEBUG_GROW;
-extern bool DEBUG_SHIFT;
+extern bool& DEBUG_GROW;
+extern bool& DEBUG_SHIFT;
 
 // Energy dynamics
-extern float ENERGY_SOURCE_VALUE;
-extern float ENERGY_MAINTENANCE_COST;
-extern float ENERGY_MAINTENANCE_PER_WEIGHT;
-extern float ENERGY_DIFFUSION_ALPHA;
-extern float ENERGY_FLOW_GAIN;
-extern bool  ENERGY_FLOW_NORMALIZE_BY_DEGREE;
-extern bool  ENERGY_PULSE_ENABLE;
-extern float ENERGY_PULSE_PERIOD_STEPS;
-extern float ENERGY_PULSE_LOW_RATIO;
-extern float ENERGY_PULSE_SINK_VALUE;
-extern float EDGE_WEIGHT_MAX;
-extern float ENERGY_INITIAL;
-extern bool  ENERGY_USE_AS_IMPORTANCE;
-extern float ENERGY_IMPORTANCE_SCALE;
-extern float ENERGY_DEATH_PATIENCE;
-extern float ENERGY_COST_EDGE_THICKEN;
-extern float ENERGY_COST_NEW_CONNECTION;
-extern float ENERGY_COST_SPROUT;
-extern float ENERGY_CHILD_INITIAL;
-extern float ENERGY_MIN_CLAMP;
-extern float ENERGY_MAX_CLAMP;
+extern float& ENERGY_SOURCE_VALUE;
+extern float& ENERGY_MAINTENANCE_COST;
+extern float& ENERGY_MAINTENANCE_PER_WEIGHT;
+extern float& ENERGY_DIFFUSION_ALPHA;
+extern float& ENERGY_FLOW_GAIN;
+extern bool&  ENERGY_FLOW_NORMALIZE_BY_DEGREE;
+extern bool&  ENERGY_PULSE_ENABLE;
+extern float& ENERGY_PULSE_PERIOD_STEPS;
+extern float& ENERGY_PULSE_LOW_RATIO;
+extern float& ENERGY_PULSE_SINK_VALUE;
+extern float& EDGE_WEIGHT_MAX;
+extern float& ENERGY_INITIAL;
+extern bool&  ENERGY_USE_AS_IMPORTANCE;
+extern float& ENERGY_IMPORTANCE_SCALE;
+extern float& ENERGY_DEATH_PATIENCE;
+extern float& ENERGY_COST_EDGE_THICKEN;
+extern float& ENERGY_COST_NEW_CONNECTION;
+extern float& ENERGY_COST_SPROUT;
+extern float& ENERGY_CHILD_INITIAL;
+extern float& ENERGY_MIN_CLAMP;
+extern float& ENERGY_MAX_CLAMP;
 
 // Apoptosis stabilization
-extern float APOPTOSIS_WARMUP_STEPS;
-extern float NN_APOPTOSIS_ENERGY_GATE;
+extern float& APOPTOSIS_WARMUP_STEPS;
+extern float& NN_APOPTOSIS_ENERGY_GATE;
 
 // Anastomosis (node merge)
-extern float FUSION_DISTANCE;
-extern float FUSION_MAX_MERGES_PER_STEP;
-extern float FUSION_MIN_RETAIN_RATIO;
+extern float& FUSION_DISTANCE;
+extern float& FUSION_MAX_MERGES_PER_STEP;
+extern float& FUSION_MIN_RETAIN_RATIO;
 
 // Research/Submission mode switch
-extern bool ENABLE_BACKBONE_PROTECTION;
+extern bool& ENABLE_BACKBONE_PROTECTION;
+
+// Acceleration structures (results are identical with the flag off; kept
+// switchable for A/B checks)
+extern bool& USE_SPATIAL_INDEX;
+extern bool&  WALL_FIELD_ENABLE;      // precomputed nearest-wall field per maze
+extern float& WALL_FIELD_RESOLUTION;  // field lattice samples per cell
+extern bool&  WALL_FIELD_VALIDATE;    // print max deviation vs exact scan on build
+extern bool&  USE_LOS_CACHE;          // per-maze cell-pair line-of-sight cache
+extern bool&  ENERGY_PARALLEL_KERNEL; // energy rules via the per-node gather kernel (SoA, threaded)
+extern bool&  NODE_FREE_LIST;         // release dead nodes/links in place instead of compacting every step
+extern float& NODE_DEFRAG_FREE_FRACTION;  // free-list mode: compact when free slots exceed this fraction
+extern bool&  STEP_SYNC_UPDATE;       // evaluate all nodes' NN from one snapshot, then apply
+extern float& STEP_THREADS;           // threads for the synchronous update / parallel energy kernel
+extern bool&  NN_FAST_TANH;           // node NN with the bounded-error fast tanh (results drift)
 
 // ---------------------------------------------------------------------------
 // Configuration loader
 // ---------------------------------------------------------------------------
 
-// Load hyperparameters from a file.
+// Load hyperparameters from a file into `config`; keys missing from the file
+// keep their current values.
 // Returns true on success, false on error.
 // If the file cannot be opened, defaults are used and the function returns false.
-bool load_config(const std::string& filepath);
+bool load_config(const std::string& filepath, SimConfig& config);
+bool load_config(const std::string& filepath);  // into global_config
 
 // Set all hyperparameters to their default values.
-void set_default_config();
+void set_default_config(SimConfig& config);
+void set_default_config();  // global_config
+
+// Read / write one hyperparameter by its config file key. Bools read as 0 / 1
+// and are set from value > 0.5, as in the file. Return false for an unknown
+// key.
+bool set_config_value(SimConfig& config, const std::string& key, float value);
+bool get_config_value(const SimConfig& config, const std::string& key, float& value);
 
 } // namespace sim
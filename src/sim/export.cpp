@@ -1,6 +1,7 @@
 #include "export.h"
 #include <iomanip>
 #include <iostream>
+#include <vector>
 
 namespace sim {
 
@@ -32,10 +33,21 @@ static void write_graph_object(std::ostream& os,
     os << std::fixed << std::setprecision(4);
     os << "{\"step\":" << step_number << ",\"nodes\":[";
 
+    // Ids are dense over alive nodes; released slots (free-list mode) are
+    // skipped.
+    std::vector<int> id(graph.nodes.size(), -1);
+    int next_id = 0;
     for (int i = 0; i < static_cast<int>(graph.nodes.size()); ++i) {
-        if (i > 0) os << ',';
+        if (!graph.nodes[i].is_dead) id[i] = next_id++;
+    }
+
+    bool first = true;
+    for (int i = 0; i < static_cast<int>(graph.nodes.size()); ++i) {
+        if (id[i] < 0) continue;
+        if (!first) os << ',';
+        first = false;
         const Node& n = graph.nodes[i];
-        os << "{\"id\":" << i
+        os << "{\"id\":" << id[i]
            << ",\"x\":" << n.pos.x
            << ",\"y\":" << n.pos.y
               << ",\"energy\":" << n.energy
@@ -43,11 +55,15 @@ static void write_graph_object(std::ostream& os,
               << ",\"source\":" << (n.is_source ? "true" : "false")
            << ",\"edges\":[";
 
-        for (int j = 0; j < static_cast<int>(n.edges.size()); ++j) {
-            if (j > 0) os << ',';
-            const Edge& e = n.edges[j];
-            os << "{\"to\":" << e.target_node_idx
-               << ",\"w\":"  << e.weight << '}';
+        bool first_edge = true;
+        for (int l : n.links) {
+            const Link& link = graph.links[l];
+            const int to = link_other(link, i);
+            if (to < 0 || id[to] < 0) continue;
+            if (!first_edge) os << ',';
+            first_edge = false;
+            os << "{\"to\":" << id[to]
+               << ",\"w\":"  << link_out_weight(link, i) << '}';
         }
         os << "]}";
     }
@@ -1,16 +1,61 @@
 #include "graph.h"
 #include "maze.h"
-#include "node_nn/nn.h"
+#include "spatial_index.h"
+#include "graph_soa.h"
+#include "step_workspace.h"
+#include "wall_field.h"
+#include "line_of_sight.h"
+#include "node_nn/model.h"
 
 #include <cmath>
 #include <algorithm>
 #include <limits>
+#include <memory>
 #include <iostream>
+#include <optional>
+#include <sstream>
 #include <unordered_set>
-#include <unordered_map>
 
 namespace sim {
 
+// ---------------------------------------------------------------------------
+// Links
+// ---------------------------------------------------------------------------
+
+int add_node(Graph& graph, const Node& node) {
+    const int idx = static_cast<int>(graph.nodes.size());
+    graph.nodes.push_back(node);
+    graph.nodes[idx].generation = ++graph.last_generation;
+    graph.nodes[idx].is_touched = false;
+    touch_node(graph, idx);
+    return idx;
+}
+
+int add_link(Graph& graph, int a, int b, float weight) {
+    int l;
+    if (graph.free_links.empty()) {
+        l = static_cast<int>(graph.links.size());
+        graph.links.push_back({a, b, weight, weight});
+    } else {
+        l = graph.free_links.back();
+        graph.free_links.pop_back();
+        graph.links[l] = {a, b, weight, weight};
+    }
+    graph.nodes[a].links.push_back(l);
+    graph.nodes[b].links.push_back(l);
+    touch_node(graph, a);
+    touch_node(graph, b);
+    return l;
+}
+
+int live_node_count(const Graph& graph) {
+    int count = 0;
+    for (const Node& node : graph.nodes) {
+        if (!node.is_dead) ++count;
+    }
+    return count;
+}
+
 // ---------------------------------------------------------------------------
 // Internal helpers
 // ---------------------------------------------------------------------------
@@ -33,38 +78,105 @@ static float clamp(float v, float lo, float hi) {
     return v < lo ? lo : (v > hi ? hi : v);
 }
 
-static float clamp_edge_weight(float w) {
-    return clamp(w, 0.0f, std::max(0.0f, EDGE_WEIGHT_MAX));
+static float clamp_edge_weight(float w, const SimConfig& config) {
+    return clamp(w, 0.0f, std::max(0.0f, config.EDGE_WEIGHT_MAX));
 }
 
-// Add weight to an edge between two nodes, creating it if it doesn't exist.
-// Prevents duplicate edges by checking first.
-static void add_or_strengthen_edge(Graph& graph, int from_idx, int to_idx, float weight_delta) {
-    if (from_idx < 0 || to_idx < 0 || 
-        from_idx >= static_cast<int>(graph.nodes.size()) ||
-        to_idx >= static_cast<int>(graph.nodes.size()))
+// Add weight to the link between two nodes in both directions, creating it if
+// it doesn't exist. Prevents duplicate links by checking first.
+static void add_or_strengthen_link(Graph& graph, int a, int b, float weight_delta,
+                                   const SimConfig& config) {
+    if (a < 0 || b < 0 || a == b ||
+        a >= static_cast<int>(graph.nodes.size()) ||
+        b >= static_cast<int>(graph.nodes.size()))
         return;
-    
-    Node& from_node = graph.nodes[from_idx];
-    
-    // Look for existing edge
-    for (Edge& e : from_node.edges) {
-        if (e.target_node_idx == to_idx) {
-            // Edge exists, strengthen it
-            e.weight = clamp_edge_weight(e.weight + weight_delta);
+
+    // Look for existing link
+    for (int l : graph.nodes[a].links) {
+        Link& link = graph.links[l];
+        if (link_other(link, a) == b) {
+            // Link exists, strengthen both directions
+            link.w_ab = clamp_edge_weight(link.w_ab + weight_delta, config);
+            link.w_ba = clamp_edge_weight(link.w_ba + weight_delta, config);
+            touch_node(graph, a);
+            touch_node(graph, b);
             return;
         }
     }
-    
-    // Edge doesn't exist, create it
-    from_node.edges.push_back({to_idx, clamp_edge_weight(weight_delta)});
+
+    // Link doesn't exist, create it
+    add_link(graph, a, b, clamp_edge_weight(weight_delta, config));
+}
+
+// Exact raycast: walk the grid cells the segment passes through
+// (Amanatides & Woo) and stop at the first wall cell boundary, then pull back
+// by WALL_SAFETY_MARGIN. Cost is one is_wall per crossed cell instead of one
+// per RAYCAST_STEP.
+static Vec2 raycast_to_wall_exact(const Maze& maze, const Vec2& start, const Vec2& end,
+                                  const SimConfig& config) {
+    if (is_wall(maze, start.x, start.y))
+        return start;
+
+    const float dx = end.x - start.x;
+    const float dy = end.y - start.y;
+    const float total_dist = std::sqrt(dx * dx + dy * dy);
+    if (total_dist < 1.0e-6f)
+        return start;
+
+    const float dir_x = dx / total_dist;
+    const float dir_y = dy / total_dist;
+
+    int cx = static_cast<int>(std::floor(start.x));
+    int cy = static_cast<int>(std::floor(start.y));
+    const int step_x = (dir_x > 0.0f) ? 1 : -1;
+    const int step_y = (dir_y > 0.0f) ? 1 : -1;
+
+    const float inf = std::numeric_limits<float>::infinity();
+    const float delta_x = (dir_x != 0.0f) ? std::abs(1.0f / dir_x) : inf;
+    const float delta_y = (dir_y != 0.0f) ? std::abs(1.0f / dir_y) : inf;
+    float t_max_x = (dir_x > 0.0f) ? (static_cast<float>(cx + 1) - start.x) / dir_x
+                  : (dir_x < 0.0f) ? (start.x - static_cast<float>(cx)) / -dir_x
+                  : inf;
+    float t_max_y = (dir_y > 0.0f) ? (static_cast<float>(cy + 1) - start.y) / dir_y
+                  : (dir_y < 0.0f) ? (start.y - static_cast<float>(cy)) / -dir_y
+                  : inf;
+
+    // Never return a point exactly on the wall face, even with a zero margin.
+    const float pull_back = std::max(config.WALL_SAFETY_MARGIN, 1.0e-4f);
+
+    while (true) {
+        // Cross whichever cell boundary comes first; at an exact corner cross
+        // X then Y so both side cells are checked.
+        float t;
+        if (t_max_x <= t_max_y) {
+            t = t_max_x;
+            if (t > total_dist) break;
+            cx += step_x;
+            t_max_x += delta_x;
+        } else {
+            t = t_max_y;
+            if (t > total_dist) break;
+            cy += step_y;
+            t_max_y += delta_y;
+        }
+
+        if (is_wall(maze, static_cast<float>(cx) + 0.5f, static_cast<float>(cy) + 0.5f)) {
+            const float safe_dist = std::max(0.0f, t - pull_back);
+            return {start.x + dir_x * safe_dist, start.y + dir_y * safe_dist};
+        }
+    }
+
+    return end;
 }
 
 // Raycast from start to end, return the furthest valid (non-wall) position.
 // Always checks the entire path for walls, applying a safety margin.
-static Vec2 raycast_to_wall(const Maze& maze, const Vec2& start, const Vec2& end) {
+static Vec2 raycast_to_wall(const Maze& maze, const Vec2& start, const Vec2& end,
+                            const SimConfig& config) {
     // WALL_SAFETY_MARGIN and RAYCAST_STEP are now loaded from config
-    
+    if (config.RAYCAST_EXACT)
+        return raycast_to_wall_exact(maze, start, end, config);
+
     // If start is in a wall, can't move
     if (is_wall(maze, start.x, start.y))
         return start;
@@ -90,18 +202,18 @@ static Vec2 raycast_to_wall(const Maze& maze, const Vec2& start, const Vec2& end
         
         if (is_wall(maze, pos.x, pos.y)) {
             // Hit wall - return position pulled back by safety margin
-            float safe_dist = std::max(0.0f, last_safe_dist - WALL_SAFETY_MARGIN);
+            float safe_dist = std::max(0.0f, last_safe_dist - config.WALL_SAFETY_MARGIN);
             return {start.x + dir_x * safe_dist, start.y + dir_y * safe_dist};
         }
         
         last_safe_dist = dist;
-        dist += RAYCAST_STEP;
+        dist += config.RAYCAST_STEP;
     }
     
     // Entire path is clear - still apply safety margin from endpoint if needed
     // Check one more time at exact endpoint
     if (is_wall(maze, end.x, end.y)) {
-        float safe_dist = std::max(0.0f, last_safe_dist - WALL_SAFETY_MARGIN);
+        float safe_dist = std::max(0.0f, last_safe_dist - config.WALL_SAFETY_MARGIN);
         return {start.x + dir_x * safe_dist, start.y + dir_y * safe_dist};
     }
     
@@ -110,204 +222,158 @@ static Vec2 raycast_to_wall(const Maze& maze, const Vec2& start, const Vec2& end
 
 // Check if a line segment from p1 to p2 crosses through any wall cells.
 // Returns true if the edge would pass through a wall.
-static bool edge_crosses_wall(const Maze& maze, const Vec2& p1, const Vec2& p2) {
-    auto is_wall_cell = [&](int x, int y) {
-        if (x < 0 || y < 0 || x >= maze.width || y >= maze.height) {
-            return true;
-        }
-        return maze.grid[y][x] == 1;
-    };
-
-    int x0 = static_cast<int>(std::floor(p1.x));
-    int y0 = static_cast<int>(std::floor(p1.y));
-    int x1 = static_cast<int>(std::floor(p2.x));
-    int y1 = static_cast<int>(std::floor(p2.y));
-
-    if (is_wall_cell(x0, y0) || is_wall_cell(x1, y1)) {
-        return true;
+static bool edge_crosses_wall(const Maze& maze, const Vec2& p1, const Vec2& p2,
+                              const SimConfig& config) {
+    const int x0 = static_cast<int>(std::floor(p1.x));
+    const int y0 = static_cast<int>(std::floor(p1.y));
+    const int x1 = static_cast<int>(std::floor(p2.x));
+    const int y1 = static_cast<int>(std::floor(p2.y));
+
+    if (config.USE_LOS_CACHE && maze.los_cache) {
+        return maze.los_cache->blocked(maze, x0, y0, x1, y1);
     }
-
-    int dx = std::abs(x1 - x0);
-    int dy = std::abs(y1 - y0);
-    int sx = (x0 < x1) ? 1 : -1;
-    int sy = (y0 < y1) ? 1 : -1;
-    int err = dx - dy;
-
-    while (true) {
-        if (is_wall_cell(x0, y0)) {
-            return true;
-        }
-        if (x0 == x1 && y0 == y1) {
-            break;
-        }
-
-        int prev_x = x0;
-        int prev_y = y0;
-        int e2 = 2 * err;
-
-        if (e2 > -dy) {
-            err -= dy;
-            x0 += sx;
-        }
-        if (e2 < dx) {
-            err += dx;
-            y0 += sy;
-        }
-
-        // Supercover-style corner check: catch diagonal corner clipping.
-        if (x0 != prev_x && y0 != prev_y) {
-            if (is_wall_cell(prev_x, y0) || is_wall_cell(x0, prev_y)) {
-                return true;
-            }
-        }
-    }
-
-    return false;
+    return cells_line_blocked(maze, x0, y0, x1, y1);
 }
 
-static Edge* find_edge(Node& node, int target_idx) {
-    for (Edge& e : node.edges) {
-        if (e.target_node_idx == target_idx) {
-            return &e;
-        }
-    }
-    return nullptr;
-}
-
-// Ensure edges are strictly bidirectional with matching weights.
-// Rebuilds edges from undirected pair weights to avoid in-loop mutation bugs.
-static void enforce_bidirectional_weight_symmetry(Graph& graph) {
-    const int m = static_cast<int>(graph.nodes.size());
-    if (m <= 1) return;
-
-    std::unordered_map<long long, float> w_ab;  // directed a->b
-    std::unordered_map<long long, float> undirected_w;
-
-    auto make_key = [](int a, int b) -> long long {
-        return (static_cast<long long>(a) << 32) | static_cast<unsigned int>(b);
-    };
-
-    for (int i = 0; i < m; ++i) {
-        if (graph.nodes[i].is_dead) continue;
-        for (const Edge& e : graph.nodes[i].edges) {
-            const int j = e.target_node_idx;
-            if (e.weight <= 0.0f) continue;
-            if (j < 0 || j >= m || j == i) continue;
-            if (graph.nodes[j].is_dead) continue;
-
-            const long long key = make_key(i, j);
-            auto it = w_ab.find(key);
-            if (it == w_ab.end()) {
-                w_ab.emplace(key, e.weight);
-            } else {
-                it->second = std::max(it->second, e.weight);
-            }
-        }
-    }
-
-    for (const auto& kv : w_ab) {
-        const int a = static_cast<int>(kv.first >> 32);
-        const int b = static_cast<int>(kv.first & 0xffffffffu);
-        const int i = std::min(a, b);
-        const int j = std::max(a, b);
-
-        const long long key_ij = make_key(i, j);
-        const long long key_ji = make_key(j, i);
-
-        const float w_ij = w_ab.count(key_ij) ? w_ab[key_ij] : 0.0f;
-        const float w_ji = w_ab.count(key_ji) ? w_ab[key_ji] : 0.0f;
-        const float w = (w_ij > 0.0f && w_ji > 0.0f)
-            ? (0.5f * (w_ij + w_ji))
-            : std::max(w_ij, w_ji);
-
-        if (w > 0.0f) {
-            undirected_w[key_ij] = clamp_edge_weight(w);
-        }
-    }
-
-    for (int i = 0; i < m; ++i) {
-        graph.nodes[i].edges.clear();
-    }
-
-    for (const auto& kv : undirected_w) {
-        const int i = static_cast<int>(kv.first >> 32);
-        const int j = static_cast<int>(kv.first & 0xffffffffu);
-        const float w = kv.second;
-
-        if (i < 0 || i >= m || j < 0 || j >= m || i == j) continue;
-        if (graph.nodes[i].is_dead || graph.nodes[j].is_dead) continue;
+// ---------------------------------------------------------------------------
+// Anastomosis (fusion) stage
+//
+// Finds close pairs through the spatial index and resolves a batch of
+// non-overlapping merges in a single pass. Incident weights in both
+// directions come from the nodes' links rather than from full scans. Merged
+// nodes are added with add_node and both partners marked dead; the caller
+// cleans up once with cleanup_dead.
+//
+// Non-overlap rule: a pair is only merged if neither partner was merged or
+// reconnected by an earlier merge of this pass, and none of its neighbours was
+// merged away. The nodes and links an accepted merge reads were therefore not
+// written by an earlier merge of the pass. This is not the old
+// one-merge-at-a-time loop: that ran a full cleanup_dead (link
+// canonicalisation, edge drops, compaction) between merges and could merge a
+// freshly merged node again in the same step. Here nodes created by the pass
+// are not candidates, and overlapping pairs wait for the next step.
+// ---------------------------------------------------------------------------
 
-        graph.nodes[i].edges.push_back({j, w});
-        graph.nodes[j].edges.push_back({i, w});
+using IncidentWeight = StepWorkspace::IncidentWeight;
+using FusionNeighbor = StepWorkspace::FusionNeighbor;
+
+// Max incident weight per neighbour of `i` (outgoing and incoming, w > 0),
+// sorted by neighbour index. Incoming directions only count from nodes that
+// were alive when the pass started (`merged_away` nodes were).
+static void gather_incident(const Graph& graph,
+                            const std::vector<char>& merged_away,
+                            int i,
+                            std::vector<IncidentWeight>& out) {
+    out.clear();
+    const int node_count = static_cast<int>(merged_away.size());
+    for (int l : graph.nodes[i].links) {
+        const Link& link = graph.links[l];
+        const int k = link_other(link, i);
+        if (k < 0 || k >= node_count || k == i) continue;
+
+        float w = 0.0f;
+        const float w_out = link_out_weight(link, i);
+        if (w_out > 0.0f) w = w_out;
+
+        const float w_in = link_in_weight(link, i);
+        const bool k_was_alive = !graph.nodes[k].is_dead || merged_away[k];
+        if (w_in > 0.0f && k_was_alive) w = std::max(w, w_in);
+
+        if (w > 0.0f) out.push_back({k, w});
     }
+    std::sort(out.begin(), out.end(),
+              [](const IncidentWeight& a, const IncidentWeight& b) { return a.k < b.k; });
 }
 
-static bool merge_one_close_pair(Graph& graph, const Maze& maze, float distance_threshold) {
-    if (distance_threshold <= 0.0f) {
-        return false;
+static int fuse_close_pairs(Graph& graph, const Maze& maze, const SimConfig& config,
+                            StepWorkspace& ws, float distance_threshold, int max_merges) {
+    if (distance_threshold <= 0.0f || max_merges <= 0) {
+        return 0;
     }
 
     const float threshold2 = distance_threshold * distance_threshold;
     const int node_count = static_cast<int>(graph.nodes.size());
 
-    for (int i = 0; i < node_count; ++i) {
-        const Node& a = graph.nodes[i];
-        if (a.is_dead || a.is_pinned || a.is_source) continue;
+    const SpatialIndex& index = ws.index;
+    std::vector<char>& merged_away = ws.merged_away;  // partner of a merge
+    std::vector<char>& reconnected = ws.reconnected;  // neighbour of a merge
+    merged_away.assign(static_cast<size_t>(node_count), 0);
+    reconnected.assign(static_cast<size_t>(node_count), 0);
+
+    std::vector<int>& candidates = ws.candidates;
+    std::vector<IncidentWeight>& inc_i = ws.inc_i;
+    std::vector<IncidentWeight>& inc_j = ws.inc_j;
+    std::vector<FusionNeighbor>& neighbors = ws.neighbors;
+    std::vector<std::pair<int, float>>& reconnectable = ws.reconnectable;
+
+    auto can_merge = [&](int idx) {
+        const Node& n = graph.nodes[idx];
+        return !n.is_dead && !n.is_pinned && !n.is_source &&
+               !merged_away[idx] && !reconnected[idx];
+    };
 
-        for (int j = i + 1; j < node_count; ++j) {
-            const Node& b = graph.nodes[j];
-            if (b.is_dead || b.is_pinned || b.is_source) continue;
+    int merges = 0;
+    for (int i = 0; i < node_count && merges < max_merges; ++i) {
+        if (!can_merge(i)) continue;
 
-            const float dx = a.pos.x - b.pos.x;
-            const float dy = a.pos.y - b.pos.y;
+        candidates.clear();
+        index.collect_within(graph, graph.nodes[i].pos, i, threshold2, candidates);
+        std::sort(candidates.begin(), candidates.end());
+
+        bool have_inc_i = false;
+        for (int j : candidates) {
+            if (j <= i || j >= node_count) continue;
+            if (!can_merge(j)) continue;
+
+            const Vec2 a_pos = graph.nodes[i].pos;
+            const Vec2 b_pos = graph.nodes[j].pos;
+            const float dx = a_pos.x - b_pos.x;
+            const float dy = a_pos.y - b_pos.y;
             if (dx * dx + dy * dy >= threshold2) continue;
 
-            // Preserve BOTH incident edge sets:
-            // - outgoing from i/j
-            // - incoming to i/j from other nodes
-            const int old_node_count = node_count;
-            std::vector<float> i_incident(old_node_count, 0.0f);
-            std::vector<float> j_incident(old_node_count, 0.0f);
-
-            // Outgoing from i/j
-            for (const Edge& e : graph.nodes[i].edges) {
-                if (e.weight <= 0.0f) continue;
-                int k = e.target_node_idx;
-                if (k < 0 || k >= old_node_count || k == i || k == j) continue;
-                i_incident[k] = std::max(i_incident[k], e.weight);
-            }
-            for (const Edge& e : graph.nodes[j].edges) {
-                if (e.weight <= 0.0f) continue;
-                int k = e.target_node_idx;
-                if (k < 0 || k >= old_node_count || k == i || k == j) continue;
-                j_incident[k] = std::max(j_incident[k], e.weight);
+            // Preserve BOTH incident edge sets (outgoing and incoming).
+            if (!have_inc_i) {
+                gather_incident(graph, merged_away, i, inc_i);
+                have_inc_i = true;
             }
-
-            // Incoming to i/j (i.e. outgoing from k)
-            for (int k = 0; k < old_node_count; ++k) {
-                if (k == i || k == j) continue;
-                if (graph.nodes[k].is_dead) continue;
-                for (const Edge& e : graph.nodes[k].edges) {
-                    if (e.weight <= 0.0f) continue;
-                    if (e.target_node_idx == i) {
-                        i_incident[k] = std::max(i_incident[k], e.weight);
-                    } else if (e.target_node_idx == j) {
-                        j_incident[k] = std::max(j_incident[k], e.weight);
-                    }
+            gather_incident(graph, merged_away, j, inc_j);
+
+            // Union of both neighbourhoods, ascending neighbour index.
+            neighbors.clear();
+            bool touches_merged_node = false;
+            size_t pi = 0, pj = 0;
+            while (pi < inc_i.size() || pj < inc_j.size()) {
+                FusionNeighbor nb;
+                if (pj >= inc_j.size() || (pi < inc_i.size() && inc_i[pi].k < inc_j[pj].k)) {
+                    nb = {inc_i[pi].k, inc_i[pi].w, 0.0f};
+                    ++pi;
+                } else if (pi >= inc_i.size() || inc_j[pj].k < inc_i[pi].k) {
+                    nb = {inc_j[pj].k, 0.0f, inc_j[pj].w};
+                    ++pj;
+                } else {
+                    nb = {inc_i[pi].k, inc_i[pi].w, inc_j[pj].w};
+                    ++pi;
+                    ++pj;
+                }
+                if (nb.k == i || nb.k == j) continue;
+                if (graph.nodes[nb.k].is_dead) continue;
+                if (merged_away[nb.k]) {
+                    touches_merged_node = true;
+                    break;
                 }
+                neighbors.push_back(nb);
             }
+            if (touches_merged_node) continue;
 
             auto retained_weight_at = [&](const Vec2& pos) {
                 if (is_wall(maze, pos.x, pos.y)) {
                     return -1.0f;
                 }
                 float retained = 0.0f;
-                for (int k = 0; k < old_node_count; ++k) {
-                    if (k == i || k == j) continue;
-                    if (graph.nodes[k].is_dead) continue;
-                    const float merged_weight = i_incident[k] + j_incident[k];
+                for (const FusionNeighbor& nb : neighbors) {
+                    const float merged_weight = nb.wi + nb.wj;
                     if (merged_weight <= 0.0f) continue;
-                    if (!edge_crosses_wall(maze, pos, graph.nodes[k].pos)) {
+                    if (!edge_crosses_wall(maze, pos, graph.nodes[nb.k].pos, config)) {
                         retained += merged_weight;
                     }
                 }
@@ -315,18 +381,16 @@ static bool merge_one_close_pair(Graph& graph, const Maze& maze, float distance_
             };
 
             float total_incident_weight = 0.0f;
-            for (int k = 0; k < old_node_count; ++k) {
-                if (k == i || k == j) continue;
-                if (graph.nodes[k].is_dead) continue;
-                total_incident_weight += i_incident[k] + j_incident[k];
+            for (const FusionNeighbor& nb : neighbors) {
+                total_incident_weight += nb.wi + nb.wj;
             }
 
-            const Vec2 mid = {(a.pos.x + b.pos.x) * 0.5f, (a.pos.y + b.pos.y) * 0.5f};
-            const Vec2 candidates[3] = {mid, a.pos, b.pos};
+            const Vec2 mid = {(a_pos.x + b_pos.x) * 0.5f, (a_pos.y + b_pos.y) * 0.5f};
+            const Vec2 positions[3] = {mid, a_pos, b_pos};
 
             float best_retained = -1.0f;
             Vec2 best_pos = mid;
-            for (const Vec2& c : candidates) {
+            for (const Vec2& c : positions) {
                 const float retained = retained_weight_at(c);
                 if (retained > best_retained) {
                     best_retained = retained;
@@ -339,7 +403,7 @@ static bool merge_one_close_pair(Graph& graph, const Maze& maze, float distance_
             }
             if (total_incident_weight > 1.0e-6f) {
                 const float retain_ratio = best_retained / total_incident_weight;
-                if (retain_ratio < FUSION_MIN_RETAIN_RATIO) {
+                if (retain_ratio < config.FUSION_MIN_RETAIN_RATIO) {
                     continue;
                 }
             }
@@ -348,14 +412,9 @@ static bool merge_one_close_pair(Graph& graph, const Maze& maze, float distance_
             // If any edge that would be created by the merge crosses a wall,
             // cancel this merge candidate entirely.
             bool would_create_wall_crossing_edge = false;
-            for (int k = 0; k < old_node_count; ++k) {
-                if (k == i || k == j) continue;
-                if (graph.nodes[k].is_dead) continue;
-
-                const float merged_weight = i_incident[k] + j_incident[k];
-                if (merged_weight <= 0.0f) continue;
-
-                if (edge_crosses_wall(maze, best_pos, graph.nodes[k].pos)) {
+            for (const FusionNeighbor& nb : neighbors) {
+                if (nb.wi + nb.wj <= 0.0f) continue;
+                if (edge_crosses_wall(maze, best_pos, graph.nodes[nb.k].pos, config)) {
                     would_create_wall_crossing_edge = true;
                     break;
                 }
@@ -374,61 +433,53 @@ static bool merge_one_close_pair(Graph& graph, const Maze& maze, float distance_
             bool keeps_positive_axis_side = false;
             bool keeps_negative_axis_side = false;
             int reconnectable_neighbor_count = 0;
-            std::vector<std::pair<int, float>> reconnectable;
-            reconnectable.reserve(static_cast<size_t>(old_node_count));
+            reconnectable.clear();
 
-            const Vec2 merge_axis = {b.pos.x - a.pos.x, b.pos.y - a.pos.y};
+            const Vec2 merge_axis = {b_pos.x - a_pos.x, b_pos.y - a_pos.y};
             const float axis_len = vec2_length(merge_axis);
             const Vec2 merge_axis_n = (axis_len > 1.0e-6f)
                 ? Vec2{merge_axis.x / axis_len, merge_axis.y / axis_len}
                 : Vec2{0.0f, 0.0f};
 
-            for (int k = 0; k < old_node_count; ++k) {
-                if (k == i || k == j) continue;
-                if (graph.nodes[k].is_dead) continue;
-
-                const float wi = i_incident[k];
-                const float wj = j_incident[k];
-                const float merged_weight = wi + wj;
+            for (const FusionNeighbor& nb : neighbors) {
+                const float merged_weight = nb.wi + nb.wj;
                 if (merged_weight <= 0.0f) continue;
 
                 // final safety gate: only count edges that are actually valid
                 // from the chosen merge position.
-                if (edge_crosses_wall(maze, best_pos, graph.nodes[k].pos)) {
+                const Vec2& k_pos = graph.nodes[nb.k].pos;
+                if (edge_crosses_wall(maze, best_pos, k_pos, config)) {
                     continue;
                 }
 
                 ++reconnectable_neighbor_count;
-                if (wi > 0.0f) keeps_i_side = true;
-                if (wj > 0.0f) keeps_j_side = true;
-                if (wi > 0.0f && wj <= 0.0f) keeps_i_exclusive = true;
-                if (wj > 0.0f && wi <= 0.0f) keeps_j_exclusive = true;
+                if (nb.wi > 0.0f) keeps_i_side = true;
+                if (nb.wj > 0.0f) keeps_j_side = true;
+                if (nb.wi > 0.0f && nb.wj <= 0.0f) keeps_i_exclusive = true;
+                if (nb.wj > 0.0f && nb.wi <= 0.0f) keeps_j_exclusive = true;
 
                 if (axis_len > 1.0e-6f) {
-                    const Vec2 vk = {
-                        graph.nodes[k].pos.x - best_pos.x,
-                        graph.nodes[k].pos.y - best_pos.y
-                    };
+                    const Vec2 vk = {k_pos.x - best_pos.x, k_pos.y - best_pos.y};
                     const float proj = vec2_dot(vk, merge_axis_n);
                     if (proj > 1.0e-4f) keeps_positive_axis_side = true;
                     if (proj < -1.0e-4f) keeps_negative_axis_side = true;
                 }
 
-                reconnectable.push_back({k, merged_weight});
+                reconnectable.push_back({nb.k, merged_weight});
             }
 
             // Stronger requirement for chain preservation (e.g., a-b-c-d -> a-x-d):
             // both original sides must retain at least one EXCLUSIVE neighbor,
-                        // not only shared neighbors. Also require geometric two-sidedness
-                        // along the i<->j merge axis when axis is well-defined.
-                        const bool has_geometric_two_sides =
-                                (axis_len <= 1.0e-6f) ||
-                                (keeps_positive_axis_side && keeps_negative_axis_side);
+            // not only shared neighbors. Also require geometric two-sidedness
+            // along the i<->j merge axis when axis is well-defined.
+            const bool has_geometric_two_sides =
+                (axis_len <= 1.0e-6f) ||
+                (keeps_positive_axis_side && keeps_negative_axis_side);
 
             if (!(keeps_i_side && keeps_j_side &&
                   keeps_i_exclusive && keeps_j_exclusive &&
-                                    reconnectable_neighbor_count >= 2 &&
-                                    has_geometric_two_sides)) {
+                  reconnectable_neighbor_count >= 2 &&
+                  has_geometric_two_sides)) {
                 continue;
             }
 
@@ -441,74 +492,33 @@ static bool merge_one_close_pair(Graph& graph, const Maze& maze, float distance_
             merged.low_energy_steps = std::min(graph.nodes[i].low_energy_steps,
                                                graph.nodes[j].low_energy_steps);
 
-            graph.nodes.push_back(merged);
-            const int merged_idx = static_cast<int>(graph.nodes.size()) - 1;
+            const int merged_idx = add_node(graph, merged);
 
             for (const auto& rw : reconnectable) {
-                const int k = rw.first;
-                const float merged_weight = rw.second;
-                // Keep graph effectively undirected by reconnecting both directions.
-                add_or_strengthen_edge(graph, merged_idx, k, merged_weight);
-                add_or_strengthen_edge(graph, k, merged_idx, merged_weight);
+                add_or_strengthen_link(graph, merged_idx, rw.first, rw.second, config);
+            }
+            for (const FusionNeighbor& nb : neighbors) {
+                reconnected[nb.k] = 1;
             }
 
-            graph.nodes[i].is_dead = true;
-            graph.nodes[j].is_dead = true;
-            return true;
+            kill_node(graph, i);
+            kill_node(graph, j);
+            merged_away[i] = 1;
+            merged_away[j] = 1;
+            ++merges;
+            break;
         }
     }
-    return false;
+    return merges;
 }
 
-// Nearest vector from pos to the closest point ON THE SURFACE of any wall cell.
-// Using rectangle boundary (not cell centre) gives physically accurate distances
-// and prevents 1/r^2 from blowing up when a node sits just outside a wall face.
-static Vec2 nearest_wall_vec(const Maze& maze, const Vec2& pos) {
-    int cx = static_cast<int>(pos.x);
-    int cy = static_cast<int>(pos.y);
-
-    float best_dist2 = std::numeric_limits<float>::max();
-    Vec2  best_vec   = {0.0f, 0.0f};
-
-    const int R = 6;  // search radius in cells
-    for (int dy = -R; dy <= R; ++dy) {
-        for (int dx = -R; dx <= R; ++dx) {
-            int gx = cx + dx;
-            int gy = cy + dy;
-
-            bool  wall;
-            float cell_x0, cell_y0, cell_x1, cell_y1;
-            if (gx < 0 || gy < 0 || gx >= maze.width || gy >= maze.height) {
-                // Treat out-of-bounds as wall; clamp cell to grid boundary
-                int bx  = std::max(0, std::min(gx, maze.width  - 1));
-                int by  = std::max(0, std::min(gy, maze.height - 1));
-                cell_x0 = static_cast<float>(bx);
-                cell_y0 = static_cast<float>(by);
-                cell_x1 = cell_x0 + 1.0f;
-                cell_y1 = cell_y0 + 1.0f;
-                wall    = true;
-            } else {
-                wall    = (maze.grid[gy][gx] == 1);
-                cell_x0 = static_cast<float>(gx);
-                cell_y0 = static_cast<float>(gy);
-                cell_x1 = cell_x0 + 1.0f;
-                cell_y1 = cell_y0 + 1.0f;
-            }
-
-            if (!wall) continue;
-
-            // Nearest point on the wall cell's AABB to pos
-            float nx = clamp(pos.x, cell_x0, cell_x1);
-            float ny = clamp(pos.y, cell_y0, cell_y1);
-            float d2 = (pos.x - nx) * (pos.x - nx) + (pos.y - ny) * (pos.y - ny);
-
-            if (d2 < best_dist2) {
-                best_dist2 = d2;
-                best_vec   = {nx - pos.x, ny - pos.y};  // node -> wall surface
-            }
-        }
+// Nearest vector from pos to the closest wall surface: O(1) lookup in the
+// maze's precomputed field when available, exact cell scan otherwise.
+static Vec2 nearest_wall_vec(const Maze& maze, const Vec2& pos, const SimConfig& config) {
+    if (config.WALL_FIELD_ENABLE && maze.wall_field) {
+        return wall_field_vec(*maze.wall_field, maze, pos);
     }
-    return best_vec;
+    return nearest_wall_vec_exact(maze, pos);
 }
 
 // ---------------------------------------------------------------------------
@@ -516,10 +526,12 @@ static Vec2 nearest_wall_vec(const Maze& maze, const Vec2& pos) {
 // ---------------------------------------------------------------------------
 
 std::array<float, node_nn::INPUT_SIZE> compute_inputs(
-    const Graph& graph,
-    int          node_idx,
-    const Vec2&  target,
-    const Maze&  maze)
+    const Graph&        graph,
+    int                 node_idx,
+    const Vec2&         target,
+    const Maze&         maze,
+    const SimConfig&    config,
+    const SpatialIndex* index)
 {
     std::array<float, node_nn::INPUT_SIZE> inp{};
 
@@ -532,12 +544,12 @@ std::array<float, node_nn::INPUT_SIZE> compute_inputs(
     // R_MIN prevents divergence and should match the safety margin used in raycasting.
     // Magnitude is also clamped to prevent exceeding INPUT_CLAMP before normalization.
     // R_MIN is now loaded from config
-    Vec2  v_wall = nearest_wall_vec(maze, node.pos);
-    float r      = std::max(vec2_length(v_wall), R_MIN);
+    Vec2  v_wall = nearest_wall_vec(maze, node.pos, config);
+    float r      = std::max(vec2_length(v_wall), config.R_MIN);
     {
         float inv_r = 1.0f / r;
-        float mag   = WALL_PRESSURE_COEFF * inv_r * inv_r;  // COEFF / r^2
-        mag = std::min(mag, INPUT_CLAMP);  // clamp magnitude to prevent overflow
+        float mag   = config.WALL_PRESSURE_COEFF * inv_r * inv_r;  // COEFF / r^2
+        mag = std::min(mag, config.INPUT_CLAMP);  // clamp magnitude to prevent overflow
         inp[0] = -v_wall.x * inv_r * mag;  // away from wall
         inp[1] = -v_wall.y * inv_r * mag;
     }
@@ -546,17 +558,25 @@ std::array<float, node_nn::INPUT_SIZE> compute_inputs(
     float best_d2 = std::numeric_limits<float>::max();
     Vec2 nearest_vec = {0.0f, 0.0f};
 
-    for (int i = 0; i < static_cast<int>(graph.nodes.size()); ++i) {
-        if (i == node_idx) continue;
-        const Node& cand = graph.nodes[i];
-        if (cand.is_dead) continue;
-
-        const float dx = cand.pos.x - node.pos.x;
-        const float dy = cand.pos.y - node.pos.y;
-        const float d2 = dx * dx + dy * dy;
-        if (d2 < best_d2) {
-            best_d2 = d2;
-            nearest_vec = {dx, dy};
+    if (index) {
+        const int nearest_idx = index->nearest(graph, node.pos, node_idx, best_d2);
+        if (nearest_idx >= 0) {
+            nearest_vec = {graph.nodes[nearest_idx].pos.x - node.pos.x,
+                           graph.nodes[nearest_idx].pos.y - node.pos.y};
+        }
+    } else {
+        for (int i = 0; i < static_cast<int>(graph.nodes.size()); ++i) {
+            if (i == node_idx) continue;
+            const Node& cand = graph.nodes[i];
+            if (cand.is_dead) continue;
+
+            const float dx = cand.pos.x - node.pos.x;
+            const float dy = cand.pos.y - node.pos.y;
+            const float d2 = dx * dx + dy * dy;
+            if (d2 < best_d2) {
+                best_d2 = d2;
+                nearest_vec = {dx, dy};
+            }
         }
     }
 
@@ -571,40 +591,30 @@ std::array<float, node_nn::INPUT_SIZE> compute_inputs(
     // flow vector = sum(direction_to_j * net(j->i))
     Vec2  flow = {0.0f, 0.0f};
     float weight_sum = 0.0f;
-    const float beta = clamp(ENERGY_DIFFUSION_ALPHA, 0.0f, 1.0f);
-
-    for (const Edge& e : node.edges) {
-        if (e.weight <= 0.0f) continue;
-        if (e.target_node_idx < 0 ||
-            e.target_node_idx >= static_cast<int>(graph.nodes.size()))
-            continue;
-        if (graph.nodes[e.target_node_idx].is_dead) continue;
-        weight_sum += e.weight;
+    const float beta = clamp(config.ENERGY_DIFFUSION_ALPHA, 0.0f, 1.0f);
+
+    for (int l : node.links) {
+        const Link& link = graph.links[l];
+        if (link_out_weight(link, node_idx) <= 0.0f) continue;
+        if (graph.nodes[link_other(link, node_idx)].is_dead) continue;
+        weight_sum += link_out_weight(link, node_idx);
     }
 
-    for (const Edge& e : node.edges) {
-        if (e.weight <= 0.0f) continue;
-        if (e.target_node_idx < 0 ||
-            e.target_node_idx >= static_cast<int>(graph.nodes.size()))
-            continue;
+    for (int l : node.links) {
+        const Link& link = graph.links[l];
+        const float w_out = link_out_weight(link, node_idx);
+        if (w_out <= 0.0f) continue;
 
-        const Node& nbr = graph.nodes[e.target_node_idx];
+        const Node& nbr = graph.nodes[link_other(link, node_idx)];
         if (nbr.is_dead) continue;
 
         Vec2 edge_vec = {nbr.pos.x - node.pos.x, nbr.pos.y - node.pos.y};
         Vec2 edge_dir = vec2_normalize(edge_vec);
 
-        float reverse_weight = 0.0f;
-        for (const Edge& ej : nbr.edges) {
-            if (ej.target_node_idx == node_idx && ej.weight > 0.0f) {
-                reverse_weight = ej.weight;
-                break;
-            }
-        }
-
-        const float w_ij = (reverse_weight > 0.0f)
-            ? (0.5f * (e.weight + reverse_weight))
-            : e.weight;
+        const float w_in = link_in_weight(link, node_idx);
+        const float w_ij = (w_in > 0.0f)
+            ? (0.5f * (w_out + w_in))
+            : w_out;
 
         const float net_from_j = beta * w_ij * (nbr.energy - node.energy);
         flow.x += edge_dir.x * net_from_j;
@@ -615,73 +625,131 @@ std::array<float, node_nn::INPUT_SIZE> compute_inputs(
     inp[5] = flow.y;
 
     // ---- I[6]: Importance (edge weight sum or energy) --------------------
-    inp[6] = ENERGY_USE_AS_IMPORTANCE ? (node.energy * ENERGY_IMPORTANCE_SCALE) : weight_sum;
+    inp[6] = config.ENERGY_USE_AS_IMPORTANCE ? (node.energy * config.ENERGY_IMPORTANCE_SCALE) : weight_sum;
 
     // ---- I[7]: Crowdedness (neighbours within CROWD_RADIUS) --------------
     float crowd = 0.0f;
-    for (int i = 0; i < static_cast<int>(graph.nodes.size()); ++i) {
-        if (i == node_idx) continue;
-        if (graph.nodes[i].is_dead) continue;
-        float dx = graph.nodes[i].pos.x - node.pos.x;
-        float dy = graph.nodes[i].pos.y - node.pos.y;
-        if (dx * dx + dy * dy < CROWD_RADIUS * CROWD_RADIUS)
-            crowd += 1.0f;
+    if (index) {
+        crowd = static_cast<float>(
+            index->count_within(graph, node.pos, node_idx, config.CROWD_RADIUS * config.CROWD_RADIUS));
+    } else {
+        for (int i = 0; i < static_cast<int>(graph.nodes.size()); ++i) {
+            if (i == node_idx) continue;
+            if (graph.nodes[i].is_dead) continue;
+            float dx = graph.nodes[i].pos.x - node.pos.x;
+            float dy = graph.nodes[i].pos.y - node.pos.y;
+            if (dx * dx + dy * dy < config.CROWD_RADIUS * config.CROWD_RADIUS)
+                crowd += 1.0f;
+        }
     }
     inp[7] = crowd;
 
     // ---- Clamp all inputs ------------------------------------------------
     for (float& v : inp)
-        v = clamp(v, -INPUT_CLAMP, INPUT_CLAMP);
+        v = clamp(v, -config.INPUT_CLAMP, config.INPUT_CLAMP);
 
     return inp;
 }
 
+std::array<float, node_nn::INPUT_SIZE> compute_inputs(
+    const Graph&        graph,
+    int                 node_idx,
+    const Vec2&         target,
+    const Maze&         maze,
+    const SpatialIndex* index)
+{
+    return compute_inputs(graph, node_idx, target, maze, global_config, index);
+}
+
 // ---------------------------------------------------------------------------
-// apply_vibe
+// apply_vibe: intent stage + merge
+//
+// plan_vibe reads the graph and records everything node `node_idx` does this
+// step -- prune and thicken deltas on its own out-weights, one connect or
+// sprout, its new position -- without writing anything, so nodes can be
+// planned concurrently. apply_intent performs the records. Planning tracks the
+// node's own effects in order (pruned weights, energy spent, the edge it is
+// about to create), so planning and applying against the current graph is the
+// in-place update step() has always done.
+//
+// Intents planned from an older snapshot (STEP_SYNC_UPDATE) are merged in node
+// order and re-checked against what earlier merges changed: connects and moves
+// against neighbours that have since moved, and sprouts landing within
+// SNAP_RADIUS of a node sprouted earlier in the merge, which connect to that
+// node instead.
 // ---------------------------------------------------------------------------
 
-void apply_vibe(
-    Graph&                                         graph,
+using VibeIntent = StepWorkspace::VibeIntent;
+
+static void plan_vibe(
+    const Graph&                                   graph,
     int                                            node_idx,
     const std::array<float, node_nn::OUTPUT_SIZE>& output,
-    const Maze&                                    maze)
+    const Maze&                                    maze,
+    const SimConfig&                               config,
+    const SpatialIndex*                            index,
+    VibeIntent&                                    intent)
 {
-    Node& node = graph.nodes[node_idx];
+    const Node& node = graph.nodes[node_idx];
+    const int degree = static_cast<int>(node.links.size());
+
+    intent.node = node_idx;
+    intent.prune.clear();
+    intent.mark_dead = false;
+    intent.thicken.clear();
+    intent.grow = VibeIntent::NONE;
+    intent.move = false;
+    intent.debug_log.clear();
+
+    // DEBUG_GROW messages are kept with the intent and printed by apply_intent,
+    // so planning on pool workers still prints in node order.
+    std::optional<std::ostringstream> grow_log;
+    if (config.DEBUG_GROW) grow_log.emplace();
+
+    // The node's out-weights and energy as its own records leave them, plus
+    // the edge a connect/sprout adds, for the shift's wall checks.
+    std::vector<float>& w_out = intent.out_weights;
+    w_out.clear();
+    for (int l : node.links) w_out.push_back(link_out_weight(graph.links[l], node_idx));
+    float energy = node.energy;
+    bool  has_new_edge = false;
+    Vec2  new_edge_end = {0.0f, 0.0f};
 
     // ---- B. Prune ---------------------------------------------------------
     Vec2 V_prune = {output[2], output[3]};
     float prune_len = vec2_length(V_prune);
     if (prune_len > 1.0e-6f) {
         Vec2 V_prune_n = vec2_normalize(V_prune);
-        for (Edge& e : node.edges) {
-            if (e.target_node_idx < 0 ||
-                e.target_node_idx >= static_cast<int>(graph.nodes.size()))
-                continue;
-            const Node& tgt = graph.nodes[e.target_node_idx];
+        for (int j = 0; j < degree; ++j) {
+            const Link& link = graph.links[node.links[j]];
+            const Node& tgt = graph.nodes[link_other(link, node_idx)];
             Vec2 ev = {tgt.pos.x - node.pos.x, tgt.pos.y - node.pos.y};
             Vec2 ev_n = vec2_normalize(ev);
             float dot_val = vec2_dot(ev_n, V_prune_n);
             if (dot_val > 0.0f && !tgt.is_source) {
                 float reduction = prune_len *
-                    std::pow(dot_val, PRUNE_EXPONENT);
-                e.weight -= reduction;
+                    std::pow(dot_val, config.PRUNE_EXPONENT);
+                w_out[j] -= reduction;
+                intent.prune.push_back({node.links[j], reduction});
             }
         }
-        // Mark edges below threshold for removal
-        for (Edge& e : node.edges)
-            if (e.weight < THRESHOLD_DEAD_EDGE)
-                e.weight = -1.0f;  // sentinel: removed during cleanup
+        // Mark outgoing directions below threshold for removal
+        for (float& w : w_out) {
+            if (w < config.THRESHOLD_DEAD_EDGE)
+                w = -1.0f;  // sentinel: removed during cleanup
+        }
+        intent.mark_dead = true;
     }
 
     // ---- C. Grow & Sprout -------------------------------------------------
-    Vec2 V_grow = {output[0] * GROW_MULTIPLIER,
-                   output[1] * GROW_MULTIPLIER};
+    Vec2 V_grow = {output[0] * config.GROW_MULTIPLIER,
+                   output[1] * config.GROW_MULTIPLIER};
     float grow_len = vec2_length(V_grow);
 
-    if (DEBUG_GROW && grow_len > 0.01f) {
-        std::cout << "[DEBUG] Node " << node_idx << " at (" << node.pos.x << ", " << node.pos.y 
+    if (config.DEBUG_GROW && grow_len > 0.01f) {
+        *grow_log << "[DEBUG] Node " << node_idx << " at (" << node.pos.x << ", " << node.pos.y 
                   << ") - Grow output: (" << output[0] << ", " << output[1] 
-                  << ") -> len=" << grow_len << " (threshold=" << THRESHOLD_SPROUT << ")\n";
+                  << ") -> len=" << grow_len << " (threshold=" << config.THRESHOLD_SPROUT << ")\n";
     }
 
     bool snapped = false;
@@ -689,29 +757,29 @@ void apply_vibe(
         Vec2 V_grow_n = vec2_normalize(V_grow);
 
         // C1. Angle-snap: reinforce existing edges close in direction
-        for (Edge& e : node.edges) {
-            if (e.weight < 0.0f) continue;  // already marked dead
-            if (e.target_node_idx < 0 ||
-                e.target_node_idx >= static_cast<int>(graph.nodes.size()))
-                continue;
-            const Node& tgt = graph.nodes[e.target_node_idx];
+        for (int j = 0; j < degree; ++j) {
+            const Link& link = graph.links[node.links[j]];
+            float& w = w_out[j];
+            if (w < 0.0f) continue;  // already marked dead
+            const Node& tgt = graph.nodes[link_other(link, node_idx)];
             Vec2 ev   = {tgt.pos.x - node.pos.x, tgt.pos.y - node.pos.y};
             Vec2 ev_n = vec2_normalize(ev);
             float cos_theta = vec2_dot(ev_n, V_grow_n);
-            if (cos_theta > SNAP_ANGLE_COS) {
+            if (cos_theta > config.SNAP_ANGLE_COS) {
                 const float desired_delta = grow_len * cos_theta;
                 float applied_delta = desired_delta;
-                if (ENERGY_COST_EDGE_THICKEN > 1.0e-6f) {
-                    const float affordable = std::max(0.0f, node.energy) / ENERGY_COST_EDGE_THICKEN;
+                if (config.ENERGY_COST_EDGE_THICKEN > 1.0e-6f) {
+                    const float affordable = std::max(0.0f, energy) / config.ENERGY_COST_EDGE_THICKEN;
                     applied_delta = std::min(desired_delta, affordable);
                 }
 
                 if (applied_delta > 1.0e-6f) {
-                    e.weight = clamp_edge_weight(e.weight + applied_delta);
-                    node.energy -= applied_delta * ENERGY_COST_EDGE_THICKEN;
+                    w = clamp_edge_weight(w + applied_delta, config);
+                    energy -= applied_delta * config.ENERGY_COST_EDGE_THICKEN;
+                    intent.thicken.push_back({node.links[j], applied_delta});
                     snapped = true;
-                    if (DEBUG_GROW) {
-                        std::cout << "[DEBUG]   -> Angle-snapped to edge " << e.target_node_idx
+                    if (config.DEBUG_GROW) {
+                        *grow_log << "[DEBUG]   -> Angle-snapped to edge " << link_other(link, node_idx)
                                   << " (cos=" << cos_theta << ", weight+=" << applied_delta << ")\n";
                     }
                 }
@@ -719,19 +787,19 @@ void apply_vibe(
         }
 
         // C2. Spatial-snap / sprout if no angle match and grow is strong enough
-        if (!snapped && grow_len > THRESHOLD_SPROUT) {
-            if (DEBUG_GROW) {
-                std::cout << "[DEBUG]   -> Attempting sprout (no angle snap, grow_len > threshold)\n";
+        if (!snapped && grow_len > config.THRESHOLD_SPROUT) {
+            if (config.DEBUG_GROW) {
+                *grow_log << "[DEBUG]   -> Attempting sprout (no angle snap, grow_len > threshold)\n";
             }
             
             Vec2 P_target = {node.pos.x + V_grow.x,
                             node.pos.y + V_grow.y};
 
             // Raycast to find the furthest valid position (stops at walls)
-            Vec2 P_new = raycast_to_wall(maze, node.pos, P_target);
+            Vec2 P_new = raycast_to_wall(maze, node.pos, P_target, config);
             
-            if (DEBUG_GROW) {
-                std::cout << "[DEBUG]   -> Raycast: target (" << P_target.x << ", " << P_target.y 
+            if (config.DEBUG_GROW) {
+                *grow_log << "[DEBUG]   -> Raycast: target (" << P_target.x << ", " << P_target.y 
                           << ") -> safe (" << P_new.x << ", " << P_new.y << ")\n";
             }
             
@@ -740,23 +808,27 @@ void apply_vibe(
             float dy_moved = P_new.y - node.pos.y;
             float dist_moved = std::sqrt(dx_moved * dx_moved + dy_moved * dy_moved);
             
-            if (DEBUG_GROW) {
-                std::cout << "[DEBUG]   -> Dist moved: " << dist_moved << " (min threshold: " << MIN_SPROUT_DISTANCE << ")\n";
+            if (config.DEBUG_GROW) {
+                *grow_log << "[DEBUG]   -> Dist moved: " << dist_moved << " (min threshold: " << config.MIN_SPROUT_DISTANCE << ")\n";
             }
             
-            if (dist_moved >= MIN_SPROUT_DISTANCE) {  // >= to include boundary value
+            if (dist_moved >= config.MIN_SPROUT_DISTANCE) {  // >= to include boundary value
                 // Check for existing nodes within SNAP_RADIUS
                 int nearest_idx = -1;
-                float nearest_d2 = SNAP_RADIUS * SNAP_RADIUS;
-                for (int i = 0; i < static_cast<int>(graph.nodes.size()); ++i) {
-                    if (i == node_idx) continue;
-                    if (graph.nodes[i].is_dead) continue;
-                    float dx = graph.nodes[i].pos.x - P_new.x;
-                    float dy = graph.nodes[i].pos.y - P_new.y;
-                    float d2 = dx * dx + dy * dy;
-                    if (d2 < nearest_d2) {
-                        nearest_d2 = d2;
-                        nearest_idx = i;
+                float nearest_d2 = config.SNAP_RADIUS * config.SNAP_RADIUS;
+                if (index) {
+                    nearest_idx = index->nearest(graph, P_new, node_idx, nearest_d2);
+                } else {
+                    for (int i = 0; i < static_cast<int>(graph.nodes.size()); ++i) {
+                        if (i == node_idx) continue;
+                        if (graph.nodes[i].is_dead) continue;
+                        float dx = graph.nodes[i].pos.x - P_new.x;
+                        float dy = graph.nodes[i].pos.y - P_new.y;
+                        float d2 = dx * dx + dy * dy;
+                        if (d2 < nearest_d2) {
+                            nearest_d2 = d2;
+                            nearest_idx = i;
+                        }
                     }
                 }
 
@@ -764,58 +836,77 @@ void apply_vibe(
                     // Anastomosis: connect to existing nearby node (bidirectional)
                     // But first check if the edge would cross through walls
                     const Vec2& target_pos = graph.nodes[nearest_idx].pos;
-                    if (!edge_crosses_wall(maze, node.pos, target_pos) &&
-                        node.energy >= ENERGY_COST_NEW_CONNECTION) {
+                    if (!edge_crosses_wall(maze, node.pos, target_pos, config) &&
+                        energy >= config.ENERGY_COST_NEW_CONNECTION) {
                         // Edge is valid - strengthen or create it
-                        add_or_strengthen_edge(graph, node_idx, nearest_idx, INITIAL_WEIGHT);
-                        add_or_strengthen_edge(graph, nearest_idx, node_idx, INITIAL_WEIGHT);
-                        node.energy -= ENERGY_COST_NEW_CONNECTION;
-                        if (DEBUG_GROW) {
-                            std::cout << "[DEBUG]   -> Anastomosis to node " << nearest_idx << "\n";
+                        intent.grow = VibeIntent::CONNECT;
+                        intent.connect_to = nearest_idx;
+                        energy -= config.ENERGY_COST_NEW_CONNECTION;
+                        int existing = -1;
+                        for (int j = 0; j < degree && existing < 0; ++j) {
+                            if (link_other(graph.links[node.links[j]], node_idx) == nearest_idx)
+                                existing = j;
+                        }
+                        if (existing >= 0) {
+                            w_out[existing] = clamp_edge_weight(w_out[existing] + config.INITIAL_WEIGHT, config);
+                        } else if (clamp_edge_weight(config.INITIAL_WEIGHT, config) >= 0.0f) {
+                            has_new_edge = true;
+                            new_edge_end = target_pos;
                         }
-                    } else if (DEBUG_GROW) {
-                        std::cout << "[DEBUG]   -> Anastomosis blocked (edge crosses wall)\n";
+                        if (config.DEBUG_GROW) {
+                            *grow_log << "[DEBUG]   -> Anastomosis to node " << nearest_idx << "\n";
+                        }
+                    } else if (config.DEBUG_GROW) {
+                        *grow_log << "[DEBUG]   -> Anastomosis blocked (edge crosses wall)\n";
                     }
                 } else {
                     // Sprout: create a brand-new node (bidirectional connection)
-                    const float sprout_energy_cost = ENERGY_COST_SPROUT + ENERGY_CHILD_INITIAL + ENERGY_COST_NEW_CONNECTION;
-                    if (node.energy < sprout_energy_cost) {
-                        if (DEBUG_GROW) {
-                            std::cout << "[DEBUG]   -> Sprout blocked (insufficient energy)\n";
+                    const float sprout_energy_cost = config.ENERGY_COST_SPROUT + config.ENERGY_CHILD_INITIAL + config.ENERGY_COST_NEW_CONNECTION;
+                    if (energy < sprout_energy_cost) {
+                        if (config.DEBUG_GROW) {
+                            *grow_log << "[DEBUG]   -> Sprout blocked (insufficient energy)\n";
                         }
                     } else {
-                        Node new_node;
-                        new_node.pos     = P_new;
-                        new_node.is_dead = false;
-                        new_node.is_pinned = false;
-                        new_node.is_source = false;
-                        new_node.energy = ENERGY_CHILD_INITIAL;
-                        graph.nodes.push_back(new_node);
-                        int new_idx = static_cast<int>(graph.nodes.size()) - 1;
-                        // Note: node reference is now invalid (vector may have reallocated)
-                        // Create bidirectional edges (new node has no edges yet, so just add)
-                        add_or_strengthen_edge(graph, node_idx, new_idx, INITIAL_WEIGHT);
-                        add_or_strengthen_edge(graph, new_idx, node_idx, INITIAL_WEIGHT);
-                        graph.nodes[node_idx].energy -= sprout_energy_cost;
-                        if (DEBUG_GROW) {
-                            std::cout << "[DEBUG]   -> NEW NODE created at (" << P_new.x << ", " << P_new.y 
-                                      << "), idx=" << new_idx << "\n";
+                        intent.grow = VibeIntent::SPROUT;
+                        intent.sprout_pos = P_new;
+                        energy -= sprout_energy_cost;
+                        if (clamp_edge_weight(config.INITIAL_WEIGHT, config) >= 0.0f) {
+                            has_new_edge = true;
+                            new_edge_end = P_new;
                         }
                     }
                 }
-            } else if (DEBUG_GROW) {
-                std::cout << "[DEBUG]   -> Sprout blocked (dist_moved too small)\n";
+            } else if (config.DEBUG_GROW) {
+                *grow_log << "[DEBUG]   -> Sprout blocked (dist_moved too small)\n";
             }
-        } else if (DEBUG_GROW && !snapped) {
-            std::cout << "[DEBUG]   -> No sprout (grow_len " << grow_len << " <= threshold " << THRESHOLD_SPROUT << ")\n";
+        } else if (config.DEBUG_GROW && !snapped) {
+            *grow_log << "[DEBUG]   -> No sprout (grow_len " << grow_len << " <= threshold " << config.THRESHOLD_SPROUT << ")\n";
         }
     }
 
+    if (grow_log) intent.debug_log = grow_log->str();
+
     // ---- D. Shift ---------------------------------------------------------
     if (node.is_pinned) {
         return;
     }
 
+    auto move_to = [&](const Vec2& new_pos) {
+        intent.move = true;
+        intent.move_to = new_pos;
+    };
+
+    // Helper lambda: check if moving to new_pos would cause any edge to cross a wall
+    auto would_edges_cross_wall = [&](const Vec2& new_pos) -> bool {
+        for (int j = 0; j < degree; ++j) {
+            if (w_out[j] < 0.0f) continue;  // skip dead edges
+            const Vec2& target_pos = graph.nodes[link_other(graph.links[node.links[j]], node_idx)].pos;
+            if (edge_crosses_wall(maze, new_pos, target_pos, config))
+                return true;
+        }
+        return has_new_edge && edge_crosses_wall(maze, new_pos, new_edge_end, config);
+    };
+
     // Wall-slide: try full movement first, then X-only / Y-only fallbacks so
     // a node moving diagonally toward a wall slides along it rather than stopping.
     // Use raycast to prevent nodes from moving into or too close to walls.
@@ -824,39 +915,24 @@ void apply_vibe(
     // ANTI-STUCK: if too close to a wall, force movement away from it.
     
     // Get wall pressure for this node
-    Vec2 v_wall = nearest_wall_vec(maze, graph.nodes[node_idx].pos);
+    const Vec2& cur = node.pos;
+    Vec2 v_wall = nearest_wall_vec(maze, cur, config);
     float r = vec2_length(v_wall);
     
     // Check if stuck to wall (too close)
-    if (r < WALL_STUCK_THRESHOLD) {
+    if (r < config.WALL_STUCK_THRESHOLD) {
         // Force movement away from wall, ignoring NN output
         Vec2 escape_dir = vec2_normalize({-v_wall.x, -v_wall.y});
         Vec2 escape_pos = {
-            graph.nodes[node_idx].pos.x + escape_dir.x * WALL_UNSTUCK_FORCE,
-            graph.nodes[node_idx].pos.y + escape_dir.y * WALL_UNSTUCK_FORCE
+            cur.x + escape_dir.x * config.WALL_UNSTUCK_FORCE,
+            cur.y + escape_dir.y * config.WALL_UNSTUCK_FORCE
         };
         
-        // Validate escape position (must not be in wall)
-        if (!is_wall(maze, escape_pos.x, escape_pos.y)) {
-            // Also check edges won't cross walls
-            bool edges_ok = true;
-            const Node& n = graph.nodes[node_idx];
-            for (const Edge& e : n.edges) {
-                if (e.weight < 0.0f) continue;
-                if (e.target_node_idx < 0 ||
-                    e.target_node_idx >= static_cast<int>(graph.nodes.size()))
-                    continue;
-                const Vec2& target_pos = graph.nodes[e.target_node_idx].pos;
-                if (edge_crosses_wall(maze, escape_pos, target_pos)) {
-                    edges_ok = false;
-                    break;
-                }
-            }
-            
-            if (edges_ok) {
-                graph.nodes[node_idx].pos = escape_pos;
-                return;  // Skip normal shift logic
-            }
+        // Validate escape position (must not be in wall); edges must not cross walls
+        if (!is_wall(maze, escape_pos.x, escape_pos.y) &&
+            !would_edges_cross_wall(escape_pos)) {
+            move_to(escape_pos);
+            return;  // Skip normal shift logic
         }
         // If escape failed, continue to normal shift logic (might help incrementally)
     }
@@ -866,36 +942,20 @@ void apply_vibe(
     Vec2 wall_push = {0.0f, 0.0f};
     {
         float inv_r = 1.0f / r;
-        float mag = WALL_PRESSURE_COEFF * inv_r * inv_r;
-        mag = std::min(mag, INPUT_CLAMP);
+        float mag = config.WALL_PRESSURE_COEFF * inv_r * inv_r;
+        mag = std::min(mag, config.INPUT_CLAMP);
         wall_push.x = -v_wall.x * inv_r * mag;
         wall_push.y = -v_wall.y * inv_r * mag;
     }
     
     // Combine NN output with wall-avoidance heuristic
     Vec2 V_shift = {
-        output[4] * SHIFT_RATE + wall_push.x * WALL_AVOIDANCE_STRENGTH,
-        output[5] * SHIFT_RATE + wall_push.y * WALL_AVOIDANCE_STRENGTH
-    };
-    const Vec2& cur = graph.nodes[node_idx].pos;  // re-fetch (may have reallocated)
-
-    // Helper lambda: check if moving to new_pos would cause any edge to cross a wall
-    auto would_edges_cross_wall = [&](const Vec2& new_pos) -> bool {
-        const Node& n = graph.nodes[node_idx];
-        for (const Edge& e : n.edges) {
-            if (e.weight < 0.0f) continue;  // skip dead edges
-            if (e.target_node_idx < 0 ||
-                e.target_node_idx >= static_cast<int>(graph.nodes.size()))
-                continue;
-            const Vec2& target_pos = graph.nodes[e.target_node_idx].pos;
-            if (edge_crosses_wall(maze, new_pos, target_pos))
-                return true;
-        }
-        return false;
+        output[4] * config.SHIFT_RATE + wall_push.x * config.WALL_AVOIDANCE_STRENGTH,
+        output[5] * config.SHIFT_RATE + wall_push.y * config.WALL_AVOIDANCE_STRENGTH
     };
 
     Vec2 target_pos = {cur.x + V_shift.x, cur.y + V_shift.y};
-    Vec2 safe_pos = raycast_to_wall(maze, cur, target_pos);
+    Vec2 safe_pos = raycast_to_wall(maze, cur, target_pos, config);
     
     // If raycast found a valid position different from current, validate edges
     float dx_move = safe_pos.x - cur.x;
@@ -903,7 +963,7 @@ void apply_vibe(
     if (dx_move * dx_move + dy_move * dy_move > 1.0e-6f) {
         // Only move if no edges would cross walls
         if (!would_edges_cross_wall(safe_pos)) {
-            graph.nodes[node_idx].pos = safe_pos;
+            move_to(safe_pos);
         }
         // else: movement blocked by edge topology, stay put
     } else {
@@ -911,8 +971,8 @@ void apply_vibe(
         Vec2 slide_x = {cur.x + V_shift.x, cur.y};
         Vec2 slide_y = {cur.x, cur.y + V_shift.y};
         
-        Vec2 safe_x = raycast_to_wall(maze, cur, slide_x);
-        Vec2 safe_y = raycast_to_wall(maze, cur, slide_y);
+        Vec2 safe_x = raycast_to_wall(maze, cur, slide_x, config);
+        Vec2 safe_y = raycast_to_wall(maze, cur, slide_y, config);
         
         float dx_x = safe_x.x - cur.x;
         float dy_x = safe_x.y - cur.y;
@@ -927,55 +987,161 @@ void apply_vibe(
         bool can_slide_y = dist_y > 1.0e-6f && !would_edges_cross_wall(safe_y);
         
         if (can_slide_x && (!can_slide_y || dist_x >= dist_y)) {
-            graph.nodes[node_idx].pos = safe_x;
+            move_to(safe_x);
         } else if (can_slide_y) {
-            graph.nodes[node_idx].pos = safe_y;
+            move_to(safe_y);
         }
         // else: fully blocked, don't move
     }
 }
 
-// ---------------------------------------------------------------------------
-// step
-// ---------------------------------------------------------------------------
-
-void step(
-    Graph&                        graph,
-    const node_nn::NeuralNetwork& nn,
-    const Vec2&                   target,
-    const Maze&                   maze)
+// Perform a planned intent. `sprouted` is null when the intent was planned
+// against `graph` as it is now; otherwise it was planned from an earlier
+// snapshot, gets re-checked, and `sprouted` collects the merge's new nodes.
+static void apply_intent(Graph&            graph,
+                         const VibeIntent& intent,
+                         const Maze&       maze,
+                         const SimConfig&  config,
+                         SpatialIndex*     index,
+                         std::vector<int>* sprouted)
 {
-    const int simulation_step = graph.simulation_step;
-    const int n = static_cast<int>(graph.nodes.size());
+    const int node_idx = intent.node;
+    if (!intent.debug_log.empty()) std::cout << intent.debug_log;
 
-    for (int i = 0; i < n; ++i) {
-        if (graph.nodes[i].is_dead) continue;
-        auto input  = compute_inputs(graph, i, target, maze);
-        std::array<float, node_nn::OUTPUT_SIZE> output{};
-        node_nn::forward(nn, input, output);
-        apply_vibe(graph, i, output, maze);
+    if (!intent.prune.empty() || intent.mark_dead || !intent.thicken.empty())
+        touch_node(graph, node_idx);
+    for (const StepWorkspace::LinkDelta& p : intent.prune) {
+        link_out_weight(graph.links[p.link], node_idx) -= p.delta;
+    }
+    if (intent.mark_dead) {
+        for (int l : graph.nodes[node_idx].links) {
+            float& w = link_out_weight(graph.links[l], node_idx);
+            if (w < config.THRESHOLD_DEAD_EDGE)
+                w = -1.0f;
+        }
     }
 
-    // Energy rules (fully local gradient diffusion).
+    for (const StepWorkspace::LinkDelta& t : intent.thicken) {
+        float& w = link_out_weight(graph.links[t.link], node_idx);
+        if (w < 0.0f) continue;
+        w = clamp_edge_weight(w + t.delta, config);
+        graph.nodes[node_idx].energy -= t.delta * config.ENERGY_COST_EDGE_THICKEN;
+    }
+
+    int connect_to = (intent.grow == VibeIntent::CONNECT) ? intent.connect_to : -1;
+    if (intent.grow == VibeIntent::SPROUT) {
+        const Vec2& P_new = intent.sprout_pos;
+        if (sprouted) {
+            // Two snapshot sprouts can land on the same spot; the later one
+            // snaps to the earlier, as it would have in a sequential update.
+            float nearest_d2 = config.SNAP_RADIUS * config.SNAP_RADIUS;
+            for (int s : *sprouted) {
+                const float dx = graph.nodes[s].pos.x - P_new.x;
+                const float dy = graph.nodes[s].pos.y - P_new.y;
+                const float d2 = dx * dx + dy * dy;
+                if (d2 < nearest_d2) {
+                    nearest_d2 = d2;
+                    connect_to = s;
+                }
+            }
+        }
+        if (connect_to < 0) {
+            Node new_node;
+            new_node.pos     = P_new;
+            new_node.is_dead = false;
+            new_node.is_pinned = false;
+            new_node.is_source = false;
+            new_node.energy = config.ENERGY_CHILD_INITIAL;
+            int new_idx = add_node(graph, new_node);
+            if (index) index->insert(new_idx, P_new);
+            // Create the link (new node has no links yet, so just add)
+            add_link(graph, node_idx, new_idx, clamp_edge_weight(config.INITIAL_WEIGHT, config));
+            graph.nodes[node_idx].energy -=
+                config.ENERGY_COST_SPROUT + config.ENERGY_CHILD_INITIAL + config.ENERGY_COST_NEW_CONNECTION;
+            if (sprouted) sprouted->push_back(new_idx);
+            if (config.DEBUG_GROW) {
+                std::cout << "[DEBUG]   -> NEW NODE created at (" << P_new.x << ", " << P_new.y 
+                          << "), idx=" << new_idx << "\n";
+            }
+        }
+    }
+    if (connect_to >= 0) {
+        const Node& node = graph.nodes[node_idx];
+        const bool ok = !sprouted ||
+            (!edge_crosses_wall(maze, node.pos, graph.nodes[connect_to].pos, config) &&
+             node.energy >= config.ENERGY_COST_NEW_CONNECTION);
+        if (ok) {
+            add_or_strengthen_link(graph, node_idx, connect_to, config.INITIAL_WEIGHT, config);
+            graph.nodes[node_idx].energy -= config.ENERGY_COST_NEW_CONNECTION;
+        }
+    }
+
+    if (!intent.move) return;
+    if (sprouted) {
+        for (int l : graph.nodes[node_idx].links) {
+            const Link& link = graph.links[l];
+            if (link_out_weight(link, node_idx) < 0.0f) continue;
+            if (edge_crosses_wall(maze, intent.move_to, graph.nodes[link_other(link, node_idx)].pos, config))
+                return;  // a neighbour moved in the meantime
+        }
+    }
+    // Position writes go through here so the spatial index stays valid.
+    if (index) index->move(node_idx, graph.nodes[node_idx].pos, intent.move_to);
+    graph.nodes[node_idx].pos = intent.move_to;
+    touch_node(graph, node_idx);
+}
+
+void apply_vibe(
+    Graph&                                         graph,
+    int                                            node_idx,
+    const std::array<float, node_nn::OUTPUT_SIZE>& output,
+    const Maze&                                    maze,
+    const SimConfig&                               config,
+    SpatialIndex*                                  index)
+{
+    VibeIntent intent;
+    plan_vibe(graph, node_idx, output, maze, config, index, intent);
+    apply_intent(graph, intent, maze, config, index, nullptr);
+}
+
+void apply_vibe(
+    Graph&                                         graph,
+    int                                            node_idx,
+    const std::array<float, node_nn::OUTPUT_SIZE>& output,
+    const Maze&                                    maze,
+    SpatialIndex*                                  index)
+{
+    apply_vibe(graph, node_idx, output, maze, global_config, index);
+}
+
+// ---------------------------------------------------------------------------
+// Energy rules (reference implementation over Graph; see graph_soa.cpp)
+// ---------------------------------------------------------------------------
+
+void apply_energy_rules(Graph& graph, const Vec2& target, const SimConfig& config,
+                        StepWorkspace* workspace) {
+    StepWorkspace local;
+    StepWorkspace& ws = workspace ? *workspace : local;
+
+    const int simulation_step = graph.simulation_step;
     const int m = static_cast<int>(graph.nodes.size());
-    std::vector<float> old_energy(static_cast<size_t>(m), 0.0f);
+    std::vector<float>& old_energy = ws.old_energy;
+    old_energy.resize(static_cast<size_t>(m));
     for (int i = 0; i < m; ++i) {
         old_energy[i] = graph.nodes[i].energy;
     }
 
-    const float beta = clamp(ENERGY_DIFFUSION_ALPHA, 0.0f, 1.0f);
-    const float outflow_cap_ratio = clamp(ENERGY_FLOW_GAIN, 0.0f, 1.0f);
-    std::vector<float> next_energy = old_energy;
-
-    struct PairFlux {
-        int i;
-        int j;
-        float flux_i_to_j;
-    };
+    const float beta = clamp(config.ENERGY_DIFFUSION_ALPHA, 0.0f, 1.0f);
+    const float outflow_cap_ratio = clamp(config.ENERGY_FLOW_GAIN, 0.0f, 1.0f);
+    std::vector<float>& next_energy = ws.next_energy;
+    next_energy.assign(old_energy.begin(), old_energy.end());
 
-    std::vector<PairFlux> pair_fluxes;
+    using PairFlux = StepWorkspace::PairFlux;
+    std::vector<PairFlux>& pair_fluxes = ws.pair_fluxes;
+    pair_fluxes.clear();
     pair_fluxes.reserve(static_cast<size_t>(m * 2));
-    std::vector<float> raw_outflow(static_cast<size_t>(m), 0.0f);
+    std::vector<float>& raw_outflow = ws.raw_outflow;
+    raw_outflow.assign(static_cast<size_t>(m), 0.0f);
 
     // 1) Raw pairwise gradient flux on each undirected edge (i < j):
     //    f(i->j) = beta * w_ij * (E_i - E_j)
@@ -983,25 +1149,20 @@ void step(
     for (int i = 0; i < m; ++i) {
         if (graph.nodes[i].is_dead) continue;
 
-        for (const Edge& e : graph.nodes[i].edges) {
-            if (e.weight <= 0.0f) continue;
+        for (int l : graph.nodes[i].links) {
+            const Link& link = graph.links[l];
+            const float w_out = link_out_weight(link, i);
+            if (w_out <= 0.0f) continue;
 
-            const int j = e.target_node_idx;
+            const int j = link_other(link, i);
             if (j < 0 || j >= m) continue;
             if (j <= i) continue;
             if (graph.nodes[j].is_dead) continue;
 
-            float reverse_weight = 0.0f;
-            for (const Edge& ej : graph.nodes[j].edges) {
-                if (ej.target_node_idx == i && ej.weight > 0.0f) {
-                    reverse_weight = ej.weight;
-                    break;
-                }
-            }
-
-            const float w_ij = (reverse_weight > 0.0f)
-                ? (0.5f * (e.weight + reverse_weight))
-                : e.weight;
+            const float w_in = link_in_weight(link, i);
+            const float w_ij = (w_in > 0.0f)
+                ? (0.5f * (w_out + w_in))
+                : w_out;
 
             const float flux_i_to_j = beta * w_ij * (old_energy[i] - old_energy[j]);
             pair_fluxes.push_back({i, j, flux_i_to_j});
@@ -1018,7 +1179,8 @@ void step(
     //    out_i <= outflow_cap_ratio * E_i
     // This guarantees at least (1 - outflow_cap_ratio) * E_i remains before
     // maintenance/source/clamp stage.
-    std::vector<float> outflow_scale(static_cast<size_t>(m), 1.0f);
+    std::vector<float>& outflow_scale = ws.outflow_scale;
+    outflow_scale.assign(static_cast<size_t>(m), 1.0f);
     for (int i = 0; i < m; ++i) {
         if (graph.nodes[i].is_dead) continue;
         const float cap_i = outflow_cap_ratio * std::max(0.0f, old_energy[i]);
@@ -1039,11 +1201,11 @@ void step(
         next_energy[pf.j] += effective_flux;
     }
 
-    const bool enable_energy_apoptosis = simulation_step > static_cast<int>(APOPTOSIS_WARMUP_STEPS);
+    const bool enable_energy_apoptosis = simulation_step > static_cast<int>(config.APOPTOSIS_WARMUP_STEPS);
 
     int goal_source_idx = -1;
     int source_count = 0;
-    if (ENERGY_PULSE_ENABLE) {
+    if (config.ENERGY_PULSE_ENABLE) {
         float best_goal_d2 = std::numeric_limits<float>::max();
         for (int i = 0; i < m; ++i) {
             if (graph.nodes[i].is_dead || !graph.nodes[i].is_source) continue;
@@ -1058,14 +1220,14 @@ void step(
         }
     }
 
-    float source_level_goal = ENERGY_SOURCE_VALUE;
-    float source_level_other = ENERGY_SOURCE_VALUE;
-    if (ENERGY_PULSE_ENABLE && source_count >= 2) {
-        const int period = std::max(1, static_cast<int>(ENERGY_PULSE_PERIOD_STEPS));
-        const float low_ratio = clamp(ENERGY_PULSE_LOW_RATIO, 0.0f, 1.0f);
-        const float high = ENERGY_SOURCE_VALUE;
+    float source_level_goal = config.ENERGY_SOURCE_VALUE;
+    float source_level_other = config.ENERGY_SOURCE_VALUE;
+    if (config.ENERGY_PULSE_ENABLE && source_count >= 2) {
+        const int period = std::max(1, static_cast<int>(config.ENERGY_PULSE_PERIOD_STEPS));
+        const float low_ratio = clamp(config.ENERGY_PULSE_LOW_RATIO, 0.0f, 1.0f);
+        const float high = config.ENERGY_SOURCE_VALUE;
         const float low = high * low_ratio;
-        const float sink = ENERGY_PULSE_SINK_VALUE;
+        const float sink = config.ENERGY_PULSE_SINK_VALUE;
 
         constexpr float PI = 3.14159265358979323846f;
         const float phase = (2.0f * PI * static_cast<float>(simulation_step % period)) /
@@ -1089,23 +1251,24 @@ void step(
         if (graph.nodes[i].is_dead) continue;
 
         float total_weight = 0.0f;
-        for (const Edge& e : graph.nodes[i].edges) {
-            if (e.weight <= 0.0f) continue;
-            total_weight += e.weight;
+        for (int l : graph.nodes[i].links) {
+            const float w = link_out_weight(graph.links[l], i);
+            if (w <= 0.0f) continue;
+            total_weight += w;
         }
 
-        const float maintenance = ENERGY_MAINTENANCE_COST +
-                                  ENERGY_MAINTENANCE_PER_WEIGHT * total_weight;
+        const float maintenance = config.ENERGY_MAINTENANCE_COST +
+                                  config.ENERGY_MAINTENANCE_PER_WEIGHT * total_weight;
         float new_e = next_energy[i] - maintenance;
         if (graph.nodes[i].is_source) {
-            if (ENERGY_PULSE_ENABLE && source_count >= 2 && goal_source_idx >= 0) {
+            if (config.ENERGY_PULSE_ENABLE && source_count >= 2 && goal_source_idx >= 0) {
                 new_e = (i == goal_source_idx) ? source_level_goal : source_level_other;
             } else {
-                new_e = ENERGY_SOURCE_VALUE;
+                new_e = config.ENERGY_SOURCE_VALUE;
             }
         }
 
-        graph.nodes[i].energy = clamp(new_e, ENERGY_MIN_CLAMP, ENERGY_MAX_CLAMP);
+        graph.nodes[i].energy = clamp(new_e, config.ENERGY_MIN_CLAMP, config.ENERGY_MAX_CLAMP);
     }
 
     // 3) Energy-based apoptosis.
@@ -1116,96 +1279,424 @@ void step(
 
         const bool zero_energy_death = (graph.nodes[i].energy <= 0.0f);
         const bool gate_death = enable_energy_apoptosis &&
-                                (graph.nodes[i].energy <= NN_APOPTOSIS_ENERGY_GATE);
+                                (graph.nodes[i].energy <= config.NN_APOPTOSIS_ENERGY_GATE);
         if (!(zero_energy_death || gate_death)) continue;
 
-        graph.nodes[i].is_dead = true;
+        kill_node(graph, i);
 
-        for (Edge& e : graph.nodes[i].edges) {
-            e.weight = -1.0f;
+        // Both directions of each incident link: every link is listed by both
+        // endpoints, so the living neighbours' edges into i are exactly the
+        // other directions of i's own links.
+        for (int l : graph.nodes[i].links) {
+            Link& link = graph.links[l];
+            link_out_weight(link, i) = -1.0f;
+            const int j = link_other(link, i);
+            if (j == i || graph.nodes[j].is_dead) continue;
+            link_out_weight(link, j) = -1.0f;
         }
+    }
+}
 
-        for (int j = 0; j < m; ++j) {
-            if (j == i || graph.nodes[j].is_dead) continue;
-            for (Edge& e : graph.nodes[j].edges) {
-                if (e.target_node_idx == i) {
-                    e.weight = -1.0f;
-                }
+void apply_energy_rules(Graph& graph, const Vec2& target, StepWorkspace* workspace) {
+    apply_energy_rules(graph, target, global_config, workspace);
+}
+
+// ---------------------------------------------------------------------------
+// step
+// ---------------------------------------------------------------------------
+
+// Thread pool for the parallel phases of a step, or nullptr for STEP_THREADS
+// <= 1. Kept in the workspace so threads are created once, not per step.
+static ThreadPool* step_pool(const SimConfig& config, StepWorkspace& ws) {
+    const int threads = std::max(1, static_cast<int>(config.STEP_THREADS));
+    if (threads == 1) return nullptr;
+    if (!ws.pool || ws.pool->thread_count() != threads) {
+        ws.pool = std::make_unique<ThreadPool>(threads);
+    }
+    return ws.pool.get();
+}
+
+// Synchronous update (STEP_SYNC_UPDATE): the inputs, NN outputs and intents
+// of all living nodes are computed from the graph as it is at the start of the
+// step (in parallel over STEP_THREADS threads, the NN batched per tile), then
+// merged in index order.
+// Each intent depends only on that snapshot, so results do not depend on the
+// thread count.
+static void update_synchronous(Graph&                graph,
+                               const node_nn::Model& nn,
+                               const Vec2&           target,
+                               const Maze&           maze,
+                               const SimConfig&      config,
+                               SpatialIndex*         index,
+                               StepWorkspace&        ws) {
+    const int n = static_cast<int>(graph.nodes.size());
+    ws.eval_nodes.clear();
+    for (int i = 0; i < n; ++i) {
+        if (!graph.nodes[i].is_dead) ws.eval_nodes.push_back(i);
+    }
+    const int count = static_cast<int>(ws.eval_nodes.size());
+    ws.intents.resize(static_cast<size_t>(count));
+
+    // The NN runs as one batched pass per tile of nodes (stack buffers, so
+    // no allocation per step).
+    const Graph& snapshot = graph;
+    auto plan = [&](int begin, int end) {
+        constexpr int TILE = 32;
+        float inputs[node_nn::INPUT_SIZE * TILE];
+        float outputs[node_nn::OUTPUT_SIZE * TILE];
+        std::array<float, node_nn::OUTPUT_SIZE> output{};
+        for (int k0 = begin; k0 < end; k0 += TILE) {
+            const int n = std::min(TILE, end - k0);
+            for (int t = 0; t < n; ++t) {
+                const auto input = compute_inputs(snapshot, ws.eval_nodes[k0 + t], target, maze, config, index);
+                for (int j = 0; j < node_nn::INPUT_SIZE; ++j) inputs[j * n + t] = input[j];
+            }
+            node_nn::forward_batch(nn, inputs, outputs, n);
+            for (int t = 0; t < n; ++t) {
+                for (int o = 0; o < node_nn::OUTPUT_SIZE; ++o) output[o] = outputs[o * n + t];
+                plan_vibe(snapshot, ws.eval_nodes[k0 + t], output, maze, config, index, ws.intents[k0 + t]);
             }
         }
+    };
+
+    if (ThreadPool* pool = step_pool(config, ws)) {
+        pool->parallel_for(count, plan);
+    } else {
+        plan(0, count);
     }
 
-    const int max_merges = std::max(0, static_cast<int>(FUSION_MAX_MERGES_PER_STEP));
-    for (int iter = 0; iter < max_merges; ++iter) {
-        if (!merge_one_close_pair(graph, maze, FUSION_DISTANCE)) {
-            break;
+    ws.sprouted.clear();
+    for (int k = 0; k < count; ++k) {
+        apply_intent(graph, ws.intents[k], maze, config, index, &ws.sprouted);
+    }
+}
+
+// The network a step evaluates: `nn` itself, or with NN_FAST_TANH a copy in
+// `fast` that uses the fast activation (the weights are copied, 0.6 KB for
+// the default topology).
+static const node_nn::Model& step_network(const node_nn::Model&          nn,
+                                          const SimConfig&               config,
+                                          std::optional<node_nn::Model>& fast) {
+    if (!config.NN_FAST_TANH || node_nn::model_activation(nn) == node_nn::Activation::FAST_TANH) return nn;
+    fast.emplace(nn);
+    node_nn::set_activation(*fast, node_nn::Activation::FAST_TANH);
+    return *fast;
+}
+
+void step(
+    Graph&                graph,
+    const node_nn::Model& network,
+    const Vec2&           target,
+    const Maze&           maze,
+    const SimConfig&      config,
+    StepWorkspace*        workspace)
+{
+    StepWorkspace local;
+    StepWorkspace& ws = workspace ? *workspace : local;
+    std::optional<node_nn::Model> fast;
+    const node_nn::Model& nn = step_network(network, config, fast);
+
+    const int n = static_cast<int>(graph.nodes.size());
+
+    // Spatial index for the per-node neighbour queries. In the default
+    // sequential mode nodes are evaluated in order and see earlier nodes'
+    // moves/sprouts; apply_intent keeps the index in sync with both.
+    SpatialIndex& index = ws.index;
+    SpatialIndex* index_ptr = nullptr;
+    if (config.USE_SPATIAL_INDEX) {
+        index.rebuild(graph, maze);
+        index_ptr = &index;
+    }
+
+    if (config.STEP_SYNC_UPDATE) {
+        update_synchronous(graph, nn, target, maze, config, index_ptr, ws);
+    } else {
+        for (int i = 0; i < n; ++i) {
+            if (graph.nodes[i].is_dead) continue;
+            auto input  = compute_inputs(graph, i, target, maze, config, index_ptr);
+            std::array<float, node_nn::OUTPUT_SIZE> output{};
+            node_nn::forward(nn, input, output);
+            plan_vibe(graph, i, output, maze, config, index_ptr, ws.intent);
+            apply_intent(graph, ws.intent, maze, config, index_ptr, nullptr);
         }
-        cleanup_dead(graph, maze);
     }
 
-    cleanup_dead(graph, maze);
-    enforce_bidirectional_weight_symmetry(graph);
+    // Energy rules (fully local gradient diffusion).
+    if (config.ENERGY_PARALLEL_KERNEL) {
+        graph_to_soa(graph, ws.soa);
+        soa_apply_energy_rules_parallel(ws.soa, target, config, step_pool(config, ws));
+        soa_write_back_state(ws.soa, graph);
+    } else {
+        apply_energy_rules(graph, target, config, &ws);
+    }
+
+    // Anastomosis: one batch of non-overlapping merges, compacted together
+    // with the dead nodes below.
+    if (!index_ptr) {
+        index.rebuild(graph, maze);
+    }
+    const int max_merges = std::max(0, static_cast<int>(config.FUSION_MAX_MERGES_PER_STEP));
+    fuse_close_pairs(graph, maze, config, ws, config.FUSION_DISTANCE, max_merges);
+
+    cleanup_dead(graph, maze, config, &ws);
     graph.simulation_step += 1;
 }
 
+void step(
+    Graph&                graph,
+    const node_nn::Model& nn,
+    const Vec2&           target,
+    const Maze&           maze,
+    StepWorkspace*        workspace)
+{
+    step(graph, nn, target, maze, global_config, workspace);
+}
+
 // ---------------------------------------------------------------------------
 // cleanup_dead
 // ---------------------------------------------------------------------------
 
-void cleanup_dead(Graph& graph, const Maze& maze) {
-    // First, remove dead-weight edges (weight == -1 sentinel) from all nodes
-    for (Node& node : graph.nodes) {
-        node.edges.erase(
-            std::remove_if(node.edges.begin(), node.edges.end(),
-                           [](const Edge& e) { return e.weight < 0.0f; }),
-            node.edges.end());
-    }
-    
-    // Also remove edges that cross walls (cleanup corrupted topology)
-    for (int i = 0; i < static_cast<int>(graph.nodes.size()); ++i) {
-        Node& node = graph.nodes[i];
-        node.edges.erase(
-            std::remove_if(node.edges.begin(), node.edges.end(),
-                           [&](const Edge& e) {
-                               if (e.target_node_idx < 0 ||
-                                   e.target_node_idx >= static_cast<int>(graph.nodes.size()))
-                                   return true;  // invalid index
-                               const Vec2& p1 = node.pos;
-                               const Vec2& p2 = graph.nodes[e.target_node_idx].pos;
-                               return edge_crosses_wall(maze, p1, p2);
-                           }),
-            node.edges.end());
-    }
+// Fold link `l` into its canonical weight. A direction survives if it carries
+// weight and does not cross a wall from its source end; the link survives if
+// either direction does and both endpoints are alive. Returns false if the
+// link is to be dropped.
+static bool canonicalise_link(Graph& graph, const Maze& maze, const SimConfig& config, int l) {
+    Link& link = graph.links[l];
+    const int n = static_cast<int>(graph.nodes.size());
+    if (link.a < 0 || link.b < 0 || link.a >= n || link.b >= n || link.a == link.b) return false;
+    if (graph.nodes[link.a].is_dead || graph.nodes[link.b].is_dead) return false;
+
+    const Vec2& pa = graph.nodes[link.a].pos;
+    const Vec2& pb = graph.nodes[link.b].pos;
+    const float w_ab = (link.w_ab > 0.0f && !edge_crosses_wall(maze, pa, pb, config)) ? link.w_ab : 0.0f;
+    const float w_ba = (link.w_ba > 0.0f && !edge_crosses_wall(maze, pb, pa, config)) ? link.w_ba : 0.0f;
+    const float w = (w_ab > 0.0f && w_ba > 0.0f)
+        ? (0.5f * (w_ab + w_ba))
+        : std::max(w_ab, w_ba);
+    if (w <= 0.0f) return false;
+
+    link.w_ab = clamp_edge_weight(w, config);
+    link.w_ba = link.w_ab;
+    return true;
+}
+
+// Dense compaction: drop dead nodes and links without `keep` (or with a dead
+// endpoint), renumber both, and clear the free lists. A node moved to another
+// slot gets a new generation.
+static void compact_graph(Graph& graph, const std::vector<char>& keep, StepWorkspace& ws) {
+    const int n = static_cast<int>(graph.nodes.size());
 
-    // Build index remapping: old_idx -> new_idx (-1 if dead)
-    std::vector<int> remap(graph.nodes.size(), -1);
+    // Build node remapping: old_idx -> new_idx (-1 if dead)
+    std::vector<int>& node_remap = ws.node_remap;
+    node_remap.assign(static_cast<size_t>(n), -1);
     int new_idx = 0;
-    for (int i = 0; i < static_cast<int>(graph.nodes.size()); ++i) {
+    for (int i = 0; i < n; ++i) {
         if (!graph.nodes[i].is_dead)
-            remap[i] = new_idx++;
+            node_remap[i] = new_idx++;
     }
 
+    std::vector<int>& link_remap = ws.link_remap;
+    link_remap.assign(graph.links.size(), -1);
+    int new_link = 0;
+    for (int l = 0; l < static_cast<int>(graph.links.size()); ++l) {
+        if (!keep[l]) continue;
+        Link link = graph.links[l];
+        link.a = node_remap[link.a];
+        link.b = node_remap[link.b];
+        if (link.a < 0 || link.b < 0) continue;
+        link_remap[l] = new_link;
+        graph.links[new_link++] = link;
+    }
+    graph.links.resize(static_cast<size_t>(new_link));
+
     // Remove dead nodes
-    graph.nodes.erase(
-        std::remove_if(graph.nodes.begin(), graph.nodes.end(),
-                       [](const Node& n) { return n.is_dead; }),
-        graph.nodes.end());
+    for (int i = 0; i < n; ++i) {
+        const int dst = node_remap[i];
+        if (dst < 0 || dst == i) continue;
+        graph.nodes[dst] = std::move(graph.nodes[i]);
+        graph.nodes[dst].generation = ++graph.last_generation;
+    }
+    graph.nodes.resize(static_cast<size_t>(new_idx));
 
-    // Update all edge indices; drop edges to dead nodes
+    // Renumber each node's link list in place, keeping its order
     for (Node& node : graph.nodes) {
-        std::vector<Edge> valid_edges;
-        for (Edge& e : node.edges) {
-            if (e.target_node_idx >= 0 &&
-                e.target_node_idx < static_cast<int>(remap.size()) &&
-                remap[e.target_node_idx] >= 0)
-            {
-                e.target_node_idx = remap[e.target_node_idx];
-                valid_edges.push_back(e);
+        size_t write = 0;
+        for (int l : node.links) {
+            if (l >= 0 && l < static_cast<int>(link_remap.size()) && link_remap[l] >= 0) {
+                node.links[write++] = link_remap[l];
             }
-            // else: edge to dead/invalid node is discarded
         }
-        node.edges = std::move(valid_edges);
+        node.links.resize(write);
+    }
+
+    graph.free_node_count = 0;
+    graph.free_links.clear();
+}
+
+// Free-list release of the links in `dropped` (ascending) and of the dead
+// nodes among graph.touched_nodes: each dropped link is unlinked from its live
+// endpoints and recycled, each dead node becomes a tombstone. Cost is O(degree)
+// per touched node; nothing else is visited.
+static void release_dead(Graph& graph, const std::vector<int>& dropped) {
+    auto unlink = [&](int node_idx, int l) {
+        LinkList& list = graph.nodes[node_idx].links;
+        auto it = std::find(list.begin(), list.end(), l);
+        if (it != list.end()) list.erase(it);
+    };
+
+    for (int l : dropped) {
+        Link& link = graph.links[l];
+        if (!graph.nodes[link.a].is_dead) unlink(link.a, l);
+        if (!graph.nodes[link.b].is_dead) unlink(link.b, l);
+        link = {-1, -1, 0.0f, 0.0f};
+        graph.free_links.push_back(l);
+    }
+
+    for (int i : graph.touched_nodes) {
+        Node& node = graph.nodes[i];
+        if (!node.is_dead || node.is_free) continue;
+        node.links.clear();  // all dropped above: an endpoint is dead
+        node.is_free = true;
+        node.generation = ++graph.last_generation;
+        graph.free_node_count += 1;
     }
 }
 
+void cleanup_dead(Graph& graph, const Maze& maze, const SimConfig& config,
+                  StepWorkspace* workspace) {
+    StepWorkspace local;
+    StepWorkspace& ws = workspace ? *workspace : local;
+
+    // The links of touched nodes, in index order so free-list release recycles
+    // them in the same order as a scan over all links would.
+    std::vector<int>& dirty = ws.dirty_links;
+    dirty.clear();
+    for (int i : graph.touched_nodes) {
+        graph.nodes[i].is_touched = false;
+        for (int l : graph.nodes[i].links) dirty.push_back(l);
+    }
+    std::sort(dirty.begin(), dirty.end());
+    dirty.erase(std::unique(dirty.begin(), dirty.end()), dirty.end());
+
+    if (!config.NODE_FREE_LIST) {
+        std::vector<char>& keep = ws.keep_link;
+        keep.assign(graph.links.size(), 1);
+        for (int l : dirty) {
+            keep[l] = canonicalise_link(graph, maze, config, l) ? 1 : 0;
+        }
+        graph.touched_nodes.clear();
+        compact_graph(graph, keep, ws);
+        return;
+    }
+
+    // Canonicalise in place, compacting `dirty` down to the dropped links.
+    size_t dropped = 0;
+    for (int l : dirty) {
+        if (!canonicalise_link(graph, maze, config, l)) dirty[dropped++] = l;
+    }
+    dirty.resize(dropped);
+    release_dead(graph, dirty);
+    graph.touched_nodes.clear();
+
+    // Occasional defragmentation once too much of the storage is free slots.
+    const float free_fraction = graph.nodes.empty() ? 0.0f :
+        static_cast<float>(graph.free_node_count) / static_cast<float>(graph.nodes.size());
+    if (free_fraction > config.NODE_DEFRAG_FREE_FRACTION) {
+        std::vector<char>& keep = ws.keep_link;
+        keep.resize(graph.links.size());
+        for (int l = 0; l < static_cast<int>(graph.links.size()); ++l) {
+            keep[l] = (graph.links[l].a >= 0) ? 1 : 0;
+        }
+        compact_graph(graph, keep, ws);
+    }
+}
+
+void cleanup_dead(Graph& graph, const Maze& maze, StepWorkspace* workspace) {
+    cleanup_dead(graph, maze, global_config, workspace);
+}
+
+// ---------------------------------------------------------------------------
+// Trial setup and scoring
+// ---------------------------------------------------------------------------
+
+Graph build_initial_graph(const Maze& maze, const SimConfig& config) {
+    Graph graph;
+
+    const int start_col = 1;
+    const int start_row = 1;
+    const int end_col = maze.width - 2;
+    const int end_row = maze.height - 2;
+
+    std::vector<std::vector<int>> cell_to_node(
+        maze.height,
+        std::vector<int>(maze.width, -1));
+
+    for (int row = 0; row < maze.height; ++row) {
+        for (int col = 0; col < maze.width; ++col) {
+            if (maze.grid[row][col] != 0) continue;
+
+            Node node;
+            node.pos = {cell_cx(col), cell_cy(row)};
+            node.is_dead = false;
+            node.is_source = (col == start_col && row == start_row) ||
+                             (col == end_col && row == end_row);
+            node.is_pinned = node.is_source;
+            node.energy = node.is_source ? config.ENERGY_SOURCE_VALUE : config.ENERGY_INITIAL;
+
+            cell_to_node[row][col] = add_node(graph, node);
+        }
+    }
+
+    auto connect_if_open = [&](int row_a, int col_a, int row_b, int col_b) {
+        if (row_b < 0 || row_b >= maze.height || col_b < 0 || col_b >= maze.width) return;
+
+        int idx_a = cell_to_node[row_a][col_a];
+        int idx_b = cell_to_node[row_b][col_b];
+        if (idx_a < 0 || idx_b < 0) return;
+
+        add_link(graph, idx_a, idx_b, config.INITIAL_WEIGHT);
+    };
+
+    for (int row = 0; row < maze.height; ++row) {
+        for (int col = 0; col < maze.width; ++col) {
+            if (cell_to_node[row][col] < 0) continue;
+            connect_if_open(row, col, row, col + 1);
+            connect_if_open(row, col, row + 1, col);
+        }
+    }
+
+    return graph;
+}
+
+bool sources_connected(const Graph& graph, float min_weight) {
+    const int node_count = static_cast<int>(graph.nodes.size());
+    int src = -1;
+    int dst = -1;
+    for (int i = 0; i < node_count; ++i) {
+        if (graph.nodes[i].is_dead || !graph.nodes[i].is_source) continue;
+        if (src < 0) src = i;
+        dst = i;
+    }
+    if (src < 0 || src == dst) return false;
+
+    std::vector<char> visited(static_cast<size_t>(node_count), 0);
+    std::vector<int> queue = {src};
+    visited[src] = 1;
+    for (size_t head = 0; head < queue.size(); ++head) {
+        const int u = queue[head];
+        if (u == dst) return true;
+
+        for (int l : graph.nodes[u].links) {
+            const Link& link = graph.links[l];
+            if (link_out_weight(link, u) < min_weight) continue;
+            const int v = link_other(link, u);
+            if (v < 0 || v >= node_count) continue;
+            if (graph.nodes[v].is_dead || visited[v]) continue;
+            visited[v] = 1;
+            queue.push_back(v);
+        }
+    }
+    return false;
+}
+
 } // namespace sim
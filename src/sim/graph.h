@@ -1,8 +1,10 @@
 #pragma once
 
-#include "node_nn/nn.h"
+#include "node_nn/model.h"
 #include "config.h"  // Hyperparameters loaded from external file
+#include "small_vector.h"
 #include <array>
+#include <cstdint>
 #include <vector>
 
 namespace sim {
@@ -19,59 +21,231 @@ struct Vec2 {
     float x, y;
 };
 
-struct Edge {
-    int   target_node_idx;  // index into Graph::nodes
-    float weight;           // thickness / strength
+// Undirected link between two nodes, stored once in Graph::links and
+// referenced by index from both endpoints' Node::links.
+//
+// Prune and grow act on one direction during a step, so each direction keeps
+// its own weight; cleanup_dead folds them into one canonical weight
+// (w_ab == w_ba) at the end of every step. A direction with weight < 0 is
+// dead (sentinel -1) and is dropped at cleanup.
+struct Link {
+    int   a;     // endpoint node indices (into Graph::nodes)
+    int   b;
+    float w_ab;  // weight in direction a -> b
+    float w_ba;  // weight in direction b -> a
 };
 
+// A node's link indices. Most nodes have at most 4 links, which are stored
+// inline; higher degrees spill to the heap.
+using LinkList = SmallVector<int, 4>;
+
 struct Node {
     Vec2              pos;
-    std::vector<Edge> edges;
-    bool              is_dead;  // set true -> removed on next cleanup
+    LinkList          links;    // indices into Graph::links
+    bool              is_dead;  // set by kill_node -> removed on next cleanup
     bool              is_pinned = false;  // pinned nodes do not move
     bool              is_source = false;  // energy source node
+    bool              is_free   = false;  // released slot (implies is_dead), free-list mode
+    bool              is_touched = false; // listed in Graph::touched_nodes
     float             energy = 0.0f;
     int               low_energy_steps = 0;
+    std::uint32_t     generation = 0;     // slot generation, see NodeHandle
 };
 
 // The whole network graph
+//
+// Storage modes (NODE_FREE_LIST):
+//   dense     - cleanup_dead compacts nodes and links every step, so every
+//               slot is alive afterwards and indices are renumbered.
+//   free list - cleanup_dead releases dead nodes and links in place (O(degree)
+//               per node). Released links go on free_links and are reused by
+//               add_link. Released node slots stay as is_free tombstones and
+//               new nodes are still appended, so index order keeps matching
+//               creation order (the step rules scan nodes by index); the slots
+//               are reclaimed by compacting once they exceed
+//               NODE_DEFRAG_FREE_FRACTION of the node storage.
+//
+// cleanup_dead only revisits the links of nodes in touched_nodes: every link
+// it kept is already canonical and stays so until one of its endpoints moves,
+// dies or has a link weight changed. Code that does any of these outside
+// add_node / add_link must call touch_node on the node.
 struct Graph {
     std::vector<Node> nodes;
+    std::vector<Link> links;
     int simulation_step = 0;
+
+    int              free_node_count = 0;  // released node slots (free-list mode)
+    std::vector<int> free_links;           // released link slots (free-list mode)
+
+    std::vector<int> touched_nodes;        // changed since the last cleanup_dead
+    std::uint32_t    last_generation = 0;  // last generation handed to a slot
+};
+
+// Record that node `idx` moved, died or had a link weight changed.
+inline void touch_node(Graph& graph, int idx) {
+    Node& node = graph.nodes[idx];
+    if (node.is_touched) return;
+    node.is_touched = true;
+    graph.touched_nodes.push_back(idx);
+}
+
+// Mark node `idx` dead. Always kill through here: free-list cleanup only
+// visits touched nodes, so a node whose is_dead was set directly would never
+// be released.
+inline void kill_node(Graph& graph, int idx) {
+    graph.nodes[idx].is_dead = true;
+    touch_node(graph, idx);
+}
+
+// Generation-checked reference to a node slot. Every node that enters a slot
+// (appended, moved there by compaction, or released into a tombstone) gets a
+// fresh generation from Graph::last_generation, so generations never repeat
+// within a graph and a handle taken earlier resolves only while the same node
+// still lives there, even after the slot was dropped and appended again.
+struct NodeHandle {
+    int           index = -1;
+    std::uint32_t generation = 0;
 };
 
-// Forward declaration so graph.h doesn't depend on maze.h order
+inline NodeHandle node_handle(const Graph& graph, int idx) {
+    return {idx, graph.nodes[idx].generation};
+}
+
+// Index of the node `handle` refers to, or -1 if it was released or moved.
+inline int resolve_handle(const Graph& graph, const NodeHandle& handle) {
+    if (handle.index < 0 || handle.index >= static_cast<int>(graph.nodes.size())) return -1;
+    const Node& node = graph.nodes[handle.index];
+    if (node.is_free || node.generation != handle.generation) return -1;
+    return handle.index;
+}
+
+// Number of nodes that are not dead (graph.nodes.size() also counts released
+// slots in free-list mode).
+int live_node_count(const Graph& graph);
+
+// Endpoint of `link` opposite `node`.
+inline int link_other(const Link& link, int node) {
+    return (link.a == node) ? link.b : link.a;
+}
+
+// Weight of `link` in the direction leaving / entering `node`.
+inline float& link_out_weight(Link& link, int node) {
+    return (link.a == node) ? link.w_ab : link.w_ba;
+}
+inline float link_out_weight(const Link& link, int node) {
+    return (link.a == node) ? link.w_ab : link.w_ba;
+}
+inline float link_in_weight(const Link& link, int node) {
+    return (link.a == node) ? link.w_ba : link.w_ab;
+}
+
+// Forward declarations so graph.h doesn't depend on maze.h order
 struct Maze;
+struct SpatialIndex;
+struct StepWorkspace;
 
 // ---------------------------------------------------------------------------
 // Function declarations
 // ---------------------------------------------------------------------------
 
+// Append `node` to the graph with a fresh generation and return its index.
+// References into graph.nodes may be invalidated.
+int add_node(Graph& graph, const Node& node);
+
+// Add a link a <-> b with weight `weight` in both directions (reusing a
+// released link slot if there is one) and register it with both endpoints.
+// Does not check for an existing link. Returns its index.
+int add_link(Graph& graph, int a, int b, float weight);
+
+// The functions below read their hyperparameters from `config` only. Each has
+// an overload without it that uses global_config (see config.h).
+
 // Compute the 8-element NN input vector for node at index `node_idx`.
+// If `index` is given it must reflect the current node positions; the nearest
+// node and crowdedness inputs are then answered from it instead of a full scan
+// (results are identical either way).
 std::array<float, node_nn::INPUT_SIZE> compute_inputs(
-    const Graph& graph,
-    int          node_idx,
-    const Vec2&  target,
-    const Maze&  maze);
+    const Graph&        graph,
+    int                 node_idx,
+    const Vec2&         target,
+    const Maze&         maze,
+    const SimConfig&    config,
+    const SpatialIndex* index = nullptr);
+std::array<float, node_nn::INPUT_SIZE> compute_inputs(
+    const Graph&        graph,
+    int                 node_idx,
+    const Vec2&         target,
+    const Maze&         maze,
+    const SpatialIndex* index = nullptr);
 
 // Apply the 7-element NN output vector (Vibe) to the graph for node `node_idx`.
 // May mark nodes dead, modify edge weights, and add new nodes/edges to `graph`.
+// If `index` is given, the SNAP_RADIUS lookup is answered from it and the
+// index is updated for the node's move and any sprouted node. Runs as a
+// read-only planning stage followed by applying the plan (see graph.cpp).
 void apply_vibe(
     Graph&                                      graph,
     int                                         node_idx,
     const std::array<float, node_nn::OUTPUT_SIZE>& output,
-    const Maze&                                 maze);
+    const Maze&                                 maze,
+    const SimConfig&                            config,
+    SpatialIndex*                               index = nullptr);
+void apply_vibe(
+    Graph&                                      graph,
+    int                                         node_idx,
+    const std::array<float, node_nn::OUTPUT_SIZE>& output,
+    const Maze&                                 maze,
+    SpatialIndex*                               index = nullptr);
 
 // Run one full simulation step: for every living node, evaluate the NN and
 // apply its output. Newly added nodes are NOT evaluated until the next step.
+// Scratch buffers come from `workspace` if given (see step_workspace.h), so a
+// caller stepping repeatedly avoids per-step allocations; otherwise a
+// temporary one is used.
+void step(
+    Graph&                      graph,
+    const node_nn::Model&       nn,
+    const Vec2&                 target,
+    const Maze&                 maze,
+    const SimConfig&            config,
+    StepWorkspace*              workspace = nullptr);
 void step(
     Graph&                      graph,
-    const node_nn::NeuralNetwork& nn,
+    const node_nn::Model&       nn,
     const Vec2&                 target,
-    const Maze&                 maze);
+    const Maze&                 maze,
+    StepWorkspace*              workspace = nullptr);
+
+// Energy rules of step() over the Graph layout: gradient diffusion with outflow
+// cap, maintenance cost, source levels and energy apoptosis. step() uses the
+// parallel SoA kernel (graph_soa.h) instead when ENERGY_PARALLEL_KERNEL is set.
+void apply_energy_rules(Graph& graph, const Vec2& target, const SimConfig& config,
+                        StepWorkspace* workspace = nullptr);
+void apply_energy_rules(Graph& graph, const Vec2& target, StepWorkspace* workspace = nullptr);
+
+// Remove dead nodes, dead / wall-crossing link directions, and links that
+// reference dead nodes, then fold each surviving link's two directional
+// weights into its canonical weight (mean if both directions are alive,
+// otherwise the surviving one). Only the links of touched nodes are examined;
+// the others were canonical after the previous call. Dense mode renumbers
+// nodes and links; free-list mode releases them in place, at O(degree) per
+// touched node (see Graph).
+void cleanup_dead(Graph& graph, const Maze& maze, const SimConfig& config,
+                  StepWorkspace* workspace = nullptr);
+void cleanup_dead(Graph& graph, const Maze& maze, StepWorkspace* workspace = nullptr);
+
+// ---------------------------------------------------------------------------
+// Trial setup and scoring shared by the simulation tools
+// ---------------------------------------------------------------------------
+
+// Initial graph of a trial: one node per passage cell, linked to its open
+// right / down neighbours with INITIAL_WEIGHT; the start cell (1, 1) and the
+// end cell (width - 2, height - 2) are pinned sources.
+Graph build_initial_graph(const Maze& maze, const SimConfig& config);
 
-// Remove dead nodes, wall-crossing edges, and any edges that reference dead nodes.
-// Updates all remaining edge target indices to remain valid.
-void cleanup_dead(Graph& graph, const Maze& maze);
+// Whether the first and last live source are joined by live nodes over link
+// directions of weight >= min_weight (the `connected` column of
+// eval_seed_trials).
+bool sources_connected(const Graph& graph, float min_weight);
 
 } // namespace sim
@@ -0,0 +1,320 @@
+#include "graph_soa.h"
+#include "thread_pool.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace sim {
+
+// ---------------------------------------------------------------------------
+// Internal helpers
+// ---------------------------------------------------------------------------
+
+static float clamp(float v, float lo, float hi) {
+    return v < lo ? lo : (v > hi ? hi : v);
+}
+
+// Levels the sources are reset to this step (ENERGY_PULSE_ENABLE alternates
+// the source nearest the target with the others).
+struct SourceLevels {
+    int   goal_source_idx = -1;
+    int   source_count    = 0;
+    bool  pulse           = false;  // ENERGY_PULSE_ENABLE
+    float base            = 0.0f;   // ENERGY_SOURCE_VALUE
+    float goal            = 0.0f;
+    float other           = 0.0f;
+
+    bool pulsed() const { return pulse && source_count >= 2 && goal_source_idx >= 0; }
+    float level(int i) const {
+        return pulsed() ? ((i == goal_source_idx) ? goal : other) : base;
+    }
+};
+
+// Pair flux leaving each slot's node over slots [begin, end): on entry
+// flux[k] holds the energy difference e_i - e_j of the slot's pair (0 for
+// pairs with a dead end), on exit beta * w_ij * (e_i - e_j), or 0 when the
+// lower-index side's direction is not positive. w_ij is the mean of both
+// directions when both are positive, else the positive one. Explicit SSE2
+// where available; every lane computes the same IEEE operations as the
+// scalar tail.
+static void slot_fluxes(int begin, int end, const int* from, const int* to,
+                        const float* weight, const float* weight_in, float beta, float* flux) {
+    int k = begin;
+#if defined(__SSE2__)
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 half = _mm_set1_ps(0.5f);
+    const __m128 beta4 = _mm_set1_ps(beta);
+    for (; k + 4 <= end; k += 4) {
+        const __m128 w_out = _mm_loadu_ps(weight + k);
+        const __m128 w_in  = _mm_loadu_ps(weight_in + k);
+        const __m128 diff  = _mm_loadu_ps(flux + k);
+        const __m128 i_low = _mm_castsi128_ps(_mm_cmplt_epi32(
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(from + k)),
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(to + k))));
+        const __m128 out_pos = _mm_cmpgt_ps(w_out, zero);
+        const __m128 in_pos  = _mm_cmpgt_ps(w_in, zero);
+        const __m128 active  = _mm_or_ps(_mm_and_ps(i_low, out_pos), _mm_andnot_ps(i_low, in_pos));
+        const __m128 both    = _mm_and_ps(out_pos, in_pos);
+        const __m128 w_one   = _mm_or_ps(_mm_and_ps(out_pos, w_out), _mm_andnot_ps(out_pos, w_in));
+        const __m128 w_avg   = _mm_mul_ps(half, _mm_add_ps(w_out, w_in));
+        const __m128 w_ij    = _mm_or_ps(_mm_and_ps(both, w_avg), _mm_andnot_ps(both, w_one));
+        const __m128 f       = _mm_mul_ps(_mm_mul_ps(beta4, w_ij), diff);
+        _mm_storeu_ps(flux + k, _mm_and_ps(active, f));
+    }
+#endif
+    for (; k < end; ++k) {
+        const float w_out = weight[k];
+        const float w_in  = weight_in[k];
+        const bool  out_pos = w_out > 0.0f;
+        const bool  in_pos  = w_in > 0.0f;
+        const bool  active  = (from[k] < to[k]) ? out_pos : in_pos;
+        const float w_ij = (out_pos && in_pos) ? (0.5f * (w_out + w_in))
+                                               : (out_pos ? w_out : w_in);
+        flux[k] = active ? beta * w_ij * flux[k] : 0.0f;
+    }
+}
+
+static SourceLevels source_levels(const GraphSoA& soa, const Vec2& target, const SimConfig& config) {
+    const int m = soa.node_count();
+    SourceLevels levels;
+    levels.pulse = config.ENERGY_PULSE_ENABLE;
+    levels.base  = config.ENERGY_SOURCE_VALUE;
+    levels.goal  = levels.base;
+    levels.other = levels.base;
+    if (config.ENERGY_PULSE_ENABLE) {
+        float best_goal_d2 = std::numeric_limits<float>::max();
+        for (int i = 0; i < m; ++i) {
+            if (soa.is_dead(i) || !soa.is_source(i)) continue;
+            ++levels.source_count;
+            const float dx = soa.pos_x[i] - target.x;
+            const float dy = soa.pos_y[i] - target.y;
+            const float d2 = dx * dx + dy * dy;
+            if (d2 < best_goal_d2) {
+                best_goal_d2 = d2;
+                levels.goal_source_idx = i;
+            }
+        }
+    }
+
+    if (config.ENERGY_PULSE_ENABLE && levels.source_count >= 2) {
+        const int period = std::max(1, static_cast<int>(config.ENERGY_PULSE_PERIOD_STEPS));
+        const float low_ratio = clamp(config.ENERGY_PULSE_LOW_RATIO, 0.0f, 1.0f);
+        const float high = config.ENERGY_SOURCE_VALUE;
+        const float low = high * low_ratio;
+        const float sink = config.ENERGY_PULSE_SINK_VALUE;
+
+        constexpr float PI = 3.14159265358979323846f;
+        const float phase = (2.0f * PI * static_cast<float>(soa.simulation_step % period)) /
+                            static_cast<float>(period);
+        const float wave = std::sin(phase);
+        const float amp = std::abs(wave);
+        const float active_level = low + (high - low) * amp;
+
+        if (wave >= 0.0f) {
+            levels.other = active_level;
+            levels.goal  = sink;
+        } else {
+            levels.other = sink;
+            levels.goal  = active_level;
+        }
+    }
+    return levels;
+}
+
+// ---------------------------------------------------------------------------
+// Conversion
+// ---------------------------------------------------------------------------
+
+void graph_to_soa(const Graph& graph, GraphSoA& soa) {
+    const int n = static_cast<int>(graph.nodes.size());
+
+    soa.pos_x.resize(n);
+    soa.pos_y.resize(n);
+    soa.energy.resize(n);
+    soa.flags.resize(n);
+    soa.edge_offset.resize(static_cast<size_t>(n) + 1);
+    soa.simulation_step = graph.simulation_step;
+
+    int edge_count = 0;
+    for (int i = 0; i < n; ++i) {
+        soa.edge_offset[i] = edge_count;
+        edge_count += static_cast<int>(graph.nodes[i].links.size());
+    }
+    soa.edge_offset[n] = edge_count;
+    soa.edge_source.resize(edge_count);
+    soa.edge_target.resize(edge_count);
+    soa.edge_weight.resize(edge_count);
+    soa.edge_weight_in.resize(edge_count);
+    soa.edge_link.resize(edge_count);
+
+    for (int i = 0; i < n; ++i) {
+        const Node& node = graph.nodes[i];
+        soa.pos_x[i]            = node.pos.x;
+        soa.pos_y[i]            = node.pos.y;
+        soa.energy[i]           = node.energy;
+        soa.flags[i] = static_cast<unsigned char>(
+            (node.is_dead   ? GraphSoA::FLAG_DEAD   : 0) |
+            (node.is_pinned ? GraphSoA::FLAG_PINNED : 0) |
+            (node.is_source ? GraphSoA::FLAG_SOURCE : 0));
+
+        int k = soa.edge_offset[i];
+        for (int l : node.links) {
+            const Link& link = graph.links[l];
+            soa.edge_source[k]    = i;
+            soa.edge_target[k]    = link_other(link, i);
+            soa.edge_weight[k]    = link_out_weight(link, i);
+            soa.edge_weight_in[k] = link_in_weight(link, i);
+            soa.edge_link[k]      = l;
+            ++k;
+        }
+    }
+}
+
+void soa_write_back_state(const GraphSoA& soa, Graph& graph) {
+    const int n = soa.node_count();
+    for (int i = 0; i < n; ++i) {
+        Node& node = graph.nodes[i];
+        node.energy = soa.energy[i];
+        if ((soa.flags[i] & GraphSoA::FLAG_DEAD) && !node.is_dead) kill_node(graph, i);
+
+        for (int k = soa.edge_offset[i]; k < soa.edge_offset[i + 1]; ++k) {
+            link_out_weight(graph.links[soa.edge_link[k]], i) = soa.edge_weight[k];
+        }
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Energy rules, parallel gather kernel
+//
+// Every undirected pair is visited from both of its slots. Both endpoints
+// derive the pair's activity and weight from the lower-index side's view (as
+// apply_energy_rules does), and the flux beta * w * (e_i - e_j) changes
+// sign exactly when i and j swap, so the two slots hold the exact negation of
+// each other and no pair needs a shared write:
+//
+//   1) per slot: the flux leaving the slot's node (0 for inactive pairs);
+//      per node: raw outflow and outflow scale
+//   2) per node: capped inflow - outflow, maintenance, source level, clamp,
+//      apoptosis decision
+//   3) per node: dead out-weights, its own and those towards dying nodes
+//
+// Passes are separated by the pool's join. Apart from the source scan, all
+// work is split into contiguous node ranges whose slots are contiguous too.
+// ---------------------------------------------------------------------------
+
+void soa_apply_energy_rules_parallel(GraphSoA& soa, const Vec2& target, const SimConfig& config,
+                                     ThreadPool* pool) {
+    const int m = soa.node_count();
+    const int edge_count = soa.edge_offset[m];
+
+    const int*           offset    = soa.edge_offset.data();
+    const int*           from      = soa.edge_source.data();
+    const int*           to        = soa.edge_target.data();
+    float*               weight    = soa.edge_weight.data();
+    const float*         weight_in = soa.edge_weight_in.data();
+    unsigned char*       flags     = soa.flags.data();
+
+    soa.scratch_old_energy.assign(soa.energy.begin(), soa.energy.end());
+    soa.scratch_raw_outflow.resize(static_cast<size_t>(m));
+    soa.scratch_outflow_scale.resize(static_cast<size_t>(m));
+    soa.scratch_edge_flux.resize(static_cast<size_t>(edge_count));
+    soa.scratch_dies.resize(static_cast<size_t>(m));
+    const float* old_energy    = soa.scratch_old_energy.data();
+    float*       next_energy   = soa.energy.data();
+    float*       raw_outflow   = soa.scratch_raw_outflow.data();
+    float*       outflow_scale = soa.scratch_outflow_scale.data();
+    float*       flux          = soa.scratch_edge_flux.data();
+    char*        dies          = soa.scratch_dies.data();
+
+    const float beta = clamp(config.ENERGY_DIFFUSION_ALPHA, 0.0f, 1.0f);
+    const float outflow_cap_ratio = clamp(config.ENERGY_FLOW_GAIN, 0.0f, 1.0f);
+    const bool enable_energy_apoptosis =
+        soa.simulation_step > static_cast<int>(config.APOPTOSIS_WARMUP_STEPS);
+    const SourceLevels sources = source_levels(soa, target, config);
+
+    auto run = [&](auto&& pass) {
+        if (pool) pool->parallel_for(m, pass);
+        else pass(0, m);
+    };
+
+    // 1) Outgoing flux per slot, then raw outflow and cap per node.
+    run([=](int begin, int end) {
+        // Gather the pair's energy difference (0 across a dead node or a
+        // self-link), then the weight arithmetic over contiguous slots.
+        for (int k = offset[begin]; k < offset[end]; ++k) {
+            const int i = from[k];
+            const int j = to[k];
+            const bool dead = ((flags[i] | flags[j]) & GraphSoA::FLAG_DEAD) != 0;
+            flux[k] = dead ? 0.0f : old_energy[i] - old_energy[j];
+        }
+        slot_fluxes(offset[begin], offset[end], from, to, weight, weight_in, beta, flux);
+        for (int i = begin; i < end; ++i) {
+            float outflow = 0.0f;
+            for (int k = offset[i]; k < offset[i + 1]; ++k) {
+                outflow += std::max(flux[k], 0.0f);
+            }
+            raw_outflow[i] = outflow;
+            const float cap_i = outflow_cap_ratio * std::max(0.0f, old_energy[i]);
+            outflow_scale[i] = (outflow > 1.0e-6f && !(flags[i] & GraphSoA::FLAG_DEAD))
+                ? std::min(1.0f, cap_i / outflow) : 1.0f;
+        }
+    });
+
+    // 2) Capped fluxes, maintenance, source overwrite, clamp, death decision.
+    // A slot's flux is capped by the scale of whichever end it leaves.
+    run([=](int begin, int end) {
+        for (int k = offset[begin]; k < offset[end]; ++k) {
+            const float f = flux[k];
+            const float scale_from = outflow_scale[from[k]];
+            const float scale_to   = outflow_scale[to[k]];
+            flux[k] = f * ((f > 0.0f) ? scale_from : scale_to);
+        }
+        for (int i = begin; i < end; ++i) {
+            dies[i] = 0;
+            if ((flags[i] & GraphSoA::FLAG_DEAD)) continue;
+
+            float outflow = 0.0f;
+            float total_weight = 0.0f;
+            for (int k = offset[i]; k < offset[i + 1]; ++k) {
+                outflow += flux[k];
+                total_weight += std::max(weight[k], 0.0f);
+            }
+
+            const float maintenance = config.ENERGY_MAINTENANCE_COST +
+                                      config.ENERGY_MAINTENANCE_PER_WEIGHT * total_weight;
+            float new_e = (old_energy[i] - outflow) - maintenance;
+            if ((flags[i] & GraphSoA::FLAG_SOURCE)) {
+                new_e = sources.level(i);
+            }
+            new_e = clamp(new_e, config.ENERGY_MIN_CLAMP, config.ENERGY_MAX_CLAMP);
+            next_energy[i] = new_e;
+
+            if (!(flags[i] & GraphSoA::FLAG_SOURCE)) {
+                dies[i] = (new_e <= 0.0f) ||
+                          (enable_energy_apoptosis && new_e <= config.NN_APOPTOSIS_ENERGY_GATE);
+            }
+        }
+    });
+
+    // 3) Energy-based apoptosis: a dying node drops all of its directions and
+    // every living node its directions into dying neighbours.
+    run([=](int begin, int end) {
+        for (int i = begin; i < end; ++i) {
+            if ((flags[i] & GraphSoA::FLAG_DEAD)) continue;
+            const char dies_i = dies[i];
+            for (int k = offset[i]; k < offset[i + 1]; ++k) {
+                weight[k] = (dies_i | dies[to[k]]) ? -1.0f : weight[k];
+            }
+        }
+        for (int i = begin; i < end; ++i) {
+            if (dies[i]) flags[i] |= GraphSoA::FLAG_DEAD;
+        }
+    });
+}
+
+} // namespace sim
@@ -0,0 +1,81 @@
+#pragma once
+
+#include "graph.h"
+#include <vector>
+
+namespace sim {
+
+// ---------------------------------------------------------------------------
+// Structure-of-arrays graph core for the parallel energy kernel
+//
+// Node state lives in parallel arrays and edges in one CSR block: node i's
+// edges are slots edge_offset[i] .. edge_offset[i+1]), one per entry of
+// Graph::nodes[i].links and in the same order. Each slot carries its node,
+// the neighbour, the weight leaving i (edge_weight), the weight entering i
+// (edge_weight_in) and the link it came from. The gather kernel below streams
+// over these arrays in contiguous node ranges.
+//
+// The graph is converted every step (ENERGY_PARALLEL_KERNEL), at about half
+// the cost of a serial Graph energy pass, so the kernel only pays off when it
+// runs on several cores (bench_sim diffusion).
+//
+//   graph_to_soa(graph, soa);
+//   soa_apply_energy_rules_parallel(soa, target, config, pool);
+//   soa_write_back_state(soa, graph);
+// ---------------------------------------------------------------------------
+
+struct GraphSoA {
+    enum : unsigned char {
+        FLAG_DEAD   = 1 << 0,
+        FLAG_PINNED = 1 << 1,
+        FLAG_SOURCE = 1 << 2,
+    };
+
+    std::vector<float>         pos_x;
+    std::vector<float>         pos_y;
+    std::vector<float>         energy;
+    std::vector<unsigned char> flags;
+
+    std::vector<int>           edge_offset;  // node_count() + 1 entries
+    std::vector<int>           edge_source;  // owning node of each slot
+    std::vector<int>           edge_target;
+    std::vector<float>         edge_weight;     // direction i -> target
+    std::vector<float>         edge_weight_in;  // direction target -> i
+    std::vector<int>           edge_link;       // index into Graph::links
+
+    int simulation_step = 0;
+
+    // Scratch for the energy kernel, kept to reuse capacity.
+    std::vector<float>    scratch_old_energy;
+    std::vector<float>    scratch_raw_outflow;
+    std::vector<float>    scratch_outflow_scale;
+    std::vector<float>    scratch_edge_flux;  // per slot
+    std::vector<char>     scratch_dies;
+
+    int  node_count() const { return static_cast<int>(flags.size()); }
+    bool is_dead(int i)   const { return (flags[i] & FLAG_DEAD)   != 0; }
+    bool is_source(int i) const { return (flags[i] & FLAG_SOURCE) != 0; }
+};
+
+// Fill `soa` from `graph`, reusing its buffers.
+void graph_to_soa(const Graph& graph, GraphSoA& soa);
+
+// Copy the energies, deaths and outgoing edge weights of `soa` back into
+// `graph`, whose topology must still be the one `soa` was built from.
+void soa_write_back_state(const GraphSoA& soa, Graph& graph);
+
+class ThreadPool;
+
+// Energy rules of sim::step (diffusion, outflow cap, maintenance, sources,
+// energy apoptosis) as a per-node gather over the CSR slots: every node sums
+// the fluxes on its own slots (branch-free, vectorisable flat loops) and
+// writes only its own energy and out-weights, so node ranges run on `pool`
+// without locks. Maintenance, sources and clamping are fused into the flux
+// application pass. Each node's sums run in slot order, so results are the
+// same for any thread count (and with pool == nullptr), but the summation
+// order differs from apply_energy_rules: energies agree to rounding, not bit
+// for bit.
+void soa_apply_energy_rules_parallel(GraphSoA& soa, const Vec2& target, const SimConfig& config,
+                                     ThreadPool* pool);
+
+} // namespace sim
@@ -0,0 +1,94 @@
+#include "line_of_sight.h"
+
+#include <cstdlib>
+
+namespace sim {
+
+// ---------------------------------------------------------------------------
+// Supercover walk
+// ---------------------------------------------------------------------------
+
+bool cells_line_blocked(const Maze& maze, int x0, int y0, int x1, int y1) {
+    if (is_wall_cell(maze, x0, y0) || is_wall_cell(maze, x1, y1)) {
+        return true;
+    }
+
+    int dx = std::abs(x1 - x0);
+    int dy = std::abs(y1 - y0);
+    int sx = (x0 < x1) ? 1 : -1;
+    int sy = (y0 < y1) ? 1 : -1;
+    int err = dx - dy;
+
+    while (true) {
+        if (is_wall_cell(maze, x0, y0)) {
+            return true;
+        }
+        if (x0 == x1 && y0 == y1) {
+            break;
+        }
+
+        int prev_x = x0;
+        int prev_y = y0;
+        int e2 = 2 * err;
+
+        if (e2 > -dy) {
+            err -= dy;
+            x0 += sx;
+        }
+        if (e2 < dx) {
+            err += dx;
+            y0 += sy;
+        }
+
+        // Supercover-style corner check: catch diagonal corner clipping.
+        if (x0 != prev_x && y0 != prev_y) {
+            if (is_wall_cell(maze, prev_x, y0) || is_wall_cell(maze, x0, prev_y)) {
+                return true;
+            }
+        }
+    }
+
+    return false;
+}
+
+// ---------------------------------------------------------------------------
+// LineOfSightCache
+// ---------------------------------------------------------------------------
+
+LineOfSightCache::LineOfSightCache(const Maze& maze)
+    : width_(maze.width), height_(maze.height)
+{
+    const size_t cells = static_cast<size_t>(width_ > 0 ? width_ : 0) *
+                         static_cast<size_t>(height_ > 0 ? height_ : 0);
+    const size_t entries = cells * SPAN * SPAN;
+    table_.reset(new std::atomic<unsigned char>[entries]);
+    for (size_t i = 0; i < entries; ++i) {
+        table_[i].store(UNKNOWN, std::memory_order_relaxed);
+    }
+}
+
+bool LineOfSightCache::blocked(const Maze& maze, int x0, int y0, int x1, int y1) const {
+    const int dx = x1 - x0;
+    const int dy = y1 - y0;
+    if (x0 < 0 || y0 < 0 || x0 >= width_ || y0 >= height_ ||
+        dx < -LOS_CACHE_REACH || dx > LOS_CACHE_REACH ||
+        dy < -LOS_CACHE_REACH || dy > LOS_CACHE_REACH) {
+        return cells_line_blocked(maze, x0, y0, x1, y1);
+    }
+
+    const size_t slot =
+        (static_cast<size_t>(y0) * width_ + x0) * SPAN * SPAN +
+        static_cast<size_t>(dy + LOS_CACHE_REACH) * SPAN +
+        static_cast<size_t>(dx + LOS_CACHE_REACH);
+
+    const unsigned char cached = table_[slot].load(std::memory_order_relaxed);
+    if (cached != UNKNOWN) {
+        return cached == BLOCKED;
+    }
+
+    const bool result = cells_line_blocked(maze, x0, y0, x1, y1);
+    table_[slot].store(result ? BLOCKED : CLEAR, std::memory_order_relaxed);
+    return result;
+}
+
+} // namespace sim
@@ -0,0 +1,47 @@
+#pragma once
+
+#include "maze.h"
+#include <atomic>
+#include <memory>
+
+namespace sim {
+
+// ---------------------------------------------------------------------------
+// Cell-to-cell line of sight
+//
+// Whether a segment crosses a wall depends only on its start and end cells
+// (supercover Bresenham walk over the static maze), so results are cached per
+// ordered cell pair. The cache covers partner cells within LOS_CACHE_REACH
+// cells of the start cell in both axes, which holds every edge the simulation
+// creates; longer segments fall back to the walk.
+//
+// Entries are filled lazily with relaxed atomics. Every writer stores the same
+// value for a given pair, so one cache can be read and filled by any number of
+// threads without locking.
+// ---------------------------------------------------------------------------
+
+constexpr int LOS_CACHE_REACH = 8;
+
+// Reference walk: true if the cell line from (x0, y0) to (x1, y1) touches a
+// wall or out-of-bounds cell, including diagonal corner clipping.
+bool cells_line_blocked(const Maze& maze, int x0, int y0, int x1, int y1);
+
+class LineOfSightCache {
+public:
+    explicit LineOfSightCache(const Maze& maze);
+
+    // Same result as cells_line_blocked(maze, x0, y0, x1, y1). `maze` must be
+    // the maze this cache was built for.
+    bool blocked(const Maze& maze, int x0, int y0, int x1, int y1) const;
+
+private:
+    static constexpr int SPAN = 2 * LOS_CACHE_REACH + 1;
+
+    enum : unsigned char { UNKNOWN = 0, CLEAR = 1, BLOCKED = 2 };
+
+    int width_;
+    int height_;
+    std::unique_ptr<std::atomic<unsigned char>[]> table_;  // [cell][dy][dx]
+};
+
+} // namespace sim
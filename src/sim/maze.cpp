@@ -1,18 +1,15 @@
 #include "maze.h"
+#include "config.h"
+#include "wall_field.h"
+#include "line_of_sight.h"
 #include <algorithm>
+#include <iostream>
 #include <random>
+#include <sstream>
 #include <stack>
 
 namespace sim {
 
-bool is_wall(const Maze& maze, float px, float py) {
-    int col = static_cast<int>(px);
-    int row = static_cast<int>(py);
-    if (col < 0 || row < 0 || col >= maze.width || row >= maze.height)
-        return true;  // out of bounds treated as wall
-    return maze.grid[row][col] == 1;
-}
-
 // ---------------------------------------------------------------------------
 // Recursive backtracker maze generation (穴掘り法)
 //
@@ -20,7 +17,7 @@ bool is_wall(const Maze& maze, float px, float py) {
 // "Room" cells are at even offsets+1 (i.e., odd indices in 0-based).
 // Wall cells occupy even indices.
 // ---------------------------------------------------------------------------
-Maze generate_maze(int cols, int rows, unsigned seed) {
+Maze generate_maze(int cols, int rows, unsigned seed, const SimConfig& config) {
     int W = 2 * cols + 1;
     int H = 2 * rows + 1;
 
@@ -80,7 +77,59 @@ Maze generate_maze(int cols, int rows, unsigned seed) {
     // No longer carving edge openings - maze is fully enclosed
     // Entry and exit are now inside the maze
 
+    prepare_maze(maze, config);
     return maze;
 }
 
+Maze generate_maze(int cols, int rows, unsigned seed) {
+    return generate_maze(cols, rows, seed, global_config);
+}
+
+bool is_wall_cell_unprepared(const Maze& maze, int col, int row) {
+    if (col < 0 || row < 0 || col >= maze.width || row >= maze.height)
+        return true;  // out of bounds treated as wall
+    return maze.grid[row][col] == 1;
+}
+
+// ---------------------------------------------------------------------------
+// Derived acceleration data
+// ---------------------------------------------------------------------------
+void prepare_maze(Maze& maze, const SimConfig& config) {
+    maze.stride = maze.width + 2;
+    maze.walls.assign(static_cast<size_t>(maze.stride) * (maze.height + 2), 1);
+    for (int row = 0; row < maze.height; ++row) {
+        for (int col = 0; col < maze.width; ++col) {
+            maze.walls[static_cast<size_t>(row + 1) * maze.stride + (col + 1)] =
+                (maze.grid[row][col] == 1) ? 1 : 0;
+        }
+    }
+
+    maze.wall_field.reset();
+    maze.los_cache.reset();
+
+    if (config.USE_LOS_CACHE) {
+        maze.los_cache = std::make_shared<const LineOfSightCache>(maze);
+    }
+
+    if (!config.WALL_FIELD_ENABLE) return;
+
+    auto field = std::make_shared<WallField>(
+        build_wall_field(maze, static_cast<int>(config.WALL_FIELD_RESOLUTION)));
+
+    if (config.WALL_FIELD_VALIDATE) {
+        const float dev = wall_field_max_deviation(*field, maze, 16);
+        std::ostringstream oss;
+        oss << "[wall_field] " << maze.width << "x" << maze.height
+            << " resolution=" << field->resolution
+            << " max deviation from exact scan = " << dev << "\n";
+        std::cout << oss.str();
+    }
+
+    maze.wall_field = std::move(field);
+}
+
+void prepare_maze(Maze& maze) {
+    prepare_maze(maze, global_config);
+}
+
 } // namespace sim
@@ -1,25 +1,75 @@
 #pragma once
 
+#include <algorithm>
+#include <cassert>
+#include <memory>
 #include <vector>
 
 namespace sim {
 
+struct WallField;         // wall_field.h
+class  LineOfSightCache;  // line_of_sight.h
+struct SimConfig;         // config.h
+
 // ---------------------------------------------------------------------------
 // 2-D grid maze
 //
 // Layout:   grid[row][col], i.e. grid[y][x]
 // Values:   0 = passage, 1 = wall
 // Coordinates: world position (px, py) maps to cell (floor(px), floor(py)).
+//
+// `grid` is the authoring layout (generation, JSON export). Wall queries go
+// through `walls`, a contiguous copy built by prepare_maze(): one byte per
+// cell, padded with a one-cell wall frame so that any coordinate clamped into
+// [-1, width] x [-1, height] reads a valid cell and out-of-bounds needs no
+// branch. Cell (x, y) lives at walls[(y + 1) * stride + (x + 1)].
 // ---------------------------------------------------------------------------
 
 struct Maze {
     int                          width;   // number of columns (x)
     int                          height;  // number of rows    (y)
     std::vector<std::vector<int>> grid;   // grid[y][x]
+
+    int                          stride = 0;  // width + 2
+    std::vector<unsigned char>   walls;       // padded, 1 = wall
+
+    // Derived data built by prepare_maze(); shared between copies. The line-
+    // of-sight cache fills itself lazily and is safe to share across threads.
+    std::shared_ptr<const WallField>        wall_field;
+    std::shared_ptr<const LineOfSightCache> los_cache;
 };
 
+// Grid lookup for a maze that prepare_maze() has not laid out (hand-built or
+// still being generated). Bounds-checked, slower than is_wall_cell().
+bool is_wall_cell_unprepared(const Maze& maze, int col, int row);
+
+// Debug check behind is_wall_cell(): the padded layout exists and still agrees
+// with grid at (col, row), which fails after a grid edit without prepare_maze().
+inline bool walls_match_grid(const Maze& maze, int col, int row) {
+    if (maze.stride != maze.width + 2 ||
+        maze.walls.size() != static_cast<size_t>(maze.stride) * (maze.height + 2)) {
+        return false;
+    }
+    if (col < 0 || row < 0 || col >= maze.width || row >= maze.height) return true;
+    return (maze.walls[static_cast<size_t>(row + 1) * maze.stride + (col + 1)] != 0) ==
+           (maze.grid[row][col] == 1);
+}
+
+// Returns true if cell (col, row) is a wall or out of bounds. Reads the
+// padded `walls` layout, so the maze must have been through prepare_maze()
+// (generate_maze() does this); asserted in debug builds.
+inline bool is_wall_cell(const Maze& maze, int col, int row) {
+    assert(walls_match_grid(maze, col, row));
+    col = std::min(std::max(col, -1), maze.width);
+    row = std::min(std::max(row, -1), maze.height);
+    return maze.walls[static_cast<size_t>(row + 1) * maze.stride + (col + 1)] != 0;
+}
+
 // Returns true if world position (px, py) is inside a wall or out of bounds.
-bool is_wall(const Maze& maze, float px, float py);
+// Coordinates are truncated towards zero, as the cell lookup always has been.
+inline bool is_wall(const Maze& maze, float px, float py) {
+    return is_wall_cell(maze, static_cast<int>(px), static_cast<int>(py));
+}
 
 // Returns the centre of cell (col, row) in world coordinates.
 // Cell (0,0) has centre (0.5, 0.5).
@@ -31,5 +81,15 @@ inline float cell_cy(int row) { return row + 0.5f; }
 //   cols / rows = number of "room" cells in each direction.
 // Entry is at the top-left corner; exit at the bottom-right.
 Maze generate_maze(int cols, int rows, unsigned seed = 42);
+Maze generate_maze(int cols, int rows, unsigned seed, const SimConfig& config);
+
+// Build the padded wall layout and the derived acceleration data (wall
+// distance field, line-of-sight cache) for a maze whose grid is final.
+// generate_maze() calls this; call it again after editing grid. Every wall
+// query except is_wall_cell_unprepared() needs it.
+// Which structures are built follows `config` (USE_LOS_CACHE, WALL_FIELD_*),
+// or global_config without it.
+void prepare_maze(Maze& maze, const SimConfig& config);
+void prepare_maze(Maze& maze);
 
 } // namespace sim
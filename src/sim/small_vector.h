@@ -0,0 +1,157 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+namespace sim {
+
+// ---------------------------------------------------------------------------
+// Vector with inline storage for the first N elements
+//
+// Holds up to N elements inside the object and only moves to a heap block
+// once it grows past N, so short lists (node adjacency is mostly 1-4 links)
+// need no allocation and sit next to the rest of their owner. With N = 4 ints
+// the object is the same size as a std::vector<int>. Restricted to trivially
+// copyable element types; the subset of the std::vector interface provided
+// is what the simulation uses.
+// ---------------------------------------------------------------------------
+
+template <typename T, std::size_t N>
+class SmallVector {
+    static_assert(std::is_trivially_copyable<T>::value,
+                  "SmallVector only holds trivially copyable types");
+    static_assert(N > 0, "SmallVector needs inline capacity");
+
+public:
+    using value_type     = T;
+    using size_type      = std::size_t;
+    using iterator       = T*;
+    using const_iterator = const T*;
+
+    SmallVector() = default;
+
+    SmallVector(const SmallVector& other) { assign(other.begin(), other.end()); }
+
+    SmallVector(SmallVector&& other) noexcept { steal(other); }
+
+    ~SmallVector() { release(); }
+
+    SmallVector& operator=(const SmallVector& other) {
+        if (this != &other) assign(other.begin(), other.end());
+        return *this;
+    }
+
+    SmallVector& operator=(SmallVector&& other) noexcept {
+        if (this != &other) {
+            release();
+            steal(other);
+        }
+        return *this;
+    }
+
+    size_type size()     const { return size_; }
+    size_type capacity() const { return capacity_; }
+    bool      empty()    const { return size_ == 0; }
+    bool      is_inline() const { return capacity_ == N; }
+
+    T*       data()       { return is_inline() ? storage_.inline_data : storage_.heap; }
+    const T* data() const { return is_inline() ? storage_.inline_data : storage_.heap; }
+
+    iterator       begin()       { return data(); }
+    iterator       end()         { return data() + size_; }
+    const_iterator begin() const { return data(); }
+    const_iterator end()   const { return data() + size_; }
+
+    T&       operator[](size_type i)       { return data()[i]; }
+    const T& operator[](size_type i) const { return data()[i]; }
+    T&       back()       { return data()[size_ - 1]; }
+    const T& back() const { return data()[size_ - 1]; }
+
+    void reserve(size_type n) {
+        if (n > capacity_) grow_to(n);
+    }
+
+    void push_back(const T& value) {
+        if (size_ == capacity_) {
+            const T copy = value;  // `value` may live in this vector
+            grow_to(static_cast<size_type>(capacity_) * 2);
+            data()[size_++] = copy;
+            return;
+        }
+        data()[size_++] = value;
+    }
+
+    void pop_back() { --size_; }
+
+    void clear() { size_ = 0; }
+
+    // Shrinking keeps the storage; growing value-initialises the new tail.
+    void resize(size_type n) {
+        if (n > capacity_) grow_to(std::max<size_type>(n, capacity_ * 2));
+        T* d = data();
+        for (size_type i = size_; i < n; ++i) d[i] = T();
+        size_ = static_cast<std::uint32_t>(n);
+    }
+
+    iterator erase(const_iterator pos) {
+        T* d = data();
+        T* p = d + (pos - d);
+        std::copy(p + 1, d + size_, p);
+        --size_;
+        return p;
+    }
+
+    template <typename It>
+    void assign(It first, It last) {
+        const size_type n = static_cast<size_type>(last - first);
+        clear();
+        if (n > capacity_) grow_to(n);
+        std::copy(first, last, data());
+        size_ = static_cast<std::uint32_t>(n);
+    }
+
+    friend bool operator==(const SmallVector& a, const SmallVector& b) {
+        return a.size_ == b.size_ && std::equal(a.begin(), a.end(), b.begin());
+    }
+    friend bool operator!=(const SmallVector& a, const SmallVector& b) { return !(a == b); }
+
+private:
+    union Storage {
+        T  inline_data[N];
+        T* heap;
+    };
+
+    void grow_to(size_type n) {
+        T* block = new T[n];
+        std::copy(begin(), end(), block);
+        release();
+        storage_.heap = block;
+        capacity_ = static_cast<std::uint32_t>(n);
+    }
+
+    // Free the heap block (if any) and return to inline storage. Keeps size_.
+    void release() {
+        if (!is_inline()) delete[] storage_.heap;
+        capacity_ = N;
+    }
+
+    void steal(SmallVector& other) {
+        if (other.is_inline()) {
+            std::copy(other.begin(), other.end(), storage_.inline_data);
+        } else {
+            storage_.heap = other.storage_.heap;
+            capacity_ = other.capacity_;
+            other.capacity_ = N;
+        }
+        size_ = other.size_;
+        other.size_ = 0;
+    }
+
+    Storage       storage_{};
+    std::uint32_t size_     = 0;
+    std::uint32_t capacity_ = N;
+};
+
+} // namespace sim
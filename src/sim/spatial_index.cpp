@@ -0,0 +1,181 @@
+#include "spatial_index.h"
+#include "maze.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace sim {
+
+// ---------------------------------------------------------------------------
+// Internal helpers
+// ---------------------------------------------------------------------------
+
+// Cell coordinate of a world position along one axis, clamped into
+// [-1, extent] so the float -> int conversion is always well-defined.
+static int clamped_cell(float v, int extent) {
+    if (!(v >= 0.0f)) return -1;  // also catches NaN
+    if (v >= static_cast<float>(extent)) return extent;
+    return static_cast<int>(std::floor(v));
+}
+
+// ---------------------------------------------------------------------------
+// Maintenance
+// ---------------------------------------------------------------------------
+
+void SpatialIndex::rebuild(const Graph& graph, const Maze& maze) {
+    width  = maze.width;
+    height = maze.height;
+
+    const size_t cell_count = static_cast<size_t>(width) * static_cast<size_t>(height);
+    if (cells.size() != cell_count) {
+        cells.assign(cell_count, {});
+    } else {
+        for (auto& bucket : cells) bucket.clear();
+    }
+    overflow.clear();
+
+    for (int i = 0; i < static_cast<int>(graph.nodes.size()); ++i) {
+        if (graph.nodes[i].is_dead) continue;
+        insert(i, graph.nodes[i].pos);
+    }
+}
+
+std::vector<int>* SpatialIndex::bucket_for(const Vec2& pos) {
+    const int cx = clamped_cell(pos.x, width);
+    const int cy = clamped_cell(pos.y, height);
+    if (cx < 0 || cy < 0 || cx >= width || cy >= height) {
+        return &overflow;
+    }
+    return &cells[static_cast<size_t>(cy) * width + cx];
+}
+
+const std::vector<int>* SpatialIndex::bucket_at(int cx, int cy) const {
+    return &cells[static_cast<size_t>(cy) * width + cx];
+}
+
+void SpatialIndex::insert(int node_idx, const Vec2& pos) {
+    bucket_for(pos)->push_back(node_idx);
+}
+
+void SpatialIndex::remove(int node_idx, const Vec2& pos) {
+    std::vector<int>& bucket = *bucket_for(pos);
+    auto it = std::find(bucket.begin(), bucket.end(), node_idx);
+    if (it == bucket.end()) return;
+    *it = bucket.back();
+    bucket.pop_back();
+}
+
+void SpatialIndex::move(int node_idx, const Vec2& from, const Vec2& to) {
+    std::vector<int>* src = bucket_for(from);
+    std::vector<int>* dst = bucket_for(to);
+    if (src == dst) return;
+    remove(node_idx, from);
+    dst->push_back(node_idx);
+}
+
+// ---------------------------------------------------------------------------
+// Queries
+// ---------------------------------------------------------------------------
+
+int SpatialIndex::nearest(const Graph& graph, const Vec2& pos, int exclude_idx, float max_d2) const {
+    int   best_idx = -1;
+    float best_d2  = max_d2;
+
+    // Same distance expression and tie rule as an ascending brute-force loop
+    // with a strict `d2 < best_d2` test.
+    auto consider = [&](const std::vector<int>& bucket) {
+        for (int idx : bucket) {
+            if (idx == exclude_idx) continue;
+            const Node& cand = graph.nodes[idx];
+            if (cand.is_dead) continue;
+            const float dx = cand.pos.x - pos.x;
+            const float dy = cand.pos.y - pos.y;
+            const float d2 = dx * dx + dy * dy;
+            if (d2 < best_d2 || (d2 == best_d2 && best_idx >= 0 && idx < best_idx)) {
+                best_d2  = d2;
+                best_idx = idx;
+            }
+        }
+    };
+
+    consider(overflow);
+
+    const int cx = clamped_cell(pos.x, width);
+    const int cy = clamped_cell(pos.y, height);
+    if (cx < 0 || cy < 0 || cx >= width || cy >= height) {
+        // Query point outside the maze: ring bounds do not apply, scan all.
+        for (const auto& bucket : cells) consider(bucket);
+        return best_idx;
+    }
+
+    const int max_r = std::max(std::max(cx, width - 1 - cx), std::max(cy, height - 1 - cy));
+    for (int r = 0; r <= max_r; ++r) {
+        // Any node in ring r or beyond lies more than (r - 1) away. Stop once
+        // the current best is clearly closer than that (small slack keeps
+        // float rounding of d2 from ever changing the winner).
+        if (r >= 2) {
+            const float bound = static_cast<float>(r - 1);
+            if (best_d2 < bound * bound * 0.999f) break;
+        }
+
+        const int x0 = cx - r, x1 = cx + r;
+        const int y0 = cy - r, y1 = cy + r;
+        for (int y = std::max(y0, 0); y <= std::min(y1, height - 1); ++y) {
+            const bool edge_row = (y == y0 || y == y1);
+            if (edge_row) {
+                for (int x = std::max(x0, 0); x <= std::min(x1, width - 1); ++x) {
+                    consider(*bucket_at(x, y));
+                }
+            } else {
+                if (x0 >= 0)    consider(*bucket_at(x0, y));
+                if (x1 < width) consider(*bucket_at(x1, y));
+            }
+        }
+    }
+    return best_idx;
+}
+
+template <typename Visit>
+void SpatialIndex::visit_within(const Graph& graph, const Vec2& pos, int exclude_idx, float radius2,
+                                Visit&& visit) const {
+    auto consider = [&](const std::vector<int>& bucket) {
+        for (int idx : bucket) {
+            if (idx == exclude_idx) continue;
+            const Node& cand = graph.nodes[idx];
+            if (cand.is_dead) continue;
+            const float dx = cand.pos.x - pos.x;
+            const float dy = cand.pos.y - pos.y;
+            if (dx * dx + dy * dy < radius2) visit(idx);
+        }
+    };
+
+    consider(overflow);
+    if (!(radius2 > 0.0f) || width <= 0 || height <= 0) return;
+
+    // Cover the radius plus one spare cell on each side so borderline float
+    // rounding of d2 cannot drop a node the brute-force scan would accept.
+    const float r = std::sqrt(radius2);
+    const int x0 = std::max(clamped_cell(pos.x - r, width) - 1, 0);
+    const int x1 = std::min(clamped_cell(pos.x + r, width) + 1, width - 1);
+    const int y0 = std::max(clamped_cell(pos.y - r, height) - 1, 0);
+    const int y1 = std::min(clamped_cell(pos.y + r, height) + 1, height - 1);
+
+    for (int y = y0; y <= y1; ++y) {
+        for (int x = x0; x <= x1; ++x) {
+            consider(*bucket_at(x, y));
+        }
+    }
+}
+
+int SpatialIndex::count_within(const Graph& graph, const Vec2& pos, int exclude_idx, float radius2) const {
+    int count = 0;
+    visit_within(graph, pos, exclude_idx, radius2, [&](int) { ++count; });
+    return count;
+}
+
+void SpatialIndex::collect_within(const Graph& graph, const Vec2& pos, int exclude_idx, float radius2,
+                                  std::vector<int>& out) const {
+    visit_within(graph, pos, exclude_idx, radius2, [&](int idx) { out.push_back(idx); });
+}
+
+} // namespace sim
@@ -0,0 +1,61 @@
+#pragma once
+
+#include "graph.h"
+#include <vector>
+
+namespace sim {
+
+// ---------------------------------------------------------------------------
+// Uniform-grid spatial index over maze cells
+//
+// Each maze cell (floor(x), floor(y)) keeps the indices of the nodes whose
+// position falls inside it; positions outside the maze go to an overflow list
+// that is always scanned. Queries reproduce the brute-force scans exactly:
+// the same float distance expressions are evaluated, and ties are broken by
+// the lowest node index (i.e. the first hit of an ascending index loop).
+//
+// Usage (one rebuild per step, incremental updates while nodes move/sprout):
+//   SpatialIndex index;
+//   index.rebuild(graph, maze);
+//   ...
+//   index.move(i, old_pos, graph.nodes[i].pos);
+//   index.insert(new_idx, graph.nodes[new_idx].pos);
+// ---------------------------------------------------------------------------
+
+struct SpatialIndex {
+    int width  = 0;   // number of cell columns (maze width)
+    int height = 0;   // number of cell rows    (maze height)
+    std::vector<std::vector<int>> cells;  // cells[y * width + x] -> node indices
+    std::vector<int>              overflow;
+
+    // Clear and re-insert every alive node of `graph`. Nodes that die later
+    // stay in their buckets; queries filter them out.
+    void rebuild(const Graph& graph, const Maze& maze);
+
+    void insert(int node_idx, const Vec2& pos);
+    void remove(int node_idx, const Vec2& pos);
+    void move(int node_idx, const Vec2& from, const Vec2& to);
+
+    // Index of the closest alive node (excluding `exclude_idx`) with squared
+    // distance strictly below `max_d2`, or -1 if there is none.
+    int nearest(const Graph& graph, const Vec2& pos, int exclude_idx, float max_d2) const;
+
+    // Number of alive nodes (excluding `exclude_idx`) with squared distance
+    // strictly below `radius2`.
+    int count_within(const Graph& graph, const Vec2& pos, int exclude_idx, float radius2) const;
+
+    // Append to `out` every alive node (excluding `exclude_idx`) with squared
+    // distance strictly below `radius2`, in no particular order.
+    void collect_within(const Graph& graph, const Vec2& pos, int exclude_idx, float radius2,
+                        std::vector<int>& out) const;
+
+private:
+    std::vector<int>*       bucket_for(const Vec2& pos);
+    const std::vector<int>* bucket_at(int cx, int cy) const;
+
+    template <typename Visit>
+    void visit_within(const Graph& graph, const Vec2& pos, int exclude_idx, float radius2,
+                      Visit&& visit) const;
+};
+
+} // namespace sim
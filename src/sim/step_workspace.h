@@ -0,0 +1,103 @@
+#pragma once
+
+#include "graph.h"
+#include "graph_soa.h"
+#include "spatial_index.h"
+#include "thread_pool.h"
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace sim {
+
+// ---------------------------------------------------------------------------
+// Reusable per-step scratch
+//
+// step() needs a spatial index and a set of temporary arrays sized by the
+// graph (energy fluxes, fusion bookkeeping, cleanup remaps). A StepWorkspace
+// owns them so they survive between steps: once its buffers have grown to the
+// graph's size, a step makes no heap allocations of its own. Growth of the
+// graph itself (a new node, link or longer link list) still allocates.
+//
+// Not thread-safe; own one per thread / per simulated graph. With
+// STEP_SYNC_UPDATE and STEP_THREADS > 1 the workspace also owns the thread
+// pool of the evaluation phase, so threads are created once, not per step.
+//
+//   StepWorkspace workspace;
+//   for (int t = 0; t < steps; ++t) step(graph, nn, target, maze, &workspace);
+// ---------------------------------------------------------------------------
+
+struct StepWorkspace {
+    struct PairFlux {
+        int   i;
+        int   j;
+        float flux_i_to_j;
+    };
+    struct IncidentWeight {
+        int   k;
+        float w;
+    };
+    struct FusionNeighbor {
+        int   k;
+        float wi;
+        float wj;
+    };
+
+    // What one node's apply_vibe will do, planned without writing the graph
+    // (see plan_vibe / apply_intent in graph.cpp).
+    struct LinkDelta {
+        int   link;
+        float delta;
+    };
+    struct VibeIntent {
+        enum Grow { NONE, CONNECT, SPROUT };
+
+        int                    node = -1;
+        std::vector<LinkDelta> prune;      // out-weight -= delta
+        bool                   mark_dead = false;  // then mark weak out-weights dead
+        std::vector<LinkDelta> thicken;    // angle-snap: out-weight += delta
+        Grow                   grow = NONE;
+        int                    connect_to = -1;    // CONNECT
+        Vec2                   sprout_pos = {0.0f, 0.0f};  // SPROUT
+        bool                   move = false;
+        Vec2                   move_to = {0.0f, 0.0f};
+        std::vector<float>     out_weights;  // planning scratch
+        std::string            debug_log;    // DEBUG_GROW output, printed by apply_intent
+    };
+
+    SpatialIndex index;
+    GraphSoA     soa;  // ENERGY_PARALLEL_KERNEL
+
+    // Node updates: one intent in sequential mode, one per living node plus
+    // the merge's sprouts with STEP_SYNC_UPDATE
+    VibeIntent                  intent;
+    std::vector<int>            eval_nodes;
+    std::vector<VibeIntent>     intents;
+    std::vector<int>            sprouted;
+    std::unique_ptr<ThreadPool> pool;
+
+    // Energy rules (Graph layout)
+    std::vector<float>    old_energy;
+    std::vector<float>    next_energy;
+    std::vector<float>    raw_outflow;
+    std::vector<float>    outflow_scale;
+    std::vector<PairFlux> pair_fluxes;
+
+    // Fusion
+    std::vector<char>                  merged_away;
+    std::vector<char>                  reconnected;
+    std::vector<int>                   candidates;
+    std::vector<IncidentWeight>        inc_i;
+    std::vector<IncidentWeight>        inc_j;
+    std::vector<FusionNeighbor>        neighbors;
+    std::vector<std::pair<int, float>> reconnectable;
+
+    // cleanup_dead
+    std::vector<int>  dirty_links;
+    std::vector<char> keep_link;
+    std::vector<int>  node_remap;
+    std::vector<int>  link_remap;
+};
+
+} // namespace sim
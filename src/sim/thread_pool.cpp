@@ -0,0 +1,87 @@
+#include "thread_pool.h"
+
+#include <algorithm>
+
+namespace sim {
+
+// Chunk `part` of `parts` over [0, count): sizes differ by at most one.
+static void chunk_bounds(int count, int parts, int part, int& begin, int& end) {
+    const int base = count / parts;
+    const int extra = count % parts;
+    begin = part * base + std::min(part, extra);
+    end = begin + base + (part < extra ? 1 : 0);
+}
+
+ThreadPool::ThreadPool(int threads) : thread_count_(std::max(1, threads)) {
+    const int worker_count = thread_count_ - 1;
+    workers_.reserve(static_cast<size_t>(worker_count));
+    for (int w = 0; w < worker_count; ++w) {
+        workers_.emplace_back([this, w] { worker_loop(w); });
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    start_cv_.notify_all();
+    for (std::thread& t : workers_) t.join();
+}
+
+void ThreadPool::run(int count, void* fn, ChunkFn call) {
+    if (count <= 0) return;
+    const int parts = thread_count();
+    if (parts == 1 || count == 1) {
+        call(fn, 0, count);
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        job_fn_ = fn;
+        job_call_ = call;
+        job_count_ = count;
+        pending_ = thread_count_ - 1;
+        ++generation_;
+    }
+    start_cv_.notify_all();
+
+    int begin, end;
+    chunk_bounds(count, parts, 0, begin, end);
+    if (begin < end) call(fn, begin, end);
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    done_cv_.wait(lock, [this] { return pending_ == 0; });
+    job_fn_ = nullptr;
+    job_call_ = nullptr;
+}
+
+void ThreadPool::worker_loop(int worker) {
+    long seen = 0;
+    while (true) {
+        void*   fn;
+        ChunkFn call;
+        int     count;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            start_cv_.wait(lock, [&] { return stop_ || generation_ != seen; });
+            if (stop_) return;
+            seen = generation_;
+            fn = job_fn_;
+            call = job_call_;
+            count = job_count_;
+        }
+
+        int begin, end;
+        chunk_bounds(count, thread_count(), worker + 1, begin, end);
+        if (begin < end) call(fn, begin, end);
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (--pending_ == 0) done_cv_.notify_one();
+        }
+    }
+}
+
+} // namespace sim
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace sim {
+
+// ---------------------------------------------------------------------------
+// Fixed-size fork/join pool for data-parallel loops
+//
+// parallel_for(count, fn) splits [0, count) into one contiguous chunk per
+// thread and calls fn(begin, end) on each; the calling thread runs the first
+// chunk itself and the call returns once every chunk is done. The split only
+// depends on `count` and the thread count, and each index is visited exactly
+// once, so loops that write per-index results are deterministic.
+//
+// One parallel_for at a time per pool (not reentrant). Dispatch does not
+// allocate.
+// ---------------------------------------------------------------------------
+
+class ThreadPool {
+public:
+    // `threads` counts the caller; values <= 1 run everything inline.
+    explicit ThreadPool(int threads);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    int thread_count() const { return thread_count_; }
+
+    template <typename Fn>
+    void parallel_for(int count, Fn&& fn) {
+        using F = typename std::remove_reference<Fn>::type;
+        run(count, const_cast<void*>(static_cast<const void*>(&fn)),
+            [](void* f, int begin, int end) { (*static_cast<F*>(f))(begin, end); });
+    }
+
+private:
+    using ChunkFn = void (*)(void*, int, int);
+
+    void run(int count, void* fn, ChunkFn call);
+    void worker_loop(int worker);
+
+    int                      thread_count_;
+    std::vector<std::thread> workers_;
+
+    std::mutex              mutex_;
+    std::condition_variable start_cv_;
+    std::condition_variable done_cv_;
+    void*   job_fn_   = nullptr;
+    ChunkFn job_call_ = nullptr;
+    int  job_count_  = 0;
+    long generation_ = 0;  // bumped per parallel_for
+    int  pending_    = 0;  // worker chunks not yet finished
+    bool stop_       = false;
+};
+
+} // namespace sim
@@ -0,0 +1,185 @@
+#include "trial_scheduler.h"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#elif defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#endif
+
+namespace sim {
+
+// ---------------------------------------------------------------------------
+// Internal helpers
+// ---------------------------------------------------------------------------
+
+static void pin_to_cpu(std::thread& thread, int cpu) {
+#if defined(__linux__)
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu % CPU_SETSIZE, &set);
+    pthread_setaffinity_np(thread.native_handle(), sizeof(set), &set);
+#elif defined(_WIN32)
+    const int bits = static_cast<int>(8 * sizeof(DWORD_PTR));
+    SetThreadAffinityMask(thread.native_handle(), DWORD_PTR(1) << (cpu % bits));
+#else
+    (void)thread;
+    (void)cpu;
+#endif
+}
+
+namespace {
+
+// Owner pops from the front (longest first), thieves from the back.
+struct TaskQueue {
+    std::mutex      mutex;
+    std::deque<int> tasks;
+};
+
+} // namespace
+
+// ---------------------------------------------------------------------------
+// run_trials
+// ---------------------------------------------------------------------------
+
+int trial_thread_count(const TrialSchedulerOptions& options, int count) {
+    int threads = options.threads;
+    if (threads <= 0) threads = static_cast<int>(std::thread::hardware_concurrency());
+    return std::max(1, std::min(threads, count));
+}
+
+void run_trials(int                                     count,
+                const TrialSchedulerOptions&            options,
+                const std::function<double(int)>&       expected_cost,
+                const std::function<std::string(int)>&  run,
+                const std::function<void(int, std::string&)>& write) {
+    if (count <= 0) return;
+    const int threads = trial_thread_count(options, count);
+    const int window = std::max(2, options.reorder_window > 0 ? options.reorder_window : 4 * threads);
+    const int batch = std::max(1, window / 2);
+
+    std::vector<std::unique_ptr<TaskQueue>> queues;
+    for (int w = 0; w < threads; ++w) queues.push_back(std::make_unique<TaskQueue>());
+
+    // Finished results waiting for the writer: trial i lives in slot i % window.
+    std::vector<std::string> slots(static_cast<size_t>(window));
+    std::vector<char>        ready(static_cast<size_t>(window), 0);
+
+    std::mutex              mutex;  // admitted, written, ready, stop
+    std::condition_variable work_cv;
+    std::condition_variable done_cv;
+    std::atomic<int>        queued{0};
+    int  admitted = 0;
+    int  written  = 0;
+    int  deal     = 0;
+    bool stop     = false;
+    std::vector<int> admit_order;
+
+    // Release the next batch once at most half a window is outstanding.
+    // Called with `mutex` held.
+    auto admit = [&]() {
+        while (admitted < count && admitted - written <= window - batch) {
+            const int end = std::min(count, admitted + batch);
+            admit_order.clear();
+            for (int i = admitted; i < end; ++i) admit_order.push_back(i);
+            std::stable_sort(admit_order.begin(), admit_order.end(), [&](int a, int b) {
+                return expected_cost(a) > expected_cost(b);
+            });
+            for (int i : admit_order) {
+                TaskQueue& q = *queues[static_cast<size_t>(deal)];
+                deal = (deal + 1) % threads;
+                std::lock_guard<std::mutex> lock(q.mutex);
+                q.tasks.push_back(i);
+            }
+            queued.fetch_add(end - admitted);
+            admitted = end;
+        }
+        work_cv.notify_all();
+    };
+
+    auto take = [&](int self) -> int {
+        for (int k = 0; k < threads; ++k) {
+            TaskQueue& q = *queues[static_cast<size_t>((self + k) % threads)];
+            std::lock_guard<std::mutex> lock(q.mutex);
+            if (q.tasks.empty()) continue;
+            int task;
+            if (k == 0) {
+                task = q.tasks.front();
+                q.tasks.pop_front();
+            } else {
+                task = q.tasks.back();
+                q.tasks.pop_back();
+            }
+            queued.fetch_sub(1);
+            return task;
+        }
+        return -1;
+    };
+
+    auto worker = [&](int self) {
+        while (true) {
+            const int task = take(self);
+            if (task < 0) {
+                std::unique_lock<std::mutex> lock(mutex);
+                work_cv.wait(lock, [&] { return stop || queued.load() > 0; });
+                if (stop) return;
+                continue;
+            }
+
+            std::string result = run(task);
+            std::lock_guard<std::mutex> lock(mutex);
+            const size_t slot = static_cast<size_t>(task % window);
+            slots[slot] = std::move(result);
+            ready[slot] = 1;
+            if (task == written) done_cv.notify_one();
+        }
+    };
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        admit();
+    }
+    std::vector<std::thread> workers;
+    workers.reserve(static_cast<size_t>(threads));
+    for (int w = 0; w < threads; ++w) {
+        workers.emplace_back(worker, w);
+        if (options.pin_threads) pin_to_cpu(workers.back(), w);
+    }
+
+    // The calling thread is the writer.
+    std::string rows;
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            if (written == count) {
+                stop = true;
+                break;
+            }
+            const size_t slot = static_cast<size_t>(written % window);
+            done_cv.wait(lock, [&] { return ready[slot] != 0; });
+            rows.swap(slots[slot]);
+            slots[slot].clear();
+            ready[slot] = 0;
+        }
+        write(written, rows);
+        std::lock_guard<std::mutex> lock(mutex);
+        ++written;
+        admit();
+    }
+    work_cv.notify_all();
+    for (std::thread& t : workers) t.join();
+}
+
+} // namespace sim
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <functional>
+#include <string>
+
+namespace sim {
+
+// ---------------------------------------------------------------------------
+// Streaming trial scheduler
+//
+// Runs independent trials 0 .. count-1 on a work-stealing pool and hands each
+// trial's result to `write` in trial order, on the calling thread, as soon as
+// every earlier trial has been written. Only `reorder_window` trials can be
+// running or waiting to be written at any time, so memory stays bounded for
+// arbitrarily long sweeps.
+//
+// Trials are admitted in batches of half a window. Each batch is sorted by
+// expected_cost (longest first, ties in trial order) and dealt round-robin to
+// the workers' queues. Workers take their own longest task; idle workers
+// steal the shortest task from another queue, which evens out the tail of a
+// batch.
+//
+//   TrialSchedulerOptions options;
+//   run_trials(count, options,
+//              [](int)   { return 1.0; },
+//              [&](int i) { return run_trial(i); },
+//              [&](int i, std::string& rows) { out << rows; });
+// ---------------------------------------------------------------------------
+
+struct TrialSchedulerOptions {
+    int  threads        = 0;      // <= 0: std::thread::hardware_concurrency()
+    bool pin_threads    = false;  // pin worker w to logical CPU w (Linux, Windows)
+    int  reorder_window = 0;      // <= 0: 4 trials per thread
+};
+
+// Number of workers `options` resolves to for `count` trials (at least 1).
+int trial_thread_count(const TrialSchedulerOptions& options, int count);
+
+void run_trials(int                                     count,
+                const TrialSchedulerOptions&            options,
+                const std::function<double(int)>&       expected_cost,
+                const std::function<std::string(int)>&  run,
+                const std::function<void(int, std::string&)>& write);
+
+} // namespace sim
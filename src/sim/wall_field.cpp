@@ -0,0 +1,307 @@
+#include "wall_field.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <limits>
+
+namespace sim {
+
+// ---------------------------------------------------------------------------
+// Internal helpers
+// ---------------------------------------------------------------------------
+
+static float clamp(float v, float lo, float hi) {
+    return v < lo ? lo : (v > hi ? hi : v);
+}
+
+// Wall cells as seen by the exact scan: grid walls, plus the outer ring of
+// cells (out-of-bounds cells are clamped onto it).
+static bool is_field_wall_cell(const Maze& maze, int x, int y) {
+    if (x <= 0 || y <= 0 || x >= maze.width - 1 || y >= maze.height - 1) {
+        return true;
+    }
+    return is_wall_cell(maze, x, y);
+}
+
+// Search radius of the exact scan, in cells: it sees the wall cells in the
+// (2R+1)^2 window around the position's cell.
+static constexpr int SCAN_RADIUS = 6;
+
+// Whether the exact scan from cell (cx, cy) sees wall cell (col, row): the
+// cell lies in the scan window and is a grid wall or, on the outer ring, the
+// clamp target of an out-of-bounds cell in the window.
+static bool scan_sees(const Maze& maze, int cx, int cy, int col, int row) {
+    if (std::abs(col - cx) > SCAN_RADIUS || std::abs(row - cy) > SCAN_RADIUS) return false;
+    if (is_wall_cell(maze, col, row)) return true;
+    return (col == 0 && cx - SCAN_RADIUS < 0) || (row == 0 && cy - SCAN_RADIUS < 0) ||
+           (col == maze.width - 1 && cx + SCAN_RADIUS >= maze.width) ||
+           (row == maze.height - 1 && cy + SCAN_RADIUS >= maze.height);
+}
+
+// Candidate ordering shared by the transform and the query: smaller distance
+// first, then the scan's visiting order (row, then column).
+static bool closer(float d2, int row, int col, float best_d2, int best_row, int best_col) {
+    if (d2 != best_d2) return d2 < best_d2;
+    if (row != best_row) return row < best_row;
+    return col < best_col;
+}
+
+// ---------------------------------------------------------------------------
+// Exact scan
+// ---------------------------------------------------------------------------
+
+// Nearest vector from pos to the closest point ON THE SURFACE of any wall cell.
+// Using rectangle boundary (not cell centre) gives physically accurate distances
+// and prevents 1/r^2 from blowing up when a node sits just outside a wall face.
+Vec2 nearest_wall_vec_exact(const Maze& maze, const Vec2& pos) {
+    int cx = static_cast<int>(pos.x);
+    int cy = static_cast<int>(pos.y);
+
+    float best_dist2 = std::numeric_limits<float>::max();
+    Vec2  best_vec   = {0.0f, 0.0f};
+
+    const int R = SCAN_RADIUS;
+    for (int dy = -R; dy <= R; ++dy) {
+        for (int dx = -R; dx <= R; ++dx) {
+            int gx = cx + dx;
+            int gy = cy + dy;
+
+            bool  wall;
+            float cell_x0, cell_y0, cell_x1, cell_y1;
+            if (gx < 0 || gy < 0 || gx >= maze.width || gy >= maze.height) {
+                // Treat out-of-bounds as wall; clamp cell to grid boundary
+                int bx  = std::max(0, std::min(gx, maze.width  - 1));
+                int by  = std::max(0, std::min(gy, maze.height - 1));
+                cell_x0 = static_cast<float>(bx);
+                cell_y0 = static_cast<float>(by);
+                cell_x1 = cell_x0 + 1.0f;
+                cell_y1 = cell_y0 + 1.0f;
+                wall    = true;
+            } else {
+                wall    = is_wall_cell(maze, gx, gy);
+                cell_x0 = static_cast<float>(gx);
+                cell_y0 = static_cast<float>(gy);
+                cell_x1 = cell_x0 + 1.0f;
+                cell_y1 = cell_y0 + 1.0f;
+            }
+
+            if (!wall) continue;
+
+            // Nearest point on the wall cell's AABB to pos
+            float nx = clamp(pos.x, cell_x0, cell_x1);
+            float ny = clamp(pos.y, cell_y0, cell_y1);
+            float d2 = (pos.x - nx) * (pos.x - nx) + (pos.y - ny) * (pos.y - ny);
+
+            if (d2 < best_dist2) {
+                best_dist2 = d2;
+                best_vec   = {nx - pos.x, ny - pos.y};  // node -> wall surface
+            }
+        }
+    }
+    return best_vec;
+}
+
+// ---------------------------------------------------------------------------
+// Field construction
+//
+// Separable exact transform over unit wall boxes:
+//   1) per column c and lattice row v, the wall row closest in y;
+//   2) per lattice point, the column minimising h(c)^2 + v(c)^2, scanning
+//      outward from the point's own column until h(c)^2 alone exceeds the best.
+// ---------------------------------------------------------------------------
+
+WallField build_wall_field(const Maze& maze, int resolution) {
+    WallField field;
+    field.width      = maze.width;
+    field.height     = maze.height;
+    field.resolution = std::max(1, resolution);
+    field.lattice_w  = maze.width  * field.resolution + 1;
+    field.lattice_h  = maze.height * field.resolution + 1;
+    field.feature.assign(static_cast<size_t>(field.lattice_w) * field.lattice_h, -1);
+
+    const int W = maze.width;
+    const int H = maze.height;
+    const int S = field.resolution;
+    if (W <= 0 || H <= 0) return field;
+
+    // Nearest wall row at or above (<= y) / at or below (>= y), per column.
+    std::vector<int> up(static_cast<size_t>(W) * H, -1);
+    std::vector<int> down(static_cast<size_t>(W) * H, -1);
+    for (int c = 0; c < W; ++c) {
+        int last = -1;
+        for (int y = 0; y < H; ++y) {
+            if (is_field_wall_cell(maze, c, y)) last = y;
+            up[static_cast<size_t>(c) * H + y] = last;
+        }
+        last = -1;
+        for (int y = H - 1; y >= 0; --y) {
+            if (is_field_wall_cell(maze, c, y)) last = y;
+            down[static_cast<size_t>(c) * H + y] = last;
+        }
+    }
+
+    auto span_dist = [](float p, int cell) {
+        return std::max(0.0f, std::max(static_cast<float>(cell) - p,
+                                       p - static_cast<float>(cell + 1)));
+    };
+
+    // 1) Vertical pass.
+    std::vector<int>   v_row(static_cast<size_t>(W) * field.lattice_h, -1);
+    std::vector<float> v_dist(static_cast<size_t>(W) * field.lattice_h,
+                              std::numeric_limits<float>::infinity());
+    for (int c = 0; c < W; ++c) {
+        for (int v = 0; v < field.lattice_h; ++v) {
+            const float py = static_cast<float>(v) / static_cast<float>(S);
+            const int y = std::min(static_cast<int>(py), H - 1);
+            const size_t col_base = static_cast<size_t>(c) * H;
+
+            const int candidates[3] = {
+                up[col_base + y],
+                (y > 0) ? up[col_base + y - 1] : -1,  // touches when py == y
+                down[col_base + y]
+            };
+
+            int   best_row  = -1;
+            float best_dist = std::numeric_limits<float>::infinity();
+            for (int r : candidates) {
+                if (r < 0) continue;
+                const float d = span_dist(py, r);
+                if (d < best_dist || (d == best_dist && r < best_row)) {
+                    best_dist = d;
+                    best_row  = r;
+                }
+            }
+            const size_t slot = static_cast<size_t>(c) * field.lattice_h + v;
+            v_row[slot]  = best_row;
+            v_dist[slot] = best_dist;
+        }
+    }
+
+    // 2) Horizontal pass.
+    for (int v = 0; v < field.lattice_h; ++v) {
+        for (int u = 0; u < field.lattice_w; ++u) {
+            const float px = static_cast<float>(u) / static_cast<float>(S);
+            const int c0 = std::min(static_cast<int>(px), W - 1);
+
+            float best_d2  = std::numeric_limits<float>::infinity();
+            int   best_row = -1;
+            int   best_col = -1;
+
+            auto try_column = [&](int c) {
+                const size_t slot = static_cast<size_t>(c) * field.lattice_h + v;
+                const int r = v_row[slot];
+                if (r < 0) return;
+                const float h  = span_dist(px, c);
+                const float d2 = h * h + v_dist[slot] * v_dist[slot];
+                if (closer(d2, r, c, best_d2, best_row, best_col)) {
+                    best_d2  = d2;
+                    best_row = r;
+                    best_col = c;
+                }
+            };
+
+            for (int c = c0; c >= 0; --c) {
+                const float h = span_dist(px, c);
+                if (h * h > best_d2) break;
+                try_column(c);
+            }
+            for (int c = c0 + 1; c < W; ++c) {
+                const float h = span_dist(px, c);
+                if (h * h > best_d2) break;
+                try_column(c);
+            }
+
+            if (best_row >= 0) {
+                field.feature[static_cast<size_t>(v) * field.lattice_w + u] = best_row * W + best_col;
+            }
+        }
+    }
+
+    return field;
+}
+
+// ---------------------------------------------------------------------------
+// Queries
+// ---------------------------------------------------------------------------
+
+Vec2 wall_field_vec(const WallField& field, const Maze& maze, const Vec2& pos) {
+    if (!(pos.x >= 0.0f && pos.y >= 0.0f &&
+          pos.x < static_cast<float>(field.width) &&
+          pos.y < static_cast<float>(field.height)) ||
+        field.feature.empty()) {
+        return nearest_wall_vec_exact(maze, pos);
+    }
+
+    const int cx = static_cast<int>(pos.x);
+    const int cy = static_cast<int>(pos.y);
+    if (is_wall_cell(maze, cx, cy)) {
+        return {0.0f, 0.0f};  // inside a wall: distance 0
+    }
+
+    const float S = static_cast<float>(field.resolution);
+    const int iu = std::min(static_cast<int>(pos.x * S), field.lattice_w - 2);
+    const int iv = std::min(static_cast<int>(pos.y * S), field.lattice_h - 2);
+
+    float best_d2  = std::numeric_limits<float>::max();
+    int   best_row = -1;
+    int   best_col = -1;
+    Vec2  best_vec = {0.0f, 0.0f};
+
+    for (int dv = 0; dv <= 1; ++dv) {
+        for (int du = 0; du <= 1; ++du) {
+            const int f = field.feature[static_cast<size_t>(iv + dv) * field.lattice_w + (iu + du)];
+            if (f < 0) continue;
+            const int row = f / field.width;
+            const int col = f % field.width;
+
+            const float x0 = static_cast<float>(col);
+            const float y0 = static_cast<float>(row);
+            const float nx = clamp(pos.x, x0, x0 + 1.0f);
+            const float ny = clamp(pos.y, y0, y0 + 1.0f);
+            const float d2 = (pos.x - nx) * (pos.x - nx) + (pos.y - ny) * (pos.y - ny);
+
+            if (closer(d2, row, col, best_d2, best_row, best_col)) {
+                best_d2  = d2;
+                best_row = row;
+                best_col = col;
+                best_vec = {nx - pos.x, ny - pos.y};
+            }
+        }
+    }
+
+    // The field knows the nearest wall anywhere in the maze; the exact scan
+    // only looks SCAN_RADIUS cells around the position. Where the two differ
+    // (open areas wider than the window), answer as the scan does.
+    if (best_row < 0 || !scan_sees(maze, cx, cy, best_col, best_row)) {
+        return nearest_wall_vec_exact(maze, pos);
+    }
+    return best_vec;
+}
+
+float wall_field_max_deviation(const WallField& field, const Maze& maze, int samples_per_cell) {
+    const int s = std::max(1, samples_per_cell);
+    float max_dev = 0.0f;
+
+    for (int row = 0; row < maze.height; ++row) {
+        for (int col = 0; col < maze.width; ++col) {
+            if (maze.grid[row][col] != 0) continue;
+            for (int j = 0; j < s; ++j) {
+                for (int i = 0; i < s; ++i) {
+                    const Vec2 p = {
+                        static_cast<float>(col) + (static_cast<float>(i) + 0.5f) / static_cast<float>(s),
+                        static_cast<float>(row) + (static_cast<float>(j) + 0.5f) / static_cast<float>(s)
+                    };
+                    const Vec2 a = wall_field_vec(field, maze, p);
+                    const Vec2 b = nearest_wall_vec_exact(maze, p);
+                    const float dx = a.x - b.x;
+                    const float dy = a.y - b.y;
+                    max_dev = std::max(max_dev, std::sqrt(dx * dx + dy * dy));
+                }
+            }
+        }
+    }
+    return max_dev;
+}
+
+} // namespace sim
@@ -0,0 +1,54 @@
+#pragma once
+
+#include "graph.h"  // sim::Vec2
+#include "maze.h"
+#include <vector>
+
+namespace sim {
+
+// ---------------------------------------------------------------------------
+// Precomputed nearest-wall field
+//
+// The maze is static during a run, so the nearest wall cell is tabulated once
+// on a lattice with `resolution` samples per cell (lattice point (u, v) sits at
+// world position (u / resolution, v / resolution)). The table is an exact
+// Euclidean feature transform over wall boxes: for every lattice point it
+// stores the wall cell whose AABB is closest.
+//
+// A query evaluates the exact surface vector against the wall cells stored at
+// the four lattice points around the position and keeps the closest. Blending
+// the four vectors instead would cancel them out on corridor mid-lines, where
+// the nearest wall flips from one side to the other.
+//
+// Wall cells are grid walls plus the outer ring of cells, which is how the
+// exact scan treats out-of-bounds cells. The table has no search radius, but
+// the exact scan only sees walls within 6 cells: a query whose nearest wall
+// the scan would not see (open areas wider than that) uses the scan instead,
+// so both agree on any maze.
+// ---------------------------------------------------------------------------
+
+struct WallField {
+    int width      = 0;  // maze cells (x)
+    int height     = 0;  // maze cells (y)
+    int resolution = 0;  // lattice samples per cell
+    int lattice_w  = 0;  // width  * resolution + 1
+    int lattice_h  = 0;  // height * resolution + 1
+    std::vector<int> feature;  // nearest wall cell (row * width + col), -1 if none
+};
+
+// Exact reference: scan the (2R+1)^2 cells around `pos` (R = 6) and return the
+// vector from `pos` to the closest point on any wall cell surface.
+Vec2 nearest_wall_vec_exact(const Maze& maze, const Vec2& pos);
+
+// Build the field for `maze` with `resolution` lattice samples per cell.
+WallField build_wall_field(const Maze& maze, int resolution);
+
+// O(1) nearest-wall vector from the field. Positions outside the maze fall
+// back to the exact scan.
+Vec2 wall_field_vec(const WallField& field, const Maze& maze, const Vec2& pos);
+
+// Largest |field - exact| vector difference over a regular sample of
+// `samples_per_cell`^2 points in every passage cell.
+float wall_field_max_deviation(const WallField& field, const Maze& maze, int samples_per_cell);
+
+} // namespace sim
@@ -0,0 +1,751 @@
+// sweep: in-process hyperparameter search.
+//
+// Every case scales some hyperparameters of a base config by multipliers and
+// is scored on `trials` maze seeds. All case x seed trials of a batch run on
+// one work-stealing pool (trial_scheduler.h) in this process; the model and
+// the seeds' mazes are loaded / built once. Each finished case becomes one row
+// of the results table.
+//
+// Score per case: the persistent_after_first_connection ratio of
+// results/analyze_connected_metrics.py -- the fraction of seeds whose sources
+// get connected by step T = min(persistent_until_step, steps) and stay
+// connected through T -- with the persistent seed count as tie-break.
+//
+// Modes:
+//   sweep  baseline, every parameter alone at (1 +- delta) for each delta, and
+//          `random_combos` cases drawing each multiplier from {1, 1 +- delta}.
+//   hill   stochastic hill-climb over the multipliers with restarts, a fine
+//          phase and optional simulated annealing acceptance.
+//
+// Usage:
+//   sweep [--option value ...]   (see print_usage)
+
+#include "node_nn/nn.h"
+#include "node_nn/utils/io.h"
+#include "graph.h"
+#include "maze.h"
+#include "step_workspace.h"
+#include "trial_scheduler.h"
+#include "config.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <iterator>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace {
+
+const std::vector<std::string> TARGET_PARAMS = {
+    "ENERGY_MAINTENANCE_COST",
+    "ENERGY_MAINTENANCE_PER_WEIGHT",
+    "ENERGY_DIFFUSION_ALPHA",
+    "ENERGY_FLOW_GAIN",
+    "ENERGY_PULSE_LOW_RATIO",
+    "ENERGY_PULSE_SINK_VALUE",
+    "ENERGY_IMPORTANCE_SCALE",
+    "ENERGY_DEATH_PATIENCE",
+    "ENERGY_COST_EDGE_THICKEN",
+    "ENERGY_COST_NEW_CONNECTION",
+    "ENERGY_COST_SPROUT",
+    "ENERGY_CHILD_INITIAL",
+    "APOPTOSIS_WARMUP_STEPS",
+    "NN_APOPTOSIS_ENERGY_GATE",
+};
+
+// ---------------------------------------------------------------------------
+// Options
+// ---------------------------------------------------------------------------
+
+struct Options {
+    std::string base_hparams = "hyperparameters.txt";
+    std::string model;                   // empty: node_nn_model.nn, ../node_nn_model.nn
+    std::string mode = "sweep";          // sweep | hill
+    std::string out;                     // empty: results/hparam_sweep/<mode>_results.csv
+    std::vector<std::string> params = TARGET_PARAMS;
+
+    int      trials = 512;
+    int      steps = 1200;
+    int      cols = 5;
+    int      rows = 5;
+    unsigned seed_start = 0;
+    int      persistent_until_step = 1075;
+    sim::TrialSchedulerOptions scheduler;
+
+    std::vector<double> deltas = {0.02, 0.03};
+    int      random_combos = 24;
+    unsigned random_seed = 42;
+
+    int    hc_iters = 250;
+    int    hc_restarts = 5;
+    int    hc_k = 3;                     // parameters changed per hill step
+    int    hc_k_fine = 1;                // ... in the fine phase
+    int    hc_patience = 40;             // non-accepted steps before a restart ends
+    double hc_min_mult = 0.5;
+    double hc_max_mult = 1.5;
+    std::vector<double> hc_fine_deltas = {0.01};
+    double hc_fine_after = 0.6;          // fine phase after this fraction of iterations
+    bool   hc_anneal = false;
+    double hc_temp_start = 0.01;
+    double hc_temp_end = 0.0005;
+};
+
+void print_usage() {
+    std::cout <<
+        "Usage: sweep [options]\n"
+        "  --base-hparams PATH        base config (hyperparameters.txt)\n"
+        "  --model PATH               trained model (node_nn_model.nn)\n"
+        "  --mode sweep|hill          case list (sweep)\n"
+        "  --out PATH                 results table (results/hparam_sweep/<mode>_results.csv)\n"
+        "  --params A,B,...           parameters to vary (energy / apoptosis set);\n"
+        "                             not the maze ones (WALL_FIELD_*, USE_LOS_CACHE)\n"
+        "  --trials N --steps N --cols N --rows N --seed-start N\n"
+        "  --persistent-until-step N  (1075)\n"
+        "  --threads N                0: all hardware threads (0)\n"
+        "  --pin-threads 0|1  --reorder-window N\n"
+        "  --deltas D,D,...           multipliers 1 +- D (0.02,0.03)\n"
+        "  --random-combos N --random-seed N\n"
+        "  --hc-iters N --hc-restarts N --hc-k N --hc-k-fine N --hc-patience N\n"
+        "  --hc-min-mult X --hc-max-mult X --hc-fine-deltas D,... --hc-fine-after X\n"
+        "  --hc-anneal --hc-temp-start X --hc-temp-end X\n";
+}
+
+std::vector<std::string> split_list(const std::string& text) {
+    std::vector<std::string> items;
+    std::stringstream ss(text);
+    std::string item;
+    while (std::getline(ss, item, ',')) {
+        if (!item.empty()) items.push_back(item);
+    }
+    return items;
+}
+
+std::vector<double> parse_deltas(const std::string& text) {
+    std::vector<double> deltas;
+    for (const std::string& item : split_list(text)) {
+        const double d = std::stod(item);
+        if (d <= 0.0 || d >= 1.0) {
+            throw std::invalid_argument("delta " + item + " is not in (0, 1)");
+        }
+        deltas.push_back(d);
+    }
+    if (deltas.empty()) throw std::invalid_argument("no deltas in '" + text + "'");
+    return deltas;
+}
+
+// Fills `options` from argv; false (after printing why) on a bad argument.
+bool parse_options(int argc, char* argv[], Options& options) {
+    try {
+        for (int i = 1; i < argc; ++i) {
+            const std::string arg = argv[i];
+            if (arg == "--help" || arg == "-h") {
+                print_usage();
+                std::exit(0);
+            }
+            if (arg == "--hc-anneal") {
+                options.hc_anneal = true;
+                continue;
+            }
+            if (i + 1 >= argc) {
+                std::cerr << "Error: missing value for " << arg << "\n";
+                return false;
+            }
+            const std::string value = argv[++i];
+
+            if      (arg == "--base-hparams")          options.base_hparams = value;
+            else if (arg == "--model")                 options.model = value;
+            else if (arg == "--mode")                  options.mode = value;
+            else if (arg == "--out")                   options.out = value;
+            else if (arg == "--params")                options.params = split_list(value);
+            else if (arg == "--trials")                options.trials = std::max(1, std::stoi(value));
+            else if (arg == "--steps")                 options.steps = std::max(1, std::stoi(value));
+            else if (arg == "--cols")                  options.cols = std::max(2, std::stoi(value));
+            else if (arg == "--rows")                  options.rows = std::max(2, std::stoi(value));
+            else if (arg == "--seed-start")            options.seed_start = static_cast<unsigned>(std::stoul(value));
+            else if (arg == "--persistent-until-step") options.persistent_until_step = std::max(0, std::stoi(value));
+            else if (arg == "--threads")               options.scheduler.threads = std::stoi(value);
+            else if (arg == "--pin-threads")           options.scheduler.pin_threads = (std::stoi(value) != 0);
+            else if (arg == "--reorder-window")        options.scheduler.reorder_window = std::stoi(value);
+            else if (arg == "--deltas")                options.deltas = parse_deltas(value);
+            else if (arg == "--random-combos")         options.random_combos = std::max(0, std::stoi(value));
+            else if (arg == "--random-seed")           options.random_seed = static_cast<unsigned>(std::stoul(value));
+            else if (arg == "--hc-iters")              options.hc_iters = std::max(0, std::stoi(value));
+            else if (arg == "--hc-restarts")           options.hc_restarts = std::max(0, std::stoi(value));
+            else if (arg == "--hc-k")                  options.hc_k = std::stoi(value);
+            else if (arg == "--hc-k-fine")             options.hc_k_fine = std::stoi(value);
+            else if (arg == "--hc-patience")           options.hc_patience = std::stoi(value);
+            else if (arg == "--hc-min-mult")           options.hc_min_mult = std::stod(value);
+            else if (arg == "--hc-max-mult")           options.hc_max_mult = std::stod(value);
+            else if (arg == "--hc-fine-deltas")        options.hc_fine_deltas = parse_deltas(value);
+            else if (arg == "--hc-fine-after")         options.hc_fine_after = std::stod(value);
+            else if (arg == "--hc-temp-start")         options.hc_temp_start = std::stod(value);
+            else if (arg == "--hc-temp-end")           options.hc_temp_end = std::stod(value);
+            else {
+                std::cerr << "Error: unknown option " << arg << "\n";
+                print_usage();
+                return false;
+            }
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << "\n";
+        return false;
+    }
+
+    if (options.mode != "sweep" && options.mode != "hill") {
+        std::cerr << "Error: --mode must be sweep or hill\n";
+        return false;
+    }
+    if (options.params.empty()) {
+        std::cerr << "Error: --params is empty\n";
+        return false;
+    }
+    if (options.out.empty()) {
+        options.out = "results/hparam_sweep/" + options.mode + "_results.csv";
+    }
+    return true;
+}
+
+// ---------------------------------------------------------------------------
+// Cases
+// ---------------------------------------------------------------------------
+
+struct ParamDef {
+    std::string key;
+    double      base;       // value in the base config
+    bool        int_style;  // written without '.' or exponent in the base file
+};
+
+// Parameters that prepare_maze reads. The seeds' mazes are built once from the
+// base config, so a case could not change them.
+const char* const MAZE_PARAMS[] = {
+    "WALL_FIELD_ENABLE", "WALL_FIELD_RESOLUTION", "WALL_FIELD_VALIDATE", "USE_LOS_CACHE",
+};
+
+// A case scales the listed parameters (index into the ParamDef list); the
+// others keep their base values.
+struct Case {
+    std::string name;
+    std::string type;
+    std::vector<std::pair<int, double>> multipliers;
+};
+
+// Keys whose value in `path` is written as an integer. Those are tuned in
+// whole steps of at least 1.
+std::vector<std::string> int_style_keys(const std::string& path) {
+    std::vector<std::string> keys;
+    std::ifstream ifs(path);
+    std::string line;
+    while (std::getline(ifs, line)) {
+        const size_t hash = line.find('#');
+        if (hash != std::string::npos) line.erase(hash);
+        const size_t eq = line.find('=');
+        if (eq == std::string::npos) continue;
+
+        std::string key = line.substr(0, eq);
+        std::string value = line.substr(eq + 1);
+        key.erase(0, key.find_first_not_of(" \t"));
+        key.erase(key.find_last_not_of(" \t\r") + 1);
+        value.erase(0, value.find_first_not_of(" \t"));
+        value.erase(value.find_last_not_of(" \t\r") + 1);
+        if (key.empty() || value.empty()) continue;
+        if (value.find_first_of(".eE") == std::string::npos) keys.push_back(key);
+    }
+    return keys;
+}
+
+double tuned_value(const ParamDef& def, double multiplier) {
+    const double raw = def.base * multiplier;
+    return def.int_style ? std::max(1.0, std::round(raw)) : raw;
+}
+
+sim::SimConfig case_config(const sim::SimConfig& base,
+                           const std::vector<ParamDef>& defs,
+                           const Case& c) {
+    sim::SimConfig config = base;
+    for (const auto& m : c.multipliers) {
+        const ParamDef& def = defs[static_cast<size_t>(m.first)];
+        sim::set_config_value(config, def.key, static_cast<float>(tuned_value(def, m.second)));
+    }
+    return config;
+}
+
+std::string multiplier_suffix(double multiplier) {
+    std::ostringstream oss;
+    oss.setf(std::ios::fixed);
+    oss.precision(3);
+    oss << multiplier;
+    std::string s = oss.str();
+    std::replace(s.begin(), s.end(), '.', 'p');
+    return s;
+}
+
+std::vector<double> multiplier_choices(const std::vector<double>& deltas) {
+    std::vector<double> choices = {1.0};
+    for (double d : deltas) {
+        choices.push_back(1.0 - d);
+        choices.push_back(1.0 + d);
+    }
+    return choices;
+}
+
+template <typename T>
+const T& choose(const std::vector<T>& items, std::mt19937& rng) {
+    std::uniform_int_distribution<size_t> pick(0, items.size() - 1);
+    return items[pick(rng)];
+}
+
+std::vector<Case> build_sweep_cases(const std::vector<ParamDef>& defs, const Options& options) {
+    std::vector<Case> cases;
+    cases.push_back({"baseline", "baseline", {}});
+
+    for (size_t p = 0; p < defs.size(); ++p) {
+        std::string lower = defs[p].key;
+        std::transform(lower.begin(), lower.end(), lower.begin(),
+                       [](unsigned char ch) { return static_cast<char>(std::tolower(ch)); });
+        for (double d : options.deltas) {
+            for (double m : {1.0 - d, 1.0 + d}) {
+                cases.push_back({"one_" + lower + "_" + multiplier_suffix(m), "one_factor",
+                                 {{static_cast<int>(p), m}}});
+            }
+        }
+    }
+
+    std::mt19937 rng(options.random_seed);
+    const std::vector<double> choices = multiplier_choices(options.deltas);
+    for (int i = 0; i < options.random_combos; ++i) {
+        Case c;
+        std::ostringstream name;
+        name << "combo_" << std::setw(4) << std::setfill('0') << i;
+        c.name = name.str();
+        c.type = "combo";
+        for (size_t p = 0; p < defs.size(); ++p) {
+            c.multipliers.push_back({static_cast<int>(p), choose(choices, rng)});
+        }
+        cases.push_back(std::move(c));
+    }
+    return cases;
+}
+
+// ---------------------------------------------------------------------------
+// Evaluation
+// ---------------------------------------------------------------------------
+
+// Connection history of one seed, up to what the score needs.
+struct SeedMetrics {
+    int  first_connected = -1;          // first step connected, -1: never
+    int  first_drop = -1;               // first connected -> disconnected step
+    int  drops_until_threshold = 0;
+    bool connected_at_threshold = false;
+};
+
+struct CaseScore {
+    int    persistent_count = 0;
+    double persistent_ratio = 0.0;
+    double first_disappear_mean = 0.0;  // mean first_drop over seeds that dropped
+};
+
+bool is_better(const CaseScore& a, const CaseScore& b) {
+    if (a.persistent_ratio != b.persistent_ratio) return a.persistent_ratio > b.persistent_ratio;
+    return a.persistent_count > b.persistent_count;
+}
+
+double scalar_score(const CaseScore& s) {
+    return s.persistent_ratio + s.persistent_count * 1.0e-6;
+}
+
+bool anneal_accept(const CaseScore& current, const CaseScore& candidate,
+                   double temperature, std::mt19937& rng) {
+    if (is_better(candidate, current)) return true;
+    if (temperature <= 0.0) return false;
+    const double delta = scalar_score(candidate) - scalar_score(current);
+    std::uniform_real_distribution<double> uniform(0.0, 1.0);
+    return uniform(rng) < std::exp(delta / temperature);
+}
+
+// Everything shared by all trials: model, one maze per seed, run shape.
+struct TrialContext {
+    const node_nn::Model*      nn = nullptr;
+    std::vector<sim::Maze>     mazes;      // mazes[s]: seed seed_start + s
+    int                        steps = 0;
+    int                        threshold = 0;
+    sim::TrialSchedulerOptions scheduler;
+};
+
+SeedMetrics run_seed(const TrialContext& ctx, const sim::SimConfig& config, const sim::Maze& maze) {
+    sim::Graph graph = sim::build_initial_graph(maze, config);
+    sim::StepWorkspace workspace;
+    const sim::Vec2 target = {
+        static_cast<float>(maze.width) - 1.5f,
+        static_cast<float>(maze.height) - 1.5f
+    };
+
+    SeedMetrics metrics;
+    bool previous = false;
+    for (int t = 0; t <= ctx.steps; ++t) {
+        const bool connected = sim::sources_connected(graph, 1.0e-6f);
+        if (connected && metrics.first_connected < 0) metrics.first_connected = t;
+        if (previous && !connected) {
+            if (metrics.first_drop < 0) metrics.first_drop = t;
+            if (t <= ctx.threshold) ++metrics.drops_until_threshold;
+        }
+        if (t == ctx.threshold) metrics.connected_at_threshold = connected;
+        previous = connected;
+
+        if (t < ctx.steps) {
+            sim::step(graph, *ctx.nn, target, maze, config, &workspace);
+        }
+    }
+    return metrics;
+}
+
+CaseScore score_case(const TrialContext& ctx, const SeedMetrics* seeds, int count) {
+    CaseScore score;
+    int drops = 0;
+    double drop_sum = 0.0;
+    for (int s = 0; s < count; ++s) {
+        const SeedMetrics& m = seeds[s];
+        if (m.first_connected >= 0 && m.first_connected <= ctx.threshold &&
+            m.drops_until_threshold == 0 && m.connected_at_threshold) {
+            ++score.persistent_count;
+        }
+        if (m.first_drop >= 0) {
+            ++drops;
+            drop_sum += m.first_drop;
+        }
+    }
+    score.persistent_ratio = count > 0 ? static_cast<double>(score.persistent_count) / count : 0.0;
+    score.first_disappear_mean = drops > 0 ? drop_sum / drops : 0.0;
+    return score;
+}
+
+// Runs every config on every seed as one batch of trials and calls
+// `done(case, score)` in case order as soon as all seeds of a case finished.
+void evaluate_cases(const TrialContext& ctx,
+                    const std::vector<sim::SimConfig>& configs,
+                    const std::function<void(int, const CaseScore&)>& done) {
+    const int seeds = static_cast<int>(ctx.mazes.size());
+    std::vector<SeedMetrics> metrics(configs.size() * ctx.mazes.size());
+    sim::run_trials(
+        static_cast<int>(metrics.size()),
+        ctx.scheduler,
+        [](int) { return 1.0; },
+        [&](int trial) {
+            const int c = trial / seeds;
+            const int s = trial % seeds;
+            metrics[static_cast<size_t>(trial)] = run_seed(ctx, configs[static_cast<size_t>(c)],
+                                                           ctx.mazes[static_cast<size_t>(s)]);
+            return std::string();
+        },
+        [&](int trial, std::string&) {
+            if ((trial + 1) % seeds != 0) return;
+            const int c = trial / seeds;
+            done(c, score_case(ctx, metrics.data() + static_cast<size_t>(c) * seeds, seeds));
+        });
+}
+
+// ---------------------------------------------------------------------------
+// Results table
+// ---------------------------------------------------------------------------
+
+struct ResultRow {
+    std::string name;
+    std::string type;
+    int         restart = 0;
+    int         iteration = 0;
+    std::string accepted;    // "", "0" or "1"
+    CaseScore   score;
+};
+
+class ResultsTable {
+public:
+    ResultsTable(const Options& options, const std::vector<ParamDef>& defs)
+        : mode_(options.mode), defs_(defs) {
+        const std::filesystem::path path(options.out);
+        if (path.has_parent_path()) std::filesystem::create_directories(path.parent_path());
+
+        // Appending continues the run_index of an existing table.
+        bool has_header = false;
+        {
+            std::ifstream ifs(options.out);
+            std::string line;
+            while (std::getline(ifs, line)) {
+                if (!has_header) {
+                    has_header = true;
+                    continue;
+                }
+                try {
+                    run_index_ = std::max(run_index_, std::stoi(line.substr(0, line.find(','))));
+                } catch (...) {
+                }
+            }
+        }
+        if (run_index_ > 0) {
+            std::cout << "Resuming: next run_index starts at " << run_index_ + 1 << "\n";
+        }
+
+        ofs_.open(options.out, std::ios::out | std::ios::app);
+        if (!has_header && ofs_) {
+            ofs_ << "run_index,run_name,case_type,mode,restart,iteration,accepted,"
+                    "persistent_count,persistent_ratio,first_disappear_step_mean";
+            for (const ParamDef& def : defs_) ofs_ << ',' << def.key;
+            ofs_ << '\n';
+        }
+        ofs_.precision(10);
+    }
+
+    bool ok() const { return static_cast<bool>(ofs_); }
+
+    // Appends `row` for case `c` and returns its run_index.
+    int write(const ResultRow& row, const Case& c) {
+        std::vector<double> values;
+        for (const ParamDef& def : defs_) values.push_back(def.base);
+        for (const auto& m : c.multipliers) {
+            values[static_cast<size_t>(m.first)] = tuned_value(defs_[static_cast<size_t>(m.first)], m.second);
+        }
+
+        ++run_index_;
+        ofs_ << run_index_ << ',' << row.name << ',' << row.type << ',' << mode_ << ','
+             << row.restart << ',' << row.iteration << ',' << row.accepted << ','
+             << row.score.persistent_count << ',' << row.score.persistent_ratio << ','
+             << row.score.first_disappear_mean;
+        for (double v : values) ofs_ << ',' << std::setprecision(7) << v << std::setprecision(10);
+        ofs_ << '\n';
+        ofs_.flush();
+        return run_index_;
+    }
+
+private:
+    std::string                  mode_;
+    const std::vector<ParamDef>& defs_;
+    std::ofstream                ofs_;
+    int                          run_index_ = 0;
+};
+
+// ---------------------------------------------------------------------------
+// Modes
+// ---------------------------------------------------------------------------
+
+void run_sweep(const TrialContext& ctx, const sim::SimConfig& base,
+               const std::vector<ParamDef>& defs, const Options& options, ResultsTable& table) {
+    const std::vector<Case> cases = build_sweep_cases(defs, options);
+    std::vector<sim::SimConfig> configs;
+    for (const Case& c : cases) configs.push_back(case_config(base, defs, c));
+    std::cout << "Total sweep runs planned: " << cases.size() << "\n";
+
+    evaluate_cases(ctx, configs, [&](int i, const CaseScore& score) {
+        const Case& c = cases[static_cast<size_t>(i)];
+        ResultRow row;
+        row.name = c.name;
+        row.type = c.type;
+        row.score = score;
+        table.write(row, c);
+        std::cout << "[OK] " << (i + 1) << "/" << cases.size() << " " << c.name
+                  << " ratio=" << score.persistent_ratio << "\n";
+    });
+}
+
+void run_hill(const TrialContext& ctx, const sim::SimConfig& base,
+              const std::vector<ParamDef>& defs, const Options& options, ResultsTable& table) {
+    const int param_count = static_cast<int>(defs.size());
+    std::mt19937 rng(options.random_seed);
+    const std::vector<double> local_choices = multiplier_choices(options.deltas);
+    const double fine_after = std::min(1.0, std::max(0.0, options.hc_fine_after));
+    auto clamp_mult = [&](double m) {
+        return std::max(options.hc_min_mult, std::min(options.hc_max_mult, m));
+    };
+
+    auto make_case = [&](const std::string& name, const std::string& type,
+                         const std::vector<double>& mult) {
+        Case c{name, type, {}};
+        for (int p = 0; p < param_count; ++p) c.multipliers.push_back({p, mult[static_cast<size_t>(p)]});
+        return c;
+    };
+    auto evaluate = [&](const Case& c) {
+        CaseScore score;
+        evaluate_cases(ctx, {case_config(base, defs, c)},
+                       [&](int, const CaseScore& s) { score = s; });
+        return score;
+    };
+
+    CaseScore best_score;
+    best_score.persistent_ratio = -1.0;
+    best_score.persistent_count = -1;
+    std::string best_name;
+
+    std::cout << "Hill-climb mode: restarts=" << options.hc_restarts
+              << ", iters=" << options.hc_iters << ", k=" << options.hc_k
+              << ", patience=" << options.hc_patience << "\n";
+
+    for (int restart = 0; restart < options.hc_restarts; ++restart) {
+        std::vector<double> current(static_cast<size_t>(param_count), 1.0);
+        if (restart > 0) {
+            for (double& m : current) m = clamp_mult(m * choose(local_choices, rng));
+        }
+
+        std::ostringstream init_name;
+        init_name << "hc_r" << std::setw(2) << std::setfill('0') << restart << "_init";
+        const Case init = make_case(init_name.str(), "hill_init", current);
+        CaseScore current_score = evaluate(init);
+        ResultRow init_row{init.name, init.type, restart, 0, "1", current_score};
+        table.write(init_row, init);
+        std::cout << "[OK] " << init.name << " ratio=" << current_score.persistent_ratio << "\n";
+
+        if (is_better(current_score, best_score)) {
+            best_score = current_score;
+            best_name = init.name;
+        }
+
+        int no_improve = 0;
+        std::vector<int> order(static_cast<size_t>(param_count));
+        for (int iteration = 1; iteration <= options.hc_iters; ++iteration) {
+            const bool fine = (static_cast<double>(iteration) / std::max(1, options.hc_iters)) >= fine_after;
+            const std::vector<double>& active_deltas = fine ? options.hc_fine_deltas : options.deltas;
+            const int k = std::max(1, std::min(fine ? options.hc_k_fine : options.hc_k, param_count));
+
+            // k distinct parameters, each moved by one (fine) delta up or down.
+            std::vector<double> candidate = current;
+            for (int p = 0; p < param_count; ++p) order[static_cast<size_t>(p)] = p;
+            for (int j = 0; j < k; ++j) {
+                std::uniform_int_distribution<int> pick(j, param_count - 1);
+                std::swap(order[static_cast<size_t>(j)], order[static_cast<size_t>(pick(rng))]);
+                const int p = order[static_cast<size_t>(j)];
+                const double delta = choose(active_deltas, rng);
+                const double direction = std::uniform_int_distribution<int>(0, 1)(rng) ? 1.0 : -1.0;
+                candidate[static_cast<size_t>(p)] =
+                    clamp_mult(candidate[static_cast<size_t>(p)] * (1.0 + direction * delta));
+            }
+
+            const double progress = (options.hc_iters <= 1) ? 1.0
+                : static_cast<double>(iteration - 1) / (options.hc_iters - 1);
+            const double temperature =
+                options.hc_temp_start + (options.hc_temp_end - options.hc_temp_start) * progress;
+
+            std::ostringstream name;
+            name << "hc_r" << std::setw(2) << std::setfill('0') << restart
+                 << "_it" << std::setw(4) << iteration;
+            const Case c = make_case(name.str(), "hill_step", candidate);
+            const CaseScore score = evaluate(c);
+
+            const bool accepted = options.hc_anneal
+                ? anneal_accept(current_score, score, temperature, rng)
+                : is_better(score, current_score);
+            if (accepted) {
+                current = candidate;
+                current_score = score;
+                no_improve = 0;
+            } else {
+                ++no_improve;
+            }
+            if (is_better(score, best_score)) {
+                best_score = score;
+                best_name = c.name;
+            }
+
+            ResultRow row{c.name, c.type, restart, iteration, accepted ? "1" : "0", score};
+            table.write(row, c);
+            std::cout << "[HC] restart=" << restart << " iter=" << iteration
+                      << " ratio=" << score.persistent_ratio << " accepted=" << (accepted ? 1 : 0)
+                      << " best=" << best_score.persistent_ratio << " temp=" << temperature << "\n";
+
+            if (no_improve >= options.hc_patience) {
+                std::cout << "[HC] restart=" << restart << " early-stop at iter=" << iteration
+                          << " (patience)\n";
+                break;
+            }
+        }
+    }
+
+    std::cout << "[HC] best ratio=" << best_score.persistent_ratio
+              << " count=" << best_score.persistent_count << " run=" << best_name << "\n";
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    std::cout.setf(std::ios::unitbuf);
+
+    Options options;
+    if (!parse_options(argc, argv, options)) return 2;
+
+    std::string config_path = options.base_hparams;
+    if (!std::filesystem::exists(config_path) &&
+        std::filesystem::exists("../" + config_path)) {
+        config_path = "../" + config_path;
+    }
+    sim::SimConfig base;
+    if (!sim::load_config(config_path, base)) {
+        std::cerr << "Error: cannot read base config " << options.base_hparams << "\n";
+        return 1;
+    }
+
+    const std::vector<std::string> int_keys = int_style_keys(config_path);
+    std::vector<ParamDef> defs;
+    for (const std::string& key : options.params) {
+        float value = 0.0f;
+        if (!sim::get_config_value(base, key, value)) {
+            std::cerr << "Error: unknown parameter " << key << "\n";
+            return 1;
+        }
+        if (std::find(std::begin(MAZE_PARAMS), std::end(MAZE_PARAMS), key) != std::end(MAZE_PARAMS)) {
+            std::cerr << "Error: " << key << " is fixed when the mazes are built; set it in the "
+                      << "base config instead of --params\n";
+            return 1;
+        }
+        const bool int_style = std::find(int_keys.begin(), int_keys.end(), key) != int_keys.end();
+        defs.push_back({key, value, int_style});
+    }
+
+    node_nn::Model nn;
+    std::vector<std::string> model_paths = {"node_nn_model.nn", "../node_nn_model.nn"};
+    if (!options.model.empty()) model_paths = {options.model};
+    std::string model_path;
+    for (const auto& p : model_paths) {
+        if (node_nn::load_model(p, nn)) {
+            model_path = p;
+            break;
+        }
+    }
+    if (model_path.empty()) {
+        std::cerr << "Error: Could not load trained model node_nn_model.nn\n";
+        return 1;
+    }
+    std::cout << "Loaded model: " << model_path << "\n";
+
+    TrialContext ctx;
+    ctx.nn = &nn;
+    ctx.steps = options.steps;
+    ctx.threshold = std::min(options.persistent_until_step, options.steps);
+    ctx.scheduler = options.scheduler;
+    for (int s = 0; s < options.trials; ++s) {
+        ctx.mazes.push_back(sim::generate_maze(options.cols, options.rows,
+                                               options.seed_start + static_cast<unsigned>(s), base));
+    }
+
+    ResultsTable table(options, defs);
+    if (!table.ok()) {
+        std::cerr << "Error: cannot write results table: " << options.out << "\n";
+        return 1;
+    }
+    std::cout << "Running with " << sim::trial_thread_count(options.scheduler, options.trials)
+              << " threads, " << options.trials << " seeds per case\n";
+
+    if (options.mode == "hill") {
+        run_hill(ctx, base, defs, options, table);
+    } else {
+        run_sweep(ctx, base, defs, options, table);
+    }
+
+    std::cout << "\n" << (options.mode == "hill" ? "Hill" : "Sweep") << " completed.\n"
+              << "- Results table: " << std::filesystem::absolute(options.out).string() << "\n";
+    return 0;
+}
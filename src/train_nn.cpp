@@ -1,16 +1,122 @@
+// train_nn: supervised training of the node network on a CSV of sensor
+// inputs and target vibes.
+//
+// Each epoch shuffles the training split and runs Adam over mini-batches of
+// `--batch` samples (0: the whole split, one update per epoch). A batch is cut
+// into fixed shards of SHARD_SIZE samples whose gradients are computed in
+// parallel on a thread pool and summed in shard order, so a run gives the same
+// model for any thread count. The learning rate follows `--schedule`.
+//
+// Usage:
+//   train_nn [csv] [epochs] [out] [test_ratio] [tanh|fast] [hidden] [init_model]
+//            [--option value ...]   (see print_usage)
+
 #include "node_nn/nn.h"
 #include "node_nn/utils/io.h"
+#include "thread_pool.h"
 
 #include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
 #include <filesystem>
 #include <iostream>
 #include <numeric>
 #include <random>
+#include <stdexcept>
 #include <string>
+#include <thread>
+#include <variant>
 #include <vector>
 
 namespace {
 
+// Samples per gradient shard: the unit of parallel work and of the ordered
+// reduction. Independent of the thread count.
+constexpr int SHARD_SIZE = 64;
+
+enum class Schedule { CONSTANT, STEP, COSINE };
+
+struct Options {
+    std::vector<std::string> positional;
+
+    int      batch_size    = 256;   // 0: full batch
+    int      threads       = 0;     // <= 0: std::thread::hardware_concurrency()
+    float    learning_rate = node_nn::LEARNING_RATE;
+    Schedule schedule      = Schedule::CONSTANT;
+    float    lr_min        = 0.0f;  // cosine: final learning rate
+    int      step_epochs   = 10;    // step: epochs per decay
+    float    step_gamma    = 0.5f;  // step: decay factor
+    unsigned seed          = 42;    // data split and batch order
+};
+
+void print_usage() {
+    std::cout <<
+        "Usage: train_nn [csv] [epochs] [out] [test_ratio] [tanh|fast] [hidden] [init_model] [options]\n"
+        "  csv                        training data (heuristics/training_data.csv)\n"
+        "  epochs                     passes over the training split (50)\n"
+        "  out                        model file (node_nn_model.nn)\n"
+        "  test_ratio                 held-out fraction, 0 - 0.9 (0.2)\n"
+        "  tanh|fast                  activation (tanh)\n"
+        "  hidden                     hidden layer size of a new network (8)\n"
+        "  init_model                 continue training this model (its topology wins)\n"
+        "  --batch N                  mini-batch size, 0: full batch (256)\n"
+        "  --threads N                0: all hardware threads (0)\n"
+        "  --lr X                     Adam learning rate (0.001)\n"
+        "  --schedule constant|step|cosine\n"
+        "                             learning rate per epoch (constant)\n"
+        "  --lr-min X                 cosine: learning rate of the last epoch (0)\n"
+        "  --step-epochs N --step-gamma X\n"
+        "                             step: multiply by gamma every N epochs (10, 0.5)\n"
+        "  --seed N                   data split and batch order (42)\n";
+}
+
+// Fills `options` from argv; false (after printing why) on a bad argument.
+// Arguments not starting with "--" are the positional ones, in order.
+bool parse_options(int argc, char* argv[], Options& options) {
+    try {
+        for (int i = 1; i < argc; ++i) {
+            const std::string arg = argv[i];
+            if (arg == "--help" || arg == "-h") {
+                print_usage();
+                std::exit(0);
+            }
+            if (arg.rfind("--", 0) != 0) {
+                options.positional.push_back(arg);
+                continue;
+            }
+            if (i + 1 >= argc) {
+                std::cerr << "Error: missing value for " << arg << "\n";
+                return false;
+            }
+            const std::string value = argv[++i];
+
+            if      (arg == "--batch")       options.batch_size = std::max(0, std::stoi(value));
+            else if (arg == "--threads")     options.threads = std::stoi(value);
+            else if (arg == "--lr")          options.learning_rate = std::stof(value);
+            else if (arg == "--lr-min")      options.lr_min = std::stof(value);
+            else if (arg == "--step-epochs") options.step_epochs = std::max(1, std::stoi(value));
+            else if (arg == "--step-gamma")  options.step_gamma = std::stof(value);
+            else if (arg == "--seed")        options.seed = static_cast<unsigned>(std::stoul(value));
+            else if (arg == "--schedule") {
+                if      (value == "constant") options.schedule = Schedule::CONSTANT;
+                else if (value == "step")     options.schedule = Schedule::STEP;
+                else if (value == "cosine")   options.schedule = Schedule::COSINE;
+                else throw std::invalid_argument("unknown schedule " + value);
+            }
+            else {
+                std::cerr << "Error: unknown option " << arg << "\n";
+                print_usage();
+                return false;
+            }
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << "\n";
+        return false;
+    }
+    return true;
+}
+
 std::string find_existing_path(const std::vector<std::string>& candidates) {
     for (const auto& path : candidates) {
         if (std::filesystem::exists(path)) {
@@ -45,12 +151,96 @@ void shuffle_training_data(node_nn::TrainingData& data, unsigned int seed) {
     data.target = std::move(shuffled_target);
 }
 
+// Learning rate of `epoch` (1-based) out of `epochs`.
+float scheduled_learning_rate(const Options& options, int epoch, int epochs) {
+    switch (options.schedule) {
+    case Schedule::STEP:
+        return options.learning_rate *
+               std::pow(options.step_gamma, static_cast<float>((epoch - 1) / options.step_epochs));
+    case Schedule::COSINE: {
+        const float progress = epochs > 1 ? static_cast<float>(epoch - 1) / static_cast<float>(epochs - 1) : 0.0f;
+        return options.lr_min + 0.5f * (options.learning_rate - options.lr_min) *
+                                    (1.0f + std::cos(3.14159265358979f * progress));
+    }
+    case Schedule::CONSTANT:
+    default:
+        return options.learning_rate;
+    }
+}
+
+// Mini-batch Adam over `epochs` shuffled passes of `train`, logging the
+// losses about 20 times.
+template <typename Network>
+void train_epochs(Network& nn,
+                  const node_nn::TrainingData& train,
+                  const node_nn::TrainingData& test,
+                  int epochs,
+                  const Options& options,
+                  sim::ThreadPool& pool) {
+    using Gradients = node_nn::BasicGradients<Network::INPUT_SIZE, Network::HIDDEN_SIZE, Network::OUTPUT_SIZE>;
+    node_nn::BasicAdamState<Network::INPUT_SIZE, Network::HIDDEN_SIZE, Network::OUTPUT_SIZE> adam_state;
+
+    const size_t samples = train.input.size();
+    const size_t batch_size = options.batch_size > 0 ? std::min<size_t>(options.batch_size, samples) : samples;
+    std::vector<Gradients> shard_gradients((batch_size + SHARD_SIZE - 1) / SHARD_SIZE);
+    Gradients gradient;
+
+    std::vector<size_t> order(samples);
+    std::iota(order.begin(), order.end(), 0);
+    std::mt19937 rng(options.seed);
+
+    const int log_every = std::max(1, epochs / 20);
+    const auto start = std::chrono::steady_clock::now();
+
+    for (int epoch = 1; epoch <= epochs; ++epoch) {
+        std::shuffle(order.begin(), order.end(), rng);
+        const float learning_rate = scheduled_learning_rate(options, epoch, epochs);
+
+        for (size_t b0 = 0; b0 < samples; b0 += batch_size) {
+            const size_t b1 = std::min(b0 + batch_size, samples);
+            const int shards = static_cast<int>((b1 - b0 + SHARD_SIZE - 1) / SHARD_SIZE);
+
+            pool.parallel_for(shards, [&](int begin, int end) {
+                for (int s = begin; s < end; ++s) {
+                    const size_t s0 = b0 + static_cast<size_t>(s) * SHARD_SIZE;
+                    shard_gradients[s].set_zero();
+                    node_nn::add_gradients(nn, train.input, train.target, order,
+                                           s0, std::min(s0 + SHARD_SIZE, b1), shard_gradients[s]);
+                }
+            });
+
+            gradient.set_zero();
+            for (int s = 0; s < shards; ++s) node_nn::merge_gradients(gradient, shard_gradients[s]);
+            node_nn::average_gradients(gradient, static_cast<float>(b1 - b0));
+            node_nn::adam_step(nn, gradient, adam_state, learning_rate);
+        }
+
+        if (epoch == 1 || epoch % log_every == 0 || epoch == epochs) {
+            const float train_loss = node_nn::average_cost(nn, train);
+            std::cout << "Epoch " << epoch << " | lr=" << learning_rate << " | train_loss=" << train_loss;
+            if (!test.input.empty()) {
+                const float test_loss = node_nn::average_cost(nn, test);
+                std::cout << " | test_loss=" << test_loss;
+            }
+            std::cout << "\n";
+        }
+    }
+
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "Trained " << epochs << " epochs, " << adam_state.t << " updates in " << seconds << " s ("
+              << static_cast<double>(samples) * epochs / seconds << " samples/s)\n";
+}
+
 } // namespace
 
 int main(int argc, char* argv[]) {
+    Options options;
+    if (!parse_options(argc, argv, options)) return 2;
+    const std::vector<std::string>& args = options.positional;
+
     std::string csv_path;
-    if (argc > 1) {
-        csv_path = argv[1];
+    if (args.size() > 0) {
+        csv_path = args[0];
     } else {
         csv_path = find_existing_path({
             "heuristics/training_data.csv",
@@ -63,23 +253,56 @@ int main(int argc, char* argv[]) {
         return 1;
     }
 
-    int epochs = 500;
-    if (argc > 2) {
-        epochs = std::max(1, std::stoi(argv[2]));
+    int epochs = 50;
+    if (args.size() > 1) {
+        epochs = std::max(1, std::stoi(args[1]));
     }
 
     std::string output_model_path = "node_nn_model.nn";
-    if (argc > 3) {
-        output_model_path = argv[3];
+    if (args.size() > 2) {
+        output_model_path = args[2];
     }
 
     float test_ratio = 0.2f;
-    if (argc > 4) {
-        test_ratio = std::stof(argv[4]);
+    if (args.size() > 3) {
+        test_ratio = std::stof(args[3]);
         if (test_ratio < 0.0f) test_ratio = 0.0f;
         if (test_ratio > 0.9f) test_ratio = 0.9f;
     }
 
+    // "fast" trains with node_nn::fast_tanh. Model files do not record the
+    // activation: run the simulator with NN_FAST_TANH = 1 to match.
+    node_nn::Activation activation = node_nn::Activation::TANH;
+    if (args.size() > 4) {
+        const std::string& name = args[4];
+        if (name == "fast") {
+            activation = node_nn::Activation::FAST_TANH;
+        } else if (name != "tanh") {
+            std::cerr << "Unknown activation: " << name << " (use tanh or fast)\n";
+            return 1;
+        }
+    }
+
+    // Topology: a random network with `hidden` hidden units, or whatever
+    // topology the initial model file (argument 7) declares, trained further.
+    node_nn::Model nn;
+    if (args.size() > 6) {
+        if (!node_nn::load_model(args[6], nn)) {
+            std::cerr << "Failed to load initial model: " << args[6] << "\n";
+            return 1;
+        }
+    } else {
+        const int hidden = (args.size() > 5) ? std::stoi(args[5]) : node_nn::HIDDEN_SIZE;
+        if (!node_nn::create_model({node_nn::INPUT_SIZE, hidden, node_nn::OUTPUT_SIZE}, nn)) {
+            std::cerr << "Unsupported hidden layer size: " << hidden << " (built in:";
+            for (const node_nn::Topology& topology : node_nn::topologies()) std::cerr << " " << topology.hidden;
+            std::cerr << ")\n";
+            return 1;
+        }
+    }
+    node_nn::set_activation(nn, activation);
+    const node_nn::Topology topology = node_nn::model_topology(nn);
+
     node_nn::TrainingData data;
     if (!node_nn::load_training_data(csv_path, data)) {
         std::cerr << "Failed to load training data from: " << csv_path << "\n";
@@ -91,7 +314,7 @@ int main(int argc, char* argv[]) {
         return 1;
     }
 
-    shuffle_training_data(data, 42u);
+    shuffle_training_data(data, options.seed);
 
     node_nn::TrainingData train = data;
     node_nn::TrainingData test;
@@ -102,27 +325,24 @@ int main(int argc, char* argv[]) {
         return 1;
     }
 
-    node_nn::NeuralNetwork nn;
-    node_nn::AdamState adam_state;
+    const int threads = options.threads > 0
+                            ? options.threads
+                            : std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+    sim::ThreadPool pool(threads);
 
     std::cout << "Training CSV: " << csv_path << "\n";
     std::cout << "Samples: " << data.input.size() << " (train=" << train.input.size()
               << ", test=" << test.input.size() << ")\n";
-    std::cout << "Epochs: " << epochs << ", test_ratio: " << test_ratio << "\n";
+    std::cout << "Network: " << topology.input << "-" << topology.hidden << "-" << topology.output
+              << (args.size() > 6 ? " from " + args[6] : std::string()) << "\n";
+    std::cout << "Epochs: " << epochs << ", test_ratio: " << test_ratio << ", activation: "
+              << (activation == node_nn::Activation::FAST_TANH ? "fast" : "tanh") << "\n";
+    std::cout << "Batch: ";
+    if (options.batch_size > 0) std::cout << options.batch_size;
+    else                        std::cout << "full";
+    std::cout << ", threads: " << threads << ", lr: " << options.learning_rate << "\n";
 
-    for (int epoch = 1; epoch <= epochs; ++epoch) {
-        node_nn::adam(nn, train, adam_state);
-
-        if (epoch == 1 || epoch % 25 == 0 || epoch == epochs) {
-            const float train_loss = node_nn::average_cost(nn, train);
-            std::cout << "Epoch " << epoch << " | train_loss=" << train_loss;
-            if (!test.input.empty()) {
-                const float test_loss = node_nn::average_cost(nn, test);
-                std::cout << " | test_loss=" << test_loss;
-            }
-            std::cout << "\n";
-        }
-    }
+    std::visit([&](auto& network) { train_epochs(network, train, test, epochs, options, pool); }, nn);
 
     if (!node_nn::save_model(output_model_path, nn)) {
         std::cerr << "Failed to save model: " << output_model_path << "\n";
@@ -131,4 +351,4 @@ int main(int argc, char* argv[]) {
 
     std::cout << "Saved model to: " << output_model_path << "\n";
     return 0;
-}
\ No newline at end of file
+}